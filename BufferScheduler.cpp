@@ -0,0 +1,106 @@
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "BufferScheduler.h"
+#include "DataTypes.h"
+#include "Profiler.h"
+#include "Queues.h"
+#include "Tracer.h"
+
+namespace tinyalg::waveu {
+
+const char* BufferScheduler::TAG = "Waveu-BufferScheduler";
+
+static std::atomic<bool> stop_request{false};
+static std::atomic<uint32_t> ticks_in_flight{0};    // tick() calls that may still hand over buffers
+static std::atomic<bool> output_ping_next{true};    // Selector of double buffer
+static std::atomic<uint32_t> period_count{0};       // Number of periods scheduled so far
+static std::atomic<uint32_t> dropped_requests{0};
+static std::atomic<uint32_t> dropped_outputs{0};
+
+void BufferScheduler::startOutput() {
+    // Disable stop request
+    stop_request.store(false);
+
+    // Output the pre-rendered buffer right away instead of waiting for the first period.
+    scheduleBuffers(0);
+}
+
+void BufferScheduler::stopOutput() {
+    // Sequentially consistent with tick(): either a tick sees the stop request, or this
+    // task sees it in flight and waits until it has handed over its buffers.
+    stop_request.store(true);
+    while (ticks_in_flight.load() != 0) {
+        vTaskDelay(1);
+    }
+}
+
+void BufferScheduler::tick(TickType_t ticksToWait) {
+    // Announce the tick before checking the stop request, so that stopOutput() waits for it.
+    ticks_in_flight.fetch_add(1);
+    if (stop_request.load()) {
+        // Gracefully exit if stop is requested
+        ticks_in_flight.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    scheduleBuffers(ticksToWait);
+    ticks_in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+void BufferScheduler::resetToPing() {
+    output_ping_next.store(true);
+}
+
+bool BufferScheduler::isOverdue(uint32_t period) {
+    // Wraps around safely as long as the request is less than 2^31 periods old.
+    return (int32_t)(period_count.load(std::memory_order_acquire) - period) > 0;
+}
+
+uint32_t BufferScheduler::droppedRequests() {
+    return dropped_requests.load(std::memory_order_relaxed);
+}
+
+uint32_t BufferScheduler::droppedOutputs() {
+    return dropped_outputs.load(std::memory_order_relaxed);
+}
+
+void BufferScheduler::scheduleBuffers(TickType_t ticksToWait) {
+    bool outputPing = output_ping_next.load();
+    const uint32_t period = period_count.fetch_add(1, std::memory_order_acq_rel) + 1;
+    WAVEU_TRACE_INSTANT(TraceEvent::TimerTick, period);
+
+    // Hand the buffer rendered during the previous period over to the consumer.
+    data_output_msg_type_t data_output_msg = {
+        .data = outputPing,
+        .terminationTrigger = false,
+    };
+    WAVEU_TRACE_INSTANT(TraceEvent::OutputQueueSend, outputPing);
+    if (xQueueSend(dataOutputQueue, (void *)&data_output_msg, ticksToWait) != pdPASS) {
+        dropped_outputs.fetch_add(1, std::memory_order_relaxed);
+        WAVEU_TRACE_INSTANT(TraceEvent::OutputDropped, 0);
+        ESP_LOGW(TAG, "Queue is full. Data drop occurred.(%u)", (unsigned)period);
+    }
+
+    // Request the other buffer to be rendered for the next period.
+    data_generation_msg_type_t data_generation_msg = {
+        .data = !outputPing,
+        .terminationTrigger = false,
+        .period = period,
+    };
+    WAVEU_PROFILE_QUEUE_SEND();
+    WAVEU_TRACE_INSTANT(TraceEvent::GenerationQueueSend, !outputPing);
+    if (xQueueSend(dataGenerationQueue, (void *)&data_generation_msg, ticksToWait) != pdPASS) {
+        dropped_requests.fetch_add(1, std::memory_order_relaxed);
+        WAVEU_TRACE_INSTANT(TraceEvent::RequestDropped, 0);
+        ESP_LOGW(TAG, "Queue is full. Data drop occurred.(%u)", (unsigned)period);
+    }
+
+    // Switch to the new data filled by this request
+    output_ping_next.store(!outputPing);
+}
+
+} // namespace tinyalg::waveu
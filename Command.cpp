@@ -0,0 +1,106 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "Command.h"
+
+namespace tinyalg::waveu {
+
+Result toResult(CommandStatus status) {
+    switch (status) {
+        case CommandStatus::Pending:
+            return ErrorCode::Pending;
+        case CommandStatus::InvalidState:
+            return ErrorCode::InvalidState;
+        case CommandStatus::QueueFull:
+            return ErrorCode::QueueFull;
+        case CommandStatus::InvalidArgument:
+            return ErrorCode::InvalidArgument;
+        case CommandStatus::NoMemory:
+            return ErrorCode::NoMemory;
+        default:
+            return ErrorCode::Ok;
+    }
+}
+
+void CommandTracker::complete(uint32_t position, CommandStatus status, uint8_t state) {
+    Slot& slot = slots_[position % SLOTS];
+    slot.tag.store(UINT32_MAX, std::memory_order_relaxed);   // Invalidate while rewriting
+    slot.status.store(static_cast<uint8_t>(status), std::memory_order_relaxed);
+    slot.state.store(state, std::memory_order_relaxed);
+    slot.tag.store(position, std::memory_order_release);
+    completed_.store(position + 1, std::memory_order_seq_cst);
+
+    TaskHandle_t waiter = slot.waiter.exchange(nullptr, std::memory_order_seq_cst);
+    if (waiter != nullptr) {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+bool CommandTracker::done(uint32_t position) const {
+    return (int32_t)(completed_.load(std::memory_order_seq_cst) - (position + 1)) >= 0;
+}
+
+CommandStatus CommandTracker::status(uint32_t position, uint8_t* state) const {
+    if (!done(position)) {
+        return CommandStatus::Pending;
+    }
+    const Slot& slot = slots_[position % SLOTS];
+    if (slot.tag.load(std::memory_order_acquire) != position) {
+        return CommandStatus::Expired;
+    }
+    CommandStatus status = static_cast<CommandStatus>(slot.status.load(std::memory_order_relaxed));
+    uint8_t observed = slot.state.load(std::memory_order_relaxed);
+    // The slot may have been reused for a later command while it was being read.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.tag.load(std::memory_order_relaxed) != position) {
+        return CommandStatus::Expired;
+    }
+    if (state != nullptr) {
+        *state = observed;
+    }
+    return status;
+}
+
+void CommandTracker::setWaiter(uint32_t position, TaskHandle_t task) {
+    slots_[position % SLOTS].waiter.store(task, std::memory_order_seq_cst);
+}
+
+bool CommandHandle::done() const {
+    return tracker_ == nullptr || tracker_->done(position_);
+}
+
+CommandStatus CommandHandle::status() const {
+    if (tracker_ == nullptr) {
+        return immediate_;
+    }
+    return tracker_->status(position_, nullptr);
+}
+
+CommandStatus CommandHandle::wait(TickType_t ticksToWait) const {
+    if (tracker_ == nullptr) {
+        return immediate_;
+    }
+
+    const TickType_t begin = xTaskGetTickCount();
+    tracker_->setWaiter(position_, xTaskGetCurrentTaskHandle());
+    // Check after registering, so that a completion in between is not missed.
+    while (!tracker_->done(position_)) {
+        TickType_t elapsed = xTaskGetTickCount() - begin;
+        if (ticksToWait != portMAX_DELAY && elapsed >= ticksToWait) {
+            tracker_->setWaiter(position_, nullptr);
+            return CommandStatus::Pending;
+        }
+        ulTaskNotifyTake(pdTRUE, (ticksToWait == portMAX_DELAY) ? portMAX_DELAY : ticksToWait - elapsed);
+    }
+    return status();
+}
+
+uint8_t CommandHandle::observedState() const {
+    uint8_t state = 0;
+    if (tracker_ != nullptr) {
+        tracker_->status(position_, &state);
+    }
+    return state;
+}
+
+} // namespace tinyalg::waveu
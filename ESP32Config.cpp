@@ -1,28 +1,67 @@
-#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 
 #include "driver/dac_continuous.h"
 #include "driver/gpio.h"
+#include "esp_heap_caps.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "sdkconfig.h"
 
 #include "BoardConfig.h"
+#include "BufferScheduler.h"
 #include "DataTypes.h"
 #include "ESP32Config.h"
 #include "Queues.h"
 #include "Semaphores.h"
 #include "DataTypes.h"
 #include "Debug.h"
+#include "Profiler.h"
+#include "RecorderTap.h"
+#include "Tracer.h"
 
 namespace tinyalg::waveu {
 
-atomic_bool timer_callback_stop_request = false;
-atomic_bool discard_buffer_before_stop = false;
-
 static data_transfer_task_args_t data_transfer_task_args;
+
+static void writeDataBuffer(data_transfer_task_args_t *task_args, data_buf_type_t *buffer,
+                            SemaphoreHandle_t semaphore, const char* name) {
+    [[maybe_unused]] const bool ping = (buffer == ESP32Config::pingDataBuffer);
+    BaseType_t taken;
+    {
+        // Wait for the producer to fill the current buffer
+        WAVEU_PROFILE_SCOPE(ProfileStage::ConsumerWait);
+        WAVEU_TRACE_SCOPE(TraceEvent::ConsumerWait, ping);
+        taken = xSemaphoreTake(semaphore, portMAX_DELAY);
+    }
+
+    if (taken == pdTRUE) {
+        DEBUG_CONSUMER_GPIO_SET_LEVEL(1);
+
+        size_t bytes_loaded;
+        {
+            WAVEU_PROFILE_SCOPE(ProfileStage::DacWrite);
+            WAVEU_TRACE_SCOPE(TraceEvent::DacWrite, ping);
+            ESP_ERROR_CHECK(dac_continuous_write(task_args->cont_handle,
+                                                (uint8_t *)buffer,
+                                                ESP32Config::LEN_DATA_BUFFER,
+                                                &bytes_loaded,
+                                                task_args->timeout_ms));
+        }
+        if (bytes_loaded != ESP32Config::LEN_DATA_BUFFER) {
+            ESP_LOGE(ESP32Config::TAG, "%s loaded immaturely: bytes_loaded=%d", name, bytes_loaded);
+        }
+
+        // Copy what was sent to the DAC before the buffer is handed back for refill.
+        WAVEU_RECORDER_CAPTURE(buffer, bytes_loaded);
+
+        DEBUG_CONSUMER_GPIO_SET_LEVEL(0);
+        // Notify the producer that the current buffer is ready for refill
+        xSemaphoreGive(semaphore);
+    }
+}
+
 static void waveformDataOutputTask(void *args) {
     data_transfer_task_args_t *task_args = (data_transfer_task_args_t*)args;
 
@@ -36,46 +75,12 @@ static void waveformDataOutputTask(void *args) {
             ESP_LOGI(ESP32Config::TAG, "Stopping waveformDataOutputTask...");
             vTaskDelete(NULL);
         }
+        WAVEU_TRACE_INSTANT(TraceEvent::OutputQueueReceive, receivedData.data);
 
         if (receivedData.data) {
-            // Wait for the producer to fill the current buffer
-            if (xSemaphoreTake(pingBufferSemaphore, portMAX_DELAY) == pdTRUE) {
-                DEBUG_CONSUMER_GPIO_SET_LEVEL(1);
-
-                size_t bytes_loaded;
-                ESP_ERROR_CHECK(dac_continuous_write(task_args->cont_handle,
-                                                    (uint8_t *)ESP32Config::pingDataBuffer,
-                                                    ESP32Config::LEN_DATA_BUFFER,
-                                                    &bytes_loaded,
-                                                    task_args->timeout_ms));
-                if (bytes_loaded != ESP32Config::LEN_DATA_BUFFER) {
-                    ESP_LOGE(ESP32Config::TAG, "pingDataBuffer loaded immaturely: bytes_loaded=%d", bytes_loaded);
-                }
-
-                DEBUG_CONSUMER_GPIO_SET_LEVEL(0);
-                // Notify the producer that the current buffer is ready for refill
-                xSemaphoreGive(pingBufferSemaphore);
-            }
+            writeDataBuffer(task_args, ESP32Config::pingDataBuffer, pingBufferSemaphore, "pingDataBuffer");
         } else {
-            // Wait for the producer to fill the current buffer
-            if (xSemaphoreTake(pongBufferSemaphore, portMAX_DELAY) == pdTRUE) {
-
-                DEBUG_CONSUMER_GPIO_SET_LEVEL(1);
-
-                size_t bytes_loaded;        
-                ESP_ERROR_CHECK(dac_continuous_write(task_args->cont_handle,
-                                                    (uint8_t *)ESP32Config::pongDataBuffer,
-                                                    ESP32Config::LEN_DATA_BUFFER,
-                                                    &bytes_loaded,
-                                                    task_args->timeout_ms));
-                if (bytes_loaded != ESP32Config::LEN_DATA_BUFFER) {
-                    ESP_LOGE(ESP32Config::TAG, "pongDataBuffer loaded immaturely: bytes_loaded=%d", bytes_loaded);
-                }
-
-                DEBUG_CONSUMER_GPIO_SET_LEVEL(0);
-                // Notify the producer that the current buffer is ready for refill
-                xSemaphoreGive(pongBufferSemaphore);
-            }
+            writeDataBuffer(task_args, ESP32Config::pongDataBuffer, pongBufferSemaphore, "pongDataBuffer");
         }
     } // while (1)
 }
@@ -84,17 +89,42 @@ esp_timer_handle_t ESP32Config::timer_handle = nullptr;
 
 const char* ESP32Config::TAG = "Waveu-ESP32Config";
 
+#ifdef CONFIG_WAVEU_LEAN_MEMORY
+data_buf_type_t* ESP32Config::pingDataBuffer = nullptr;
+data_buf_type_t* ESP32Config::pongDataBuffer = nullptr;
+#else
 data_buf_type_t ESP32Config::pingDataBuffer[LEN_DATA_BUFFER] = { 0 }; 
 data_buf_type_t ESP32Config::pongDataBuffer[LEN_DATA_BUFFER] = { 0 };
+#endif
 
 ESP32Config::timer_callback_args_t ESP32Config::timer_callback_args = {};
 
-ESP32Config::ESP32Config() {}
+std::atomic<uint32_t> ESP32Config::lastStartLatencyUs{0};
+std::atomic<uint32_t> ESP32Config::lastStopLatencyUs{0};
+
+ESP32Config::ESP32Config() {
+#ifdef CONFIG_WAVEU_LEAN_MEMORY
+    pingDataBuffer = (data_buf_type_t*)heap_caps_calloc(LEN_DATA_BUFFER, sizeof(data_buf_type_t), MALLOC_CAP_DMA);
+    pongDataBuffer = (data_buf_type_t*)heap_caps_calloc(LEN_DATA_BUFFER, sizeof(data_buf_type_t), MALLOC_CAP_DMA);
+    if (pingDataBuffer == nullptr || pongDataBuffer == nullptr) {
+        ESP_LOGE(TAG, "Cannot allocate 2 x %d bytes for the ping/pong buffers", LEN_DATA_BUFFER);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    ESP_LOGI(TAG, "Lean memory: TIMER_PERIOD=%dus, 2 x %d bytes of buffers, %d x %d bytes of DMA buffers",
+             (int)TIMER_PERIOD, LEN_DATA_BUFFER, DAC_DMA_DESC_NUM, DAC_DMA_BUF_SIZE);
+#endif
+}
 
 ESP32Config::~ESP32Config() {
     ESP_LOGD(TAG, "Running the destructor ~ESP32Config()...");
     ESP_ERROR_CHECK_WITHOUT_ABORT(dac_continuous_disable(cont_handle));
     ESP_ERROR_CHECK_WITHOUT_ABORT(dac_continuous_del_channels(cont_handle));
+#ifdef CONFIG_WAVEU_LEAN_MEMORY
+    heap_caps_free(pingDataBuffer);
+    heap_caps_free(pongDataBuffer);
+    pingDataBuffer = nullptr;
+    pongDataBuffer = nullptr;
+#endif
 }
 
 // Implementation of ESP32-specific DAC initialization
@@ -196,31 +226,45 @@ void ESP32Config::prepareTimer() {
 #ifdef CONFIG_WAVEU_CONSUMER_TASK_CORE_AFFINITY
     xCoreID = 0;
 #endif
-    xTaskCreatePinnedToCore(waveformDataOutputTask, "waveformDataOutputTask", 4096, (void *)&data_transfer_task_args, uxPriority, NULL, xCoreID);
+    xTaskCreatePinnedToCore(waveformDataOutputTask, "waveformDataOutputTask", CONFIG_WAVEU_CONSUMER_TASK_STACK_SIZE, (void *)&data_transfer_task_args, uxPriority, NULL, xCoreID);
     ESP_LOGI(TAG, "waveformDataOutputTask to on core %d at priority %d.",
                                                                         xCoreID, uxPriority);
 }
 
 void ESP32Config::startTimer() {
-    // Disable stop request
-    atomic_store(&timer_callback_stop_request, false);
+    WAVEU_PROFILE_SCOPE(ProfileStage::StartOutput);
+    WAVEU_TRACE_SCOPE(TraceEvent::StartOutput, 0);
+    int64_t begin = esp_timer_get_time();
+
+    // Output the pre-rendered buffer right away instead of waiting for the first period.
+    BufferScheduler::startOutput();
 
     // Start the timer
     ESP_ERROR_CHECK(esp_timer_start_periodic(ESP32Config::timer_handle, TIMER_PERIOD));
 
-    // Wait for some time to ensure waveform output before immediate stop()
-    vTaskDelay(pdMS_TO_TICKS(TIMER_PERIOD / 1000) * 3 + 1);
+    const uint32_t latencyUs = (uint32_t)(esp_timer_get_time() - begin);
+    lastStartLatencyUs.store(latencyUs, std::memory_order_relaxed);
+    ESP_LOGD(TAG, "startTimer() returned in %uus", (unsigned)latencyUs);
 }
 
 void ESP32Config::stopTimer() {
-    // Signal stop request
-    atomic_store(&timer_callback_stop_request, true);
-
-    // Wait for one timer period to ensure the callback is not running
-    vTaskDelay(pdMS_TO_TICKS(TIMER_PERIOD / 1000) + 1);
+    WAVEU_PROFILE_SCOPE(ProfileStage::StopOutput);
+    WAVEU_TRACE_SCOPE(TraceEvent::StopOutput, 0);
+    int64_t begin = esp_timer_get_time();
+
+    // Signal stop request and wait for a callback that is already past the check,
+    // so no render request is queued after this returns.
+    BufferScheduler::stopOutput();
+
+    // Stop the timer. The buffers already handed to the consumer are output to the end.
+    esp_err_t err = esp_timer_stop(ESP32Config::timer_handle);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_ERROR_CHECK(err);
+    }
 
-    // Stop the timer
-    ESP_ERROR_CHECK(esp_timer_stop(ESP32Config::timer_handle));
+    const uint32_t latencyUs = (uint32_t)(esp_timer_get_time() - begin);
+    lastStopLatencyUs.store(latencyUs, std::memory_order_relaxed);
+    ESP_LOGD(TAG, "stopTimer() returned in %uus", (unsigned)latencyUs);
 }
 
 void ESP32Config::cleanupTimer() {
@@ -230,50 +274,36 @@ void ESP32Config::cleanupTimer() {
 
 void ESP32Config::reset() {
     ESP_LOGD(TAG, "reset() called");
-    // Signal how the data buffer is handled.
-    atomic_store(&discard_buffer_before_stop, true);
+    // The ping buffer is pre-rendered and output first after a reset.
+    BufferScheduler::resetToPing();
+    WAVEU_RECORDER_RESET();
 }
 
-void ESP32Config::timerCallback(void *args) {
-    //timer_callback_args_t* callback_args = static_cast<timer_callback_args_t*>(args);
-
-    static bool firstTime = true;
-    static bool prepareData0 = true;  // Selector of double buffer
-    static int callCount = 0;
-    callCount++;
+void ESP32Config::startCyclic(const data_buf_type_t* buffer, size_t len) {
+    static_assert(LEN_DATA_BUFFER <= (size_t)DAC_DMA_DESC_NUM * DAC_DMA_BUF_SIZE,
+                  "The DMA descriptors must be able to hold a whole buffer for cyclic output");
 
-    if (atomic_load(&timer_callback_stop_request)) {
-        // Gracefully exit if stop is requested
-        return;
+    size_t bytes_loaded = 0;
+    ESP_ERROR_CHECK(dac_continuous_write_cyclically(cont_handle, (uint8_t *)buffer, len, &bytes_loaded));
+    if (bytes_loaded != len) {
+        ESP_LOGE(TAG, "Cyclic buffer loaded immaturely: bytes_loaded=%d", bytes_loaded);
     }
+    ESP_LOGD(TAG, "startCyclic(): %d bytes", len);
+}
 
-    // Send which buffer to use as queue
-    // Prepare data for the next call.
-    data_generation_msg_type_t data_generation_msg = {
-        .data = prepareData0,
-        .terminationTrigger = false,
-    };
-    if (xQueueSend(dataGenerationQueue, (void *)&data_generation_msg, portMAX_DELAY) != pdPASS) {
-        ESP_LOGW(TAG, "Queue is full. Data drop occurred.(%d)", callCount);
-    }
+void ESP32Config::stopCyclic() {
+    // The DMA descriptors stay linked in a ring until the channels are restarted.
+    ESP_ERROR_CHECK(dac_continuous_disable(cont_handle));
+    ESP_ERROR_CHECK(dac_continuous_enable(cont_handle));
+    BufferScheduler::resetToPing();
+    ESP_LOGD(TAG, "stopCyclic() called");
+}
 
-    // Switch to the new data filled by previous request
-    prepareData0 = !prepareData0;
-
-    if (firstTime || atomic_load(&discard_buffer_before_stop)) {
-        firstTime = false;
-        atomic_store(&discard_buffer_before_stop, false);
-        ESP_LOGD(TAG, "Skipped the alternate data buffer immediately after start()");
-        return;
-    } else {
-        data_output_msg_type_t data_output_msg = {
-            .data = prepareData0,
-            .terminationTrigger = false,
-        };
-        if (xQueueSend(dataOutputQueue, (void *)&data_output_msg, portMAX_DELAY) != pdPASS) {
-            ESP_LOGW(TAG, "Queue is full. Data drop occurred.(%d)", callCount);
-        }
-    }
+void ESP32Config::timerCallback(void *args) {
+    //timer_callback_args_t* callback_args = static_cast<timer_callback_args_t*>(args);
+
+    // The esp_timer task must not block; a full queue is counted as an overload.
+    BufferScheduler::tick(0);
 }
     
 } // namespace tinyalg::waveu
@@ -0,0 +1,465 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Expression.h"
+
+namespace tinyalg::waveu {
+
+namespace {
+
+/// Points per period of the interpolated sine of `Expression::evaluateBlock()`.
+constexpr size_t SINE_POINTS = 1024;
+
+struct SineTable {
+    float values[SINE_POINTS + 1];
+
+    SineTable() {
+        for (size_t i = 0; i <= SINE_POINTS; ++i) {
+            values[i] = (float)std::sin(2.0 * M_PI * (double)i / SINE_POINTS);
+        }
+    }
+};
+
+const SineTable& sineTable() {
+    static const SineTable table;
+    return table;
+}
+
+/// The fractional part of `x`, in [0, 1].
+inline float wrap(float x) {
+    return x - std::floor(x);
+}
+
+inline float triangle(float x) {
+    const float f = wrap(x);
+    return (f < 0.5f) ? (4.0f * f - 1.0f) : (3.0f - 4.0f * f);
+}
+
+inline float sawtooth(float x) {
+    return 2.0f * wrap(x) - 1.0f;
+}
+
+inline float pulse(float x, float duty) {
+    return (wrap(x) < duty) ? 1.0f : -1.0f;
+}
+
+inline float clamp(float x, float lo, float hi) {
+    return (x < lo) ? lo : (x > hi) ? hi : x;
+}
+
+/// Number of operands of an instruction; 0 for those pushing a value.
+int arity(ExpressionOp op) {
+    switch (op) {
+        case ExpressionOp::Constant:
+        case ExpressionOp::Phase:
+        case ExpressionOp::Time:
+            return 0;
+        case ExpressionOp::Neg:
+        case ExpressionOp::Abs:
+        case ExpressionOp::Sin:
+        case ExpressionOp::Tri:
+        case ExpressionOp::Saw:
+            return 1;
+        case ExpressionOp::Clamp:
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+/// Applies an operator to scalar operands, with full-precision `std::sin()`.
+float apply(ExpressionOp op, const float* a) {
+    switch (op) {
+        case ExpressionOp::Add: return a[0] + a[1];
+        case ExpressionOp::Sub: return a[0] - a[1];
+        case ExpressionOp::Mul: return a[0] * a[1];
+        case ExpressionOp::Div: return a[0] / a[1];
+        case ExpressionOp::Neg: return -a[0];
+        case ExpressionOp::Abs: return std::fabs(a[0]);
+        case ExpressionOp::Min: return (a[1] < a[0]) ? a[1] : a[0];
+        case ExpressionOp::Max: return (a[1] > a[0]) ? a[1] : a[0];
+        case ExpressionOp::Sin: return (float)std::sin(2.0 * M_PI * (double)wrap(a[0]));
+        case ExpressionOp::Tri: return triangle(a[0]);
+        case ExpressionOp::Saw: return sawtooth(a[0]);
+        case ExpressionOp::Pulse: return pulse(a[0], a[1]);
+        case ExpressionOp::Clamp: return clamp(a[0], a[1], a[2]);
+        default: return 0.0f;
+    }
+}
+
+struct Function {
+    const char* name;
+    ExpressionOp op;
+};
+
+constexpr Function FUNCTIONS[] = {
+    {"sin", ExpressionOp::Sin},
+    {"tri", ExpressionOp::Tri},
+    {"saw", ExpressionOp::Saw},
+    {"pulse", ExpressionOp::Pulse},
+    {"clamp", ExpressionOp::Clamp},
+    {"min", ExpressionOp::Min},
+    {"max", ExpressionOp::Max},
+    {"abs", ExpressionOp::Abs},
+};
+
+} // namespace
+
+/**
+ * @brief Recursive-descent parser emitting postfix code with constant folding.
+ *
+ * Grammar:
+ *
+ *     expr    := term (('+' | '-') term)*
+ *     term    := unary (('*' | '/') unary)*
+ *     unary   := ('-' | '+') unary | primary
+ *     primary := number | 'p' | 't' | 'pi' | name '(' expr (',' expr)* ')' | '(' expr ')'
+ */
+class ExpressionCompiler {
+public:
+    ExpressionCompiler(const char* source, Expression& out) : source_(source), pos_(source), out_(out) {}
+
+    bool run() {
+        if (!parseExpr()) {
+            return false;
+        }
+        skipSpace();
+        if (*pos_ != '\0') {
+            return fail();
+        }
+        return true;
+    }
+
+    size_t errorOffset() const { return (size_t)(error_ - source_); }
+
+private:
+    /// Maximum nesting of parentheses and unary operators.
+    static constexpr int MAX_NESTING = 32;
+
+    bool fail() {
+        error_ = pos_;
+        return false;
+    }
+
+    void skipSpace() {
+        while (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r') {
+            ++pos_;
+        }
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (*pos_ == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Appends an instruction, or folds it with constant operands into one constant.
+     */
+    bool emit(ExpressionOp op, float value = 0.0f) {
+        const int n = arity(op);
+        size_t size = out_.size_;
+        bool foldable = n > 0;
+        for (int i = 1; i <= n && foldable; ++i) {
+            foldable = out_.code_[size - i].op == ExpressionOp::Constant;
+        }
+        depth_ -= n;
+        if (foldable) {
+            float operands[3];
+            for (int i = 0; i < n; ++i) {
+                operands[i] = out_.code_[size - n + i].value;
+            }
+            size -= n;
+            value = apply(op, operands);
+            op = ExpressionOp::Constant;
+        }
+        if (size == Expression::MAX_INSTRUCTIONS || ++depth_ > (int)Expression::MAX_STACK) {
+            return fail();
+        }
+        out_.code_[size++] = {op, value};
+        out_.size_ = (uint8_t)size;
+        out_.usesTime_ = out_.usesTime_ || op == ExpressionOp::Time;
+        return true;
+    }
+
+    bool parseExpr() {
+        if (!parseTerm()) {
+            return false;
+        }
+        for (;;) {
+            if (accept('+')) {
+                if (!parseTerm() || !emit(ExpressionOp::Add)) {
+                    return false;
+                }
+            } else if (accept('-')) {
+                if (!parseTerm() || !emit(ExpressionOp::Sub)) {
+                    return false;
+                }
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parseTerm() {
+        if (!parseUnary()) {
+            return false;
+        }
+        for (;;) {
+            if (accept('*')) {
+                if (!parseUnary() || !emit(ExpressionOp::Mul)) {
+                    return false;
+                }
+            } else if (accept('/')) {
+                if (!parseUnary() || !emit(ExpressionOp::Div)) {
+                    return false;
+                }
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parseUnary() {
+        if (++nesting_ > MAX_NESTING) {
+            return fail();
+        }
+        bool ok;
+        if (accept('-')) {
+            ok = parseUnary() && emit(ExpressionOp::Neg);
+        } else if (accept('+')) {
+            ok = parseUnary();
+        } else {
+            ok = parsePrimary();
+        }
+        --nesting_;
+        return ok;
+    }
+
+    bool parsePrimary() {
+        skipSpace();
+        if (accept('(')) {
+            return parseExpr() && (accept(')') || fail());
+        }
+        if ((*pos_ >= '0' && *pos_ <= '9') || *pos_ == '.') {
+            char* end = nullptr;
+            const float value = std::strtof(pos_, &end);
+            if (end == pos_) {
+                return fail();
+            }
+            pos_ = end;
+            return emit(ExpressionOp::Constant, value);
+        }
+        const char* start = pos_;
+        while ((*pos_ >= 'a' && *pos_ <= 'z') || (*pos_ >= 'A' && *pos_ <= 'Z') || *pos_ == '_') {
+            ++pos_;
+        }
+        const size_t length = (size_t)(pos_ - start);
+        if (length == 0) {
+            return fail();
+        }
+        if (matches(start, length, "p")) {
+            return emit(ExpressionOp::Phase);
+        }
+        if (matches(start, length, "t")) {
+            return emit(ExpressionOp::Time);
+        }
+        if (matches(start, length, "pi")) {
+            return emit(ExpressionOp::Constant, (float)M_PI);
+        }
+        for (const Function& function : FUNCTIONS) {
+            if (matches(start, length, function.name)) {
+                return parseCall(function.op);
+            }
+        }
+        pos_ = start;
+        return fail();
+    }
+
+    bool parseCall(ExpressionOp op) {
+        if (!accept('(')) {
+            return fail();
+        }
+        for (int i = 0; i < arity(op); ++i) {
+            if (i > 0 && !accept(',')) {
+                return fail();
+            }
+            if (!parseExpr()) {
+                return false;
+            }
+        }
+        return (accept(')') || fail()) && emit(op);
+    }
+
+    static bool matches(const char* start, size_t length, const char* name) {
+        return std::strlen(name) == length && std::strncmp(start, name, length) == 0;
+    }
+
+    const char* source_;
+    const char* pos_;
+    const char* error_ = nullptr;
+    Expression& out_;
+    int depth_ = 0;
+    int nesting_ = 0;
+};
+
+Result Expression::compile(const char* source, Expression& out, size_t* errorOffset) {
+    if (source == nullptr) {
+        if (errorOffset) {
+            *errorOffset = 0;
+        }
+        return ErrorCode::InvalidArgument;
+    }
+    Expression compiled;
+    ExpressionCompiler compiler(source, compiled);
+    if (!compiler.run()) {
+        if (errorOffset) {
+            *errorOffset = compiler.errorOffset();
+        }
+        return ErrorCode::InvalidArgument;
+    }
+    out = compiled;
+    return ErrorCode::Ok;
+}
+
+float Expression::evaluate(float phase, float time) const {
+    float stack[MAX_STACK];
+    size_t sp = 0;
+    for (size_t i = 0; i < size_; ++i) {
+        const ExpressionInstruction& instruction = code_[i];
+        switch (instruction.op) {
+            case ExpressionOp::Constant:
+                stack[sp++] = instruction.value;
+                break;
+            case ExpressionOp::Phase:
+                stack[sp++] = phase;
+                break;
+            case ExpressionOp::Time:
+                stack[sp++] = time;
+                break;
+            default: {
+                const int n = arity(instruction.op);
+                sp -= n;
+                stack[sp] = apply(instruction.op, &stack[sp]);
+                ++sp;
+                break;
+            }
+        }
+    }
+    return (sp > 0) ? stack[0] : 0.0f;
+}
+
+void Expression::evaluateBlock(const float* phase, const float* time, float* out, size_t n, Scratch& scratch) const {
+    if (size_ == 0) {
+        std::memset(out, 0, n * sizeof(float));
+        return;
+    }
+    const float* sine = sineTable().values;
+    size_t sp = 0;
+    for (size_t k = 0; k < size_; ++k) {
+        const ExpressionInstruction& instruction = code_[k];
+        // Operands and result; binary operators read a and b and write a.
+        float* a = nullptr;
+        const float* b = nullptr;
+        const float* c = nullptr;
+        const int operands = arity(instruction.op);
+        if (operands == 0) {
+            a = scratch.stack[sp++];
+        } else {
+            sp -= operands;
+            a = scratch.stack[sp];
+            b = (operands > 1) ? scratch.stack[sp + 1] : nullptr;
+            c = (operands > 2) ? scratch.stack[sp + 2] : nullptr;
+            ++sp;
+        }
+        switch (instruction.op) {
+            case ExpressionOp::Constant:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = instruction.value;
+                }
+                break;
+            case ExpressionOp::Phase:
+                std::memcpy(a, phase, n * sizeof(float));
+                break;
+            case ExpressionOp::Time:
+                std::memcpy(a, time, n * sizeof(float));
+                break;
+            case ExpressionOp::Add:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] += b[i];
+                }
+                break;
+            case ExpressionOp::Sub:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] -= b[i];
+                }
+                break;
+            case ExpressionOp::Mul:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] *= b[i];
+                }
+                break;
+            case ExpressionOp::Div:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] /= b[i];
+                }
+                break;
+            case ExpressionOp::Neg:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = -a[i];
+                }
+                break;
+            case ExpressionOp::Abs:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = std::fabs(a[i]);
+                }
+                break;
+            case ExpressionOp::Min:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = (b[i] < a[i]) ? b[i] : a[i];
+                }
+                break;
+            case ExpressionOp::Max:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = (b[i] > a[i]) ? b[i] : a[i];
+                }
+                break;
+            case ExpressionOp::Sin:
+                for (size_t i = 0; i < n; ++i) {
+                    const float position = wrap(a[i]) * SINE_POINTS;
+                    size_t index = (size_t)position;
+                    const float fraction = position - (float)index;
+                    index &= SINE_POINTS - 1;   // A phase of exactly 1 wraps to 0
+                    a[i] = sine[index] + fraction * (sine[index + 1] - sine[index]);
+                }
+                break;
+            case ExpressionOp::Tri:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = triangle(a[i]);
+                }
+                break;
+            case ExpressionOp::Saw:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = sawtooth(a[i]);
+                }
+                break;
+            case ExpressionOp::Pulse:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = pulse(a[i], b[i]);
+                }
+                break;
+            case ExpressionOp::Clamp:
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = clamp(a[i], b[i], c[i]);
+                }
+                break;
+        }
+    }
+    std::memcpy(out, scratch.stack[0], n * sizeof(float));
+}
+
+} // namespace tinyalg::waveu
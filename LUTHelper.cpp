@@ -1,3 +1,4 @@
+#include <cmath> // For std::lround
 #include <cstddef> // For size_t
 #include <stdexcept> // For exceptions
 
@@ -5,54 +6,76 @@
 
 namespace tinyalg::waveu {
 
-inline int LUTHelper::calculateIndex_16(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 4)) & (16 - 1);
-}
-inline int LUTHelper::calculateIndex_32(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 5)) & (32 - 1);
-}
-inline int LUTHelper::calculateIndex_64(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 6)) & (64 - 1);
-}
-inline int LUTHelper::calculateIndex_128(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 7)) & (128 - 1);
-}
-inline int LUTHelper::calculateIndex_256(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 8)) & (256 - 1);
-}
-inline int LUTHelper::calculateIndex_512(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 9)) & (512 - 1);
-}
-inline int LUTHelper::calculateIndex_1024(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 10)) & (1024 - 1);
-}
-inline int LUTHelper::calculateIndex_2048(size_t phaseValue, size_t numBits) {
-    return (phaseValue >> (numBits - 11)) & (2048 - 1);
-}
-
-LUTIndexFunction LUTHelper::getIndexFunction(LUTSize lutSize) {
+Result LUTHelper::tryGetIndexFunction(LUTSize lutSize, LUTIndexFunction& indexFunction) {
     switch (lutSize) {
         case LUT_16:
-            return calculateIndex_16;
+            indexFunction = calculateIndex<4>;
+            return ErrorCode::Ok;
         case LUT_32:
-            return calculateIndex_32;
+            indexFunction = calculateIndex<5>;
+            return ErrorCode::Ok;
         case LUT_64:
-            return calculateIndex_64;
+            indexFunction = calculateIndex<6>;
+            return ErrorCode::Ok;
         case LUT_128:
-            return calculateIndex_128;
+            indexFunction = calculateIndex<7>;
+            return ErrorCode::Ok;
         case LUT_256:
-            return calculateIndex_256;
+            indexFunction = calculateIndex<8>;
+            return ErrorCode::Ok;
         case LUT_512:
-            return calculateIndex_512;
+            indexFunction = calculateIndex<9>;
+            return ErrorCode::Ok;
         case LUT_1024:
-            return calculateIndex_1024;
+            indexFunction = calculateIndex<10>;
+            return ErrorCode::Ok;
         case LUT_2048:
-            return calculateIndex_2048;
-        // Add more cases for other LUT sizes
+            indexFunction = calculateIndex<11>;
+            return ErrorCode::Ok;
+        case LUT_4096:
+            indexFunction = calculateIndex<12>;
+            return ErrorCode::Ok;
+        case LUT_8192:
+            indexFunction = calculateIndex<13>;
+            return ErrorCode::Ok;
+        case LUT_16384:
+            indexFunction = calculateIndex<14>;
+            return ErrorCode::Ok;
+        case LUT_32768:
+            indexFunction = calculateIndex<15>;
+            return ErrorCode::Ok;
+        case LUT_65536:
+            indexFunction = calculateIndex<16>;
+            return ErrorCode::Ok;
         default:
-            throw std::invalid_argument("Unsupported LUT size");
+            return ErrorCode::InvalidArgument;
+    }
+}
+
+LUTIndexFunction LUTHelper::getIndexFunction(LUTSize lutSize) {
+    LUTIndexFunction indexFunction = nullptr;
+    if (!tryGetIndexFunction(lutSize, indexFunction)) {
+        WAVEU_THROW(std::invalid_argument("Unsupported LUT size"));
     }
+    return indexFunction;
+}
 
+Result LUTHelper::tryFillTable(int16_t* table, LUTSize lutSize, const std::function<float(float)>& shape) {
+    LUTIndexFunction indexFunction = nullptr;
+    if (!tryGetIndexFunction(lutSize, indexFunction)) {
+        return ErrorCode::InvalidArgument;
+    }
+    const size_t size = static_cast<size_t>(lutSize);
+    for (size_t i = 0; i < size; ++i) {
+        float v = shape(static_cast<float>(i) / size);
+        if (!(v >= -1.0f)) {
+            v = (v == v) ? -1.0f : 0.0f;  // NaN outputs silence
+        } else if (v > 1.0f) {
+            v = 1.0f;
+        }
+        table[i] = static_cast<int16_t>(std::lround(v * 32767.0f));
+    }
+    return ErrorCode::Ok;
 }
 
 std::pair<float, float> LUTHelper::adjustAmplitudeAndOffset(float amplitude, float offset) {
@@ -0,0 +1,220 @@
+#include <cmath>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "esp_heap_caps.h"
+
+#include "LUTRegistry.h"
+
+namespace tinyalg::waveu {
+
+struct SharedLUT::Entry {
+    LUTKey key;
+    void* data;
+    size_t bytes;       // Table data and this entry
+    uint32_t refs;
+    Entry* next;
+};
+
+namespace {
+
+size_t elementSize(LUTElementType type) {
+    return (type == LUTElementType::Uint8) ? 1 : 2;
+}
+
+template <typename T>
+void fill(T* table, const LUTKey& key, float lo, float hi) {
+    for (uint32_t i = 0; i < key.size; ++i) {
+        float v = key.shape(static_cast<float>(i) / key.size) * key.amplitude + key.offset;
+        if (!(v >= lo)) {
+            v = lo;
+        } else if (v > hi) {
+            v = hi;
+        }
+        table[i] = static_cast<T>(std::lround(v));
+    }
+}
+
+class Lock {
+public:
+    explicit Lock(SemaphoreHandle_t mutex) : mutex_(mutex) { xSemaphoreTake(mutex_, portMAX_DELAY); }
+    ~Lock() { xSemaphoreGive(mutex_); }
+
+    Lock(const Lock&) = delete;
+    Lock& operator=(const Lock&) = delete;
+
+private:
+    SemaphoreHandle_t mutex_;
+};
+
+} // namespace
+
+SharedLUT::SharedLUT(Entry* entry)
+    : entry_(entry), data_(entry->data), size_(entry->key.size) {}
+
+SharedLUT::SharedLUT(const SharedLUT& other)
+    : entry_(other.entry_), data_(other.data_), size_(other.size_) {
+    if (entry_) {
+        LUTRegistry::instance().retain(entry_);
+    }
+}
+
+SharedLUT::SharedLUT(SharedLUT&& other) noexcept
+    : entry_(other.entry_), data_(other.data_), size_(other.size_) {
+    other.entry_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+SharedLUT& SharedLUT::operator=(const SharedLUT& other) {
+    if (this != &other) {
+        SharedLUT copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+SharedLUT& SharedLUT::operator=(SharedLUT&& other) noexcept {
+    if (this != &other) {
+        reset();
+        entry_ = other.entry_;
+        data_ = other.data_;
+        size_ = other.size_;
+        other.entry_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void SharedLUT::reset() {
+    if (entry_) {
+        LUTRegistry::instance().release(entry_);
+    }
+    entry_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+uint32_t SharedLUT::useCount() const {
+    return entry_ ? LUTRegistry::instance().useCount(entry_) : 0;
+}
+
+LUTRegistry& LUTRegistry::instance() {
+    // Deliberately leaked: static WaveConfigs may release their tables after exit() has
+    // run the destructors of function-local statics.
+    static LUTRegistry* registry = new LUTRegistry();
+    return *registry;
+}
+
+LUTRegistry::LUTRegistry() {
+    mutex_ = xSemaphoreCreateMutexStatic(&mutexBuffer_);
+}
+
+Result LUTRegistry::tryAcquire(const LUTKey& key, SharedLUT& out) {
+    if (key.shape == nullptr || key.size == 0 || !std::isfinite(key.amplitude) || !std::isfinite(key.offset)) {
+        return ErrorCode::InvalidArgument;
+    }
+    SharedLUT::Entry* entry = retainOrBuild(key);
+    if (entry == nullptr) {
+        return ErrorCode::NoMemory;
+    }
+    // Assigned outside the lock: dropping the previous table of `out` locks again.
+    out = SharedLUT(entry);
+    return ErrorCode::Ok;
+}
+
+SharedLUT::Entry* LUTRegistry::retainOrBuild(const LUTKey& key) {
+    Lock lock(mutex_);
+    for (SharedLUT::Entry* entry = entries_; entry != nullptr; entry = entry->next) {
+        if (entry->key == key) {
+            ++entry->refs;
+            return entry;
+        }
+    }
+
+    auto* entry = new (std::nothrow) SharedLUT::Entry{key, nullptr, 0, 1, entries_};
+    const size_t dataBytes = (size_t)key.size * elementSize(key.type);
+    // Tables are read on every sample; keep them out of PSRAM.
+    void* data = entry ? heap_caps_malloc(dataBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) : nullptr;
+    if (data == nullptr) {
+        delete entry;
+        return nullptr;
+    }
+    switch (key.type) {
+        case LUTElementType::Int16:
+            fill(static_cast<int16_t*>(data), key, -32768.0f, 32767.0f);
+            break;
+        case LUTElementType::Uint16:
+            fill(static_cast<uint16_t*>(data), key, 0.0f, 65535.0f);
+            break;
+        case LUTElementType::Uint8:
+            fill(static_cast<uint8_t*>(data), key, 0.0f, 255.0f);
+            break;
+    }
+    entry->data = data;
+    entry->bytes = dataBytes + sizeof(SharedLUT::Entry);
+    entries_ = entry;
+    ++tableCount_;
+    totalBytes_ += entry->bytes;
+    if (totalBytes_ > peakBytes_) {
+        peakBytes_ = totalBytes_;
+    }
+    return entry;
+}
+
+SharedLUT LUTRegistry::acquire(const LUTKey& key) {
+    SharedLUT lut;
+    Result result = tryAcquire(key, lut);
+    if (result == ErrorCode::InvalidArgument) {
+        WAVEU_THROW(std::invalid_argument("Invalid LUT key"));
+    } else if (!result) {
+        WAVEU_THROW(std::bad_alloc());
+    }
+    return lut;
+}
+
+void LUTRegistry::retain(SharedLUT::Entry* entry) {
+    Lock lock(mutex_);
+    ++entry->refs;
+}
+
+void LUTRegistry::release(SharedLUT::Entry* entry) {
+    Lock lock(mutex_);
+    if (--entry->refs > 0) {
+        return;
+    }
+    for (SharedLUT::Entry** link = &entries_; *link != nullptr; link = &(*link)->next) {
+        if (*link == entry) {
+            *link = entry->next;
+            break;
+        }
+    }
+    --tableCount_;
+    totalBytes_ -= entry->bytes;
+    heap_caps_free(entry->data);
+    delete entry;
+}
+
+uint32_t LUTRegistry::useCount(const SharedLUT::Entry* entry) const {
+    Lock lock(mutex_);
+    return entry->refs;
+}
+
+size_t LUTRegistry::tableCount() const {
+    Lock lock(mutex_);
+    return tableCount_;
+}
+
+size_t LUTRegistry::totalBytes() const {
+    Lock lock(mutex_);
+    return totalBytes_;
+}
+
+size_t LUTRegistry::peakBytes() const {
+    Lock lock(mutex_);
+    return peakBytes_;
+}
+
+} // namespace tinyalg::waveu
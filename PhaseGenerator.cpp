@@ -12,18 +12,10 @@ void PhaseGenerator::setFrequency(float frequency) {
                            * ((double)(1ULL << N_BITS)));
 }
 
-float PhaseGenerator::getFrequency() {
+float PhaseGenerator::getFrequency() const {
     return frequency_;
 }
 
-void PhaseGenerator::updatePhase() {
-    phase_ += phaseIncrement_;
-}
-
-uint32_t PhaseGenerator::getPhase() const {
-    return phase_;
-}
-
 void PhaseGenerator::reset() {
     phase_ = 0;
 }
@@ -0,0 +1,105 @@
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "CycleCounter.h"
+#include "Profiler.h"
+
+#ifdef CONFIG_WAVEU_PROFILER
+
+namespace tinyalg::waveu {
+
+const char* Profiler::TAG = "Waveu-Profiler";
+
+static constexpr int NUM_STAGES = static_cast<int>(ProfileStage::Count);
+
+// One slot per core and stage. Each slot is only written by its own core.
+static Profiler::StageStats profile_slots[portNUM_PROCESSORS][NUM_STAGES];
+
+// Timestamp of the last message sent by the timer callback (microseconds).
+static std::atomic<uint32_t> queue_send_timestamp{0};
+
+static inline int histogramBin(uint32_t cycles) {
+    int bin = (cycles == 0) ? 0 : 31 - __builtin_clz(cycles);
+    return (bin < Profiler::NUM_HISTOGRAM_BINS) ? bin : Profiler::NUM_HISTOGRAM_BINS - 1;
+}
+
+void Profiler::record(ProfileStage stage, uint32_t cycles) {
+    StageStats& slot = profile_slots[CycleCounter::coreId()][static_cast<int>(stage)];
+    slot.count++;
+    slot.totalCycles += cycles;
+    if (cycles > slot.maxCycles) {
+        slot.maxCycles = cycles;
+    }
+    uint32_t& bin = slot.histogram[histogramBin(cycles)];
+    if (bin != UINT32_MAX) {
+        bin++;
+    }
+}
+
+void Profiler::markQueueSend() {
+    queue_send_timestamp.store(CycleCounter::micros(), std::memory_order_relaxed);
+}
+
+void Profiler::recordQueueReceive() {
+    uint32_t elapsedUs = CycleCounter::micros() - queue_send_timestamp.load(std::memory_order_relaxed);
+    record(ProfileStage::QueueLatency, elapsedUs);
+}
+
+Profiler::StageStats Profiler::snapshot(ProfileStage stage, int core) {
+    return profile_slots[core][static_cast<int>(stage)];
+}
+
+void Profiler::dump() {
+    ESP_LOGI(TAG, "%-6s %-14s %12s %10s %10s %4s", "core", "stage", "count", "avg", "max", "unit");
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (int i = 0; i < NUM_STAGES; i++) {
+            StageStats stats = profile_slots[core][i];
+            if (stats.count == 0) {
+                continue;
+            }
+            const ProfileStage stage = static_cast<ProfileStage>(i);
+            ESP_LOGI(TAG, "%-6d %-14s %12" PRIu64 " %10u %10u %4s", core, toString(stage),
+                     stats.count, (unsigned)(stats.totalCycles / stats.count), (unsigned)stats.maxCycles,
+                     unitOf(stage));
+            for (int bin = 0; bin < NUM_HISTOGRAM_BINS; bin++) {
+                if (stats.histogram[bin] != 0) {
+                    ESP_LOGI(TAG, "%21s>=2^%-2d: %u", "", bin, (unsigned)stats.histogram[bin]);
+                }
+            }
+        }
+    }
+}
+
+void Profiler::clear() {
+    std::memset(profile_slots, 0, sizeof(profile_slots));
+}
+
+const char* Profiler::toString(ProfileStage stage) {
+    switch (stage) {
+        case ProfileStage::PrepareCycle: return "PrepareCycle";
+        case ProfileStage::Render:       return "Render";
+        case ProfileStage::PhaseStep:    return "PhaseStep";
+        case ProfileStage::IndexCompute: return "IndexCompute";
+        case ProfileStage::LutFetch:     return "LutFetch";
+        case ProfileStage::BufferWrite:  return "BufferWrite";
+        case ProfileStage::ProducerWait: return "ProducerWait";
+        case ProfileStage::ConsumerWait: return "ConsumerWait";
+        case ProfileStage::QueueLatency: return "QueueLatency";
+        case ProfileStage::DacWrite:     return "DacWrite";
+        case ProfileStage::StartOutput:  return "StartOutput";
+        case ProfileStage::StopOutput:   return "StopOutput";
+        default:                         return "Unknown";
+    }
+}
+
+const char* Profiler::unitOf(ProfileStage stage) {
+    return (stage == ProfileStage::QueueLatency) ? "us" : "cyc";
+}
+
+} // namespace tinyalg::waveu
+
+#endif // CONFIG_WAVEU_PROFILER
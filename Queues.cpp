@@ -4,4 +4,5 @@
 namespace tinyalg::waveu {
     QueueHandle_t dataGenerationQueue;
     QueueHandle_t dataOutputQueue;
+    QueueSetHandle_t producerQueueSet;
 } // namespace tinyalg::waveu
@@ -0,0 +1,298 @@
+#include <atomic>
+#include <cstring>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "RecorderTap.h"
+
+#ifdef CONFIG_WAVEU_RECORDER
+
+// The recorder taps the DAC transfer task of ESP32Config; the sample rate of the WAV
+// header and the buffer size checked by start() are taken from it.
+#include "ESP32Config.h"
+
+namespace tinyalg::waveu {
+
+const char* RecorderTap::TAG = "Waveu-Recorder";
+
+static_assert((RecorderTap::RING_SIZE & (RecorderTap::RING_SIZE - 1)) == 0,
+              "CONFIG_WAVEU_RECORDER_RING_SIZE must be a power of two");
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+static constexpr uint32_t RECORDER_CHANNELS = NUM_CHANNELS;
+#else
+static constexpr uint32_t RECORDER_CHANNELS = 1;
+#endif
+
+static constexpr size_t WAV_HEADER_SIZE = 44;
+static constexpr uint32_t RING_MASK = RecorderTap::RING_SIZE - 1;
+
+// Byte ring. The consumer task owns ring_head, the drain task owns ring_tail.
+// Both count bytes ever written/read and wrap around naturally.
+static uint8_t ring[RecorderTap::RING_SIZE];
+static std::atomic<uint32_t> ring_head{0};
+static std::atomic<uint32_t> ring_tail{0};
+
+static std::atomic<bool> recording{false};       // capture() copies into the ring
+static std::atomic<uint32_t> captures_in_flight{0}; // capture() calls that may still notify the drain task
+static std::atomic<bool> drain_running{false};   // The drain task keeps running
+static std::atomic<bool> reset_requested{false};
+static uint64_t next_sample_index = 0;   // Owned by the consumer task
+
+static std::atomic<uint32_t> captured_buffers{0};
+static std::atomic<uint32_t> dropped_buffers{0};
+static uint64_t dropped_samples = 0;     // Written by the consumer task only
+static uint64_t written_bytes = 0;       // Written by the drain task only
+
+static FILE* output_file = nullptr;
+static RecorderFormat output_format = RecorderFormat::Raw;
+static long wav_header_position = 0;
+static uint64_t drain_expected_index = 0;
+static bool drain_has_expected = false;
+
+static TaskHandle_t drain_task_handle = nullptr;
+static SemaphoreHandle_t drain_done_semaphore = nullptr;
+
+static void ringWrite(uint32_t pos, const void* src, size_t len) {
+    size_t offset = pos & RING_MASK;
+    size_t first = (len < RecorderTap::RING_SIZE - offset) ? len : RecorderTap::RING_SIZE - offset;
+    std::memcpy(&ring[offset], src, first);
+    std::memcpy(&ring[0], (const uint8_t*)src + first, len - first);
+}
+
+static void ringRead(uint32_t pos, void* dst, size_t len) {
+    size_t offset = pos & RING_MASK;
+    size_t first = (len < RecorderTap::RING_SIZE - offset) ? len : RecorderTap::RING_SIZE - offset;
+    std::memcpy(dst, &ring[offset], first);
+    std::memcpy((uint8_t*)dst + first, &ring[0], len - first);
+}
+
+static size_t ringWriteToFile(uint32_t pos, size_t len) {
+    size_t offset = pos & RING_MASK;
+    size_t first = (len < RecorderTap::RING_SIZE - offset) ? len : RecorderTap::RING_SIZE - offset;
+    size_t written = fwrite(&ring[offset], 1, first, output_file);
+    if (len > first) {
+        written += fwrite(&ring[0], 1, len - first, output_file);
+    }
+    return written;
+}
+
+static void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void putLE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void writeWavHeader(uint32_t dataBytes) {
+    uint8_t h[WAV_HEADER_SIZE];
+    const uint16_t blockAlign = (uint16_t)RECORDER_CHANNELS;   // 8 bits per sample
+    std::memcpy(&h[0], "RIFF", 4);
+    putLE32(&h[4], 36 + dataBytes);
+    std::memcpy(&h[8], "WAVEfmt ", 8);
+    putLE32(&h[16], 16);                                    // fmt chunk size
+    putLE16(&h[20], 1);                                     // PCM
+    putLE16(&h[22], (uint16_t)RECORDER_CHANNELS);
+    putLE32(&h[24], ESP32Config::SAMPLE_RATE);
+    putLE32(&h[28], ESP32Config::SAMPLE_RATE * blockAlign); // Byte rate
+    putLE16(&h[32], blockAlign);
+    putLE16(&h[34], 8);                                     // Bits per sample
+    std::memcpy(&h[36], "data", 4);
+    putLE32(&h[40], dataBytes);
+    fwrite(h, 1, sizeof(h), output_file);
+}
+
+static void drainTask(void* args) {
+    while (drain_running.load(std::memory_order_acquire)) {
+        // Woken by capture(); the timeout only bounds the latency of stop().
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        RecorderTap::drain();
+    }
+    RecorderTap::drain();
+    xSemaphoreGive(drain_done_semaphore);
+
+    // stop() deletes this task once it has taken the semaphore. The task does not
+    // delete itself, so its handle stays valid for as long as stop() may notify it.
+    vTaskSuspend(NULL);
+}
+
+esp_err_t RecorderTap::start(FILE* out, RecorderFormat format) {
+    if (out == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (drain_running.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (RING_SIZE < sizeof(RecordHeader) + ESP32Config::LEN_DATA_BUFFER) {
+        ESP_LOGE(TAG, "CONFIG_WAVEU_RECORDER_RING_SIZE=%u cannot hold a buffer of %u bytes and its header",
+                 (unsigned)RING_SIZE, (unsigned)ESP32Config::LEN_DATA_BUFFER);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    output_file = out;
+    output_format = format;
+    written_bytes = 0;
+    drain_has_expected = false;
+    captured_buffers.store(0, std::memory_order_relaxed);
+    dropped_buffers.store(0, std::memory_order_relaxed);
+    dropped_samples = 0;
+    ring_tail.store(ring_head.load(std::memory_order_acquire), std::memory_order_release);
+
+    if (format == RecorderFormat::Wav) {
+        wav_header_position = ftell(out);
+        writeWavHeader(0);
+        written_bytes += WAV_HEADER_SIZE;
+    }
+
+    drain_done_semaphore = xSemaphoreCreateBinary();
+    if (drain_done_semaphore == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    drain_running.store(true, std::memory_order_release);
+    if (xTaskCreate(drainTask, "waveuRecorderTask", CONFIG_WAVEU_RECORDER_TASK_STACK_SIZE, nullptr,
+                    CONFIG_WAVEU_RECORDER_TASK_PRIORITY, &drain_task_handle) != pdPASS) {
+        drain_running.store(false, std::memory_order_release);
+        vSemaphoreDelete(drain_done_semaphore);
+        drain_done_semaphore = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    // Only capture once the drain task handle is valid, as capture() notifies it.
+    recording.store(true, std::memory_order_release);
+    ESP_LOGI(TAG, "Recording started (%s, ring %u bytes)",
+             format == RecorderFormat::Wav ? "wav" : "raw", (unsigned)RING_SIZE);
+    return ESP_OK;
+}
+
+esp_err_t RecorderTap::stop() {
+    // Sequentially consistent with capture(): either a capture sees recording == false,
+    // or this task sees it in flight and waits until it has notified the drain task.
+    if (!recording.exchange(false)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    while (captures_in_flight.load() != 0) {
+        vTaskDelay(1);
+    }
+
+    // No capture() refers to the drain task any more; unpublish it before it finishes.
+    TaskHandle_t task = drain_task_handle;
+    drain_task_handle = nullptr;
+    drain_running.store(false, std::memory_order_release);
+
+    // Wake the drain task so that it notices the stop request, then wait for the final drain.
+    xTaskNotifyGive(task);
+    xSemaphoreTake(drain_done_semaphore, portMAX_DELAY);
+    vTaskDelete(task);
+    vSemaphoreDelete(drain_done_semaphore);
+    drain_done_semaphore = nullptr;
+
+    // Pick up a buffer that was captured after the drain task's last pass.
+    drain();
+
+    if (output_format == RecorderFormat::Wav) {
+        long end = ftell(output_file);
+        if (end >= 0 && fseek(output_file, wav_header_position, SEEK_SET) == 0) {
+            writeWavHeader((uint32_t)(written_bytes - WAV_HEADER_SIZE));
+            fseek(output_file, end, SEEK_SET);
+        } else {
+            ESP_LOGW(TAG, "Output is not seekable; the WAV header keeps a zero length.");
+        }
+    }
+    fflush(output_file);
+    output_file = nullptr;
+
+    RecorderStats s = stats();
+    ESP_LOGI(TAG, "Recording stopped: captured=%u dropped=%u (%llu samples) written=%llu bytes",
+             (unsigned)s.capturedBuffers, (unsigned)s.droppedBuffers,
+             (unsigned long long)s.droppedSamples, (unsigned long long)s.writtenBytes);
+    return ESP_OK;
+}
+
+void RecorderTap::capture(const data_buf_type_t* data, size_t len) {
+    if (reset_requested.exchange(false, std::memory_order_acquire)) {
+        next_sample_index = 0;
+    }
+    const uint64_t sampleIndex = next_sample_index;
+    next_sample_index += len / RECORDER_CHANNELS;
+
+    // Announce the capture before checking the flag, so that stop() waits for it.
+    captures_in_flight.fetch_add(1);
+    if (!recording.load()) {
+        captures_in_flight.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    const size_t recordSize = sizeof(RecordHeader) + len;
+    uint32_t head = ring_head.load(std::memory_order_relaxed);
+    uint32_t used = head - ring_tail.load(std::memory_order_acquire);
+    if (recordSize > RING_SIZE - used) {
+        // Never wait for the drain task; drop the whole buffer instead.
+        dropped_buffers.fetch_add(1, std::memory_order_relaxed);
+        dropped_samples += len / RECORDER_CHANNELS;
+    } else {
+        RecordHeader header = { sampleIndex, (uint32_t)len, RECORDER_CHANNELS };
+        ringWrite(head, &header, sizeof(header));
+        ringWrite(head + sizeof(header), data, len);
+        ring_head.store(head + recordSize, std::memory_order_release);
+        captured_buffers.fetch_add(1, std::memory_order_relaxed);
+
+        xTaskNotifyGive(drain_task_handle);
+    }
+    captures_in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+void RecorderTap::resetSampleIndex() {
+    reset_requested.store(true, std::memory_order_release);
+}
+
+size_t RecorderTap::drain() {
+    size_t written = 0;
+    uint32_t tail = ring_tail.load(std::memory_order_relaxed);
+    const uint32_t head = ring_head.load(std::memory_order_acquire);
+
+    while (head - tail >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        ringRead(tail, &header, sizeof(header));
+
+        if (output_format == RecorderFormat::Raw) {
+            written += fwrite(&header, 1, sizeof(header), output_file);
+        } else if (drain_has_expected && header.sampleIndex > drain_expected_index) {
+            ESP_LOGW(TAG, "Gap in recording at sample %llu (next recorded: %llu)",
+                     (unsigned long long)drain_expected_index, (unsigned long long)header.sampleIndex);
+        }
+        written += ringWriteToFile(tail + sizeof(header), header.length);
+
+        drain_expected_index = header.sampleIndex + header.length / header.channels;
+        drain_has_expected = true;
+        tail += sizeof(header) + header.length;
+        ring_tail.store(tail, std::memory_order_release);
+    }
+
+    written_bytes += written;
+    return written;
+}
+
+RecorderStats RecorderTap::stats() {
+    return {
+        captured_buffers.load(std::memory_order_relaxed),
+        dropped_buffers.load(std::memory_order_relaxed),
+        dropped_samples,
+        written_bytes,
+    };
+}
+
+bool RecorderTap::isRecording() {
+    return recording.load(std::memory_order_acquire);
+}
+
+} // namespace tinyalg::waveu
+
+#endif // CONFIG_WAVEU_RECORDER
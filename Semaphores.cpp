@@ -7,4 +7,6 @@ SemaphoreHandle_t pingBufferSemaphore;
 
 SemaphoreHandle_t pongBufferSemaphore;
 
+SemaphoreHandle_t commandSemaphore;
+
 }
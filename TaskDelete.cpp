@@ -15,6 +15,7 @@ void waveformDataGenerationTaskDelete() {
     data_generation_msg_type_t task_termination_msg = {
         .data = false, // Whichever ture or false
         .terminationTrigger = true, // Signals termination
+        .period = 0,
     };
 
     if (xQueueSend(dataGenerationQueue, (void *)&task_termination_msg, pdMS_TO_TICKS(1000)) != pdPASS) {
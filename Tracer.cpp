@@ -0,0 +1,349 @@
+#include <atomic>
+#include <cinttypes>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "CycleCounter.h"
+#include "Tracer.h"
+
+#ifdef CONFIG_WAVEU_TRACE
+
+namespace tinyalg::waveu {
+
+const char* Tracer::TAG = "Waveu-Tracer";
+
+static_assert((Tracer::RING_EVENTS & (Tracer::RING_EVENTS - 1)) == 0,
+              "CONFIG_WAVEU_TRACE_RING_EVENTS must be a power of two");
+static_assert(Tracer::RING_EVENTS >= 2 * Tracer::ANCHOR_INTERVAL,
+              "CONFIG_WAVEU_TRACE_RING_EVENTS must hold at least two anchors");
+
+static constexpr uint32_t RING_MASK = Tracer::RING_EVENTS - 1;
+static constexpr uint32_t NUM_ANCHORS = Tracer::RING_EVENTS / Tracer::ANCHOR_INTERVAL;
+
+struct TraceRecord {
+    uint32_t cycles;
+    uint16_t arg;
+    TraceEvent event;
+    TracePhase phase;
+};
+
+// The microsecond clock at the cycle count of the record `tag - 1`. A tag of 0 marks an
+// unused anchor; the tag is published last, so a matching tag means the pair is complete.
+struct TraceAnchor {
+    uint32_t cycles;
+    uint32_t micros;
+    std::atomic<uint32_t> tag;
+};
+
+// One ring per core. `head` counts the events ever reserved and wraps around naturally.
+struct TraceRing {
+    std::atomic<uint32_t> head;
+    TraceRecord records[Tracer::RING_EVENTS];
+    TraceAnchor anchors[NUM_ANCHORS];
+};
+
+static TraceRing trace_rings[portNUM_PROCESSORS];
+static std::atomic<bool> tracing{false};
+static std::atomic<uint32_t> records_in_flight{0};  // record() calls that may still write a ring
+
+// Tracks of the exported trace, one per task.
+enum TraceTrack : int {
+    TimerTrack = 1,
+    ProducerTrack = 2,
+    ConsumerTrack = 3,
+};
+
+static TraceTrack trackOf(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::TimerTick:
+        case TraceEvent::OutputQueueSend:
+        case TraceEvent::OutputDropped:
+        case TraceEvent::GenerationQueueSend:
+        case TraceEvent::RequestDropped:
+            return TimerTrack;
+        case TraceEvent::OutputQueueReceive:
+        case TraceEvent::ConsumerWait:
+        case TraceEvent::DacWrite:
+            return ConsumerTrack;
+        default:
+            return ProducerTrack;
+    }
+}
+
+void Tracer::record(TraceEvent event, TracePhase phase, uint16_t arg) {
+    if (!tracing.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // Announce the record before checking the flag again, so that stop() waits for it.
+    records_in_flight.fetch_add(1);
+    if (!tracing.load()) {
+        records_in_flight.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+    TraceRing& ring = trace_rings[CycleCounter::coreId()];
+    // A task preempting this one between the increment and the store takes the next
+    // slot, so its event may precede this one in the ring by a few cycles.
+    const uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t cycles = CycleCounter::now();
+    ring.records[index & RING_MASK] = {cycles, arg, event, phase};
+
+    if ((index & (ANCHOR_INTERVAL - 1)) == 0) {
+        TraceAnchor& anchor = ring.anchors[(index / ANCHOR_INTERVAL) % NUM_ANCHORS];
+        anchor.tag.store(0, std::memory_order_relaxed);
+        anchor.cycles = cycles;
+        anchor.micros = CycleCounter::micros();
+        anchor.tag.store(index + 1, std::memory_order_release);
+    }
+    records_in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+void Tracer::start() {
+    tracing.store(true, std::memory_order_release);
+}
+
+void Tracer::stop() {
+    tracing.store(false);
+    // A task preempted inside record() finishes its event once it runs again.
+    while (records_in_flight.load() != 0) {
+        vTaskDelay(1);
+    }
+}
+
+bool Tracer::isTracing() {
+    return tracing.load(std::memory_order_acquire);
+}
+
+void Tracer::clear() {
+    for (TraceRing& ring : trace_rings) {
+        ring.head.store(0, std::memory_order_relaxed);
+        for (TraceAnchor& anchor : ring.anchors) {
+            anchor.tag.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+TraceStats Tracer::stats() {
+    TraceStats stats = {};
+    for (TraceRing& ring : trace_rings) {
+        const uint32_t head = ring.head.load(std::memory_order_acquire);
+        stats.recordedEvents += head;
+        stats.overwrittenEvents += (head > RING_EVENTS) ? head - RING_EVENTS : 0;
+    }
+    return stats;
+}
+
+size_t Tracer::memoryBytes() {
+    return sizeof(trace_rings);
+}
+
+namespace {
+
+/**
+ * @brief Walks the events of one ring in order and puts them on the time base of the
+ *        microsecond clock.
+ *
+ * Cycle counts are accumulated as signed 32-bit differences between neighbouring
+ * events, which is correct across wrap-arounds of the counter as long as neighbouring
+ * events are less than 2^31 cycles apart.
+ */
+struct RingCursor {
+    const TraceRing* ring = nullptr;
+    int core = 0;
+    uint32_t next = 0;
+    uint32_t end = 0;
+    int64_t cycles = 0;         // Of `next`, relative to the anchor
+    uint32_t anchorMicros = 0;
+
+    bool valid() const { return next != end; }
+
+    const TraceRecord& current() const { return ring->records[next & RING_MASK]; }
+
+    uint32_t rawCycles(uint32_t index) const { return ring->records[index & RING_MASK].cycles; }
+
+    // Relative to `referenceMicros`.
+    double micros(uint32_t referenceMicros) const {
+        return (double)(int32_t)(anchorMicros - referenceMicros)
+             + (double)cycles / (double)CycleCounter::cyclesPerMicrosecond();
+    }
+
+    void advance() {
+        next++;
+        if (valid()) {
+            cycles += (int32_t)(rawCycles(next) - rawCycles(next - 1));
+        }
+    }
+
+    /**
+     * @return false if the ring is empty or has no complete anchor.
+     */
+    bool open(const TraceRing& r, int c) {
+        ring = &r;
+        core = c;
+        const uint32_t head = r.head.load(std::memory_order_acquire);
+        const uint32_t count = (head < Tracer::RING_EVENTS) ? head : Tracer::RING_EVENTS;
+        next = head - count;
+        end = head;
+        if (count == 0) {
+            return false;
+        }
+
+        // The newest anchor may still be written by a preempted task; fall back to the one before.
+        uint32_t anchor = ((head - 1) / Tracer::ANCHOR_INTERVAL) * Tracer::ANCHOR_INTERVAL;
+        for (int attempt = 0; attempt < 2; attempt++) {
+            const TraceAnchor& a = r.anchors[(anchor / Tracer::ANCHOR_INTERVAL) % NUM_ANCHORS];
+            if (a.tag.load(std::memory_order_acquire) == anchor + 1 && anchor - next < count) {
+                anchorMicros = a.micros;
+                cycles = 0;
+                for (uint32_t i = anchor; i != next; i--) {
+                    cycles -= (int32_t)(rawCycles(i) - rawCycles(i - 1));
+                }
+                return true;
+            }
+            anchor -= Tracer::ANCHOR_INTERVAL;
+        }
+        return false;
+    }
+};
+
+const char* phaseOf(TracePhase phase) {
+    switch (phase) {
+        case TracePhase::Begin: return "B";
+        case TracePhase::End:   return "E";
+        default:                return "i";
+    }
+}
+
+void writeArgs(FILE* out, const TraceRecord& record, int core) {
+    switch (record.event) {
+        case TraceEvent::TimerTick:
+            fprintf(out, "\"args\":{\"core\":%d,\"period\":%u}", core, (unsigned)record.arg);
+            break;
+        case TraceEvent::OutputDropped:
+        case TraceEvent::RequestDropped:
+        case TraceEvent::PrepareCycle:
+        case TraceEvent::StartOutput:
+        case TraceEvent::StopOutput:
+            fprintf(out, "\"args\":{\"core\":%d}", core);
+            break;
+        default:
+            fprintf(out, "\"args\":{\"core\":%d,\"buffer\":\"%s\"}", core, record.arg ? "ping" : "pong");
+            break;
+    }
+}
+
+void writeThreadName(FILE* out, int track, const char* name) {
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            track, name);
+    fprintf(out, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+            track, track);
+}
+
+} // namespace
+
+esp_err_t Tracer::exportChromeTrace(FILE* out) {
+    if (out == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    RingCursor cursors[portNUM_PROCESSORS];
+    bool hasReference = false;
+    uint32_t referenceMicros = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (!cursors[core].open(trace_rings[core], core)) {
+            cursors[core].end = cursors[core].next;    // Nothing to export
+            continue;
+        }
+        if (!hasReference) {
+            referenceMicros = cursors[core].anchorMicros;
+            hasReference = true;
+        }
+    }
+
+    // Start the timeline at the oldest event.
+    double origin = 0.0;
+    bool hasOrigin = false;
+    for (const RingCursor& cursor : cursors) {
+        if (cursor.valid() && (!hasOrigin || cursor.micros(referenceMicros) < origin)) {
+            origin = cursor.micros(referenceMicros);
+            hasOrigin = true;
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Waveu\"}}");
+    writeThreadName(out, TimerTrack, "timer");
+    writeThreadName(out, ProducerTrack, "producer");
+    writeThreadName(out, ConsumerTrack, "consumer");
+
+    // Merge the rings by time. Spans whose beginning has been overwritten are left out.
+    uint32_t exported = 0;
+    int openSpans[ConsumerTrack + 1] = {};
+    for (;;) {
+        RingCursor* earliest = nullptr;
+        for (RingCursor& cursor : cursors) {
+            if (cursor.valid() && (earliest == nullptr
+                                   || cursor.micros(referenceMicros) < earliest->micros(referenceMicros))) {
+                earliest = &cursor;
+            }
+        }
+        if (earliest == nullptr) {
+            break;
+        }
+
+        const TraceRecord& record = earliest->current();
+        const TraceTrack track = trackOf(record.event);
+        if (record.phase == TracePhase::Begin) {
+            openSpans[track]++;
+        } else if (record.phase == TracePhase::End) {
+            if (openSpans[track] == 0) {
+                earliest->advance();
+                continue;
+            }
+            openSpans[track]--;
+        }
+        fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"waveu\",\"ph\":\"%s\",%s\"ts\":%.3f,\"pid\":1,\"tid\":%d,",
+                toString(record.event), phaseOf(record.phase),
+                (record.phase == TracePhase::Instant) ? "\"s\":\"t\"," : "",
+                earliest->micros(referenceMicros) - origin, (int)track);
+        writeArgs(out, record, earliest->core);
+        fprintf(out, "}");
+        exported++;
+        earliest->advance();
+    }
+    fprintf(out, "\n]}\n");
+    fflush(out);
+
+    if (ferror(out)) {
+        ESP_LOGE(TAG, "Failed to write the trace.");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Exported %" PRIu32 " events.", exported);
+    return ESP_OK;
+}
+
+const char* Tracer::toString(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::TimerTick:              return "TimerTick";
+        case TraceEvent::OutputQueueSend:        return "OutputQueueSend";
+        case TraceEvent::OutputDropped:          return "OutputDropped";
+        case TraceEvent::GenerationQueueSend:    return "GenerationQueueSend";
+        case TraceEvent::RequestDropped:         return "RequestDropped";
+        case TraceEvent::GenerationQueueReceive: return "GenerationQueueReceive";
+        case TraceEvent::ProducerWait:           return "ProducerWait";
+        case TraceEvent::PrepareCycle:           return "PrepareCycle";
+        case TraceEvent::Render:                 return "Render";
+        case TraceEvent::Substitute:             return "Substitute";
+        case TraceEvent::OutputQueueReceive:     return "OutputQueueReceive";
+        case TraceEvent::ConsumerWait:           return "ConsumerWait";
+        case TraceEvent::DacWrite:               return "DacWrite";
+        case TraceEvent::StartOutput:            return "StartOutput";
+        case TraceEvent::StopOutput:             return "StopOutput";
+        default:                                 return "Unknown";
+    }
+}
+
+} // namespace tinyalg::waveu
+
+#endif // CONFIG_WAVEU_TRACE
@@ -1,3 +1,6 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 
 #include "Semaphores.h"
@@ -10,15 +13,13 @@ namespace tinyalg::waveu {
 const char* WaveuHelper::TAG = "WaveuHelper";
 
 bool WaveuHelper::initQueues() {
-    size_t queueLength = 1;
-    dataGenerationQueue = xQueueCreate(queueLength, sizeof(data_generation_msg_type_t));
+    dataGenerationQueue = xQueueCreate(GENERATION_QUEUE_LENGTH, sizeof(data_generation_msg_type_t));
     if (dataGenerationQueue == 0) {
         ESP_LOGE(TAG, "dataGenerationQueue cannot be created.");
         return false;
     }
     
-    queueLength = 10;
-    dataOutputQueue = xQueueCreate(queueLength, sizeof(data_output_msg_type_t));
+    dataOutputQueue = xQueueCreate(OUTPUT_QUEUE_LENGTH, sizeof(data_output_msg_type_t));
     if (dataOutputQueue == 0) {
         ESP_LOGE(TAG, "dataOutputQueue cannot be created.");
         return false;
@@ -38,6 +39,34 @@ void WaveuHelper::initSemaphore()
     if (pongBufferSemaphore == NULL) {
         ESP_LOGE(TAG, "semaphore creation failure");
     }
+
+    // Given once for any number of queued commands.
+    commandSemaphore = xSemaphoreCreateBinary();
+    if (commandSemaphore == NULL) {
+        ESP_LOGE(TAG, "semaphore creation failure");
+    }
+}
+
+bool WaveuHelper::initQueueSet() {
+    // One event for the render request and one for the command semaphore.
+    producerQueueSet = xQueueCreateSet(1 + 1);
+    if (producerQueueSet == NULL) {
+        ESP_LOGE(TAG, "producerQueueSet cannot be created.");
+        return false;
+    }
+    if (xQueueAddToSet(dataGenerationQueue, producerQueueSet) != pdPASS ||
+        xQueueAddToSet(commandSemaphore, producerQueueSet) != pdPASS) {
+        ESP_LOGE(TAG, "producerQueueSet cannot be populated.");
+        return false;
+    }
+    return true;
+}
+
+void WaveuHelper::deleteQueueSet() {
+    xQueueRemoveFromSet(dataGenerationQueue, producerQueueSet);
+    xQueueRemoveFromSet(commandSemaphore, producerQueueSet);
+    vQueueDelete(producerQueueSet);
+    vSemaphoreDelete(commandSemaphore);
 }
 
 } // namespace tinyalg::waveu
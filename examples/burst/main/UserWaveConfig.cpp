@@ -0,0 +1,54 @@
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "ESP32Waveu.h"
+
+using namespace tinyalg::waveu;
+
+static const char* TAG = "UserWaveConfig";
+
+// GPIO used as external trigger input (rising edge).
+static constexpr gpio_num_t TRIGGER_GPIO = GPIO_NUM_0;
+
+// A 10 kHz sine, gated into bursts.
+using UserWaveConfig = Burst<Pipeline<Oscillator<LUT<Sine, LUT_256>>, Quantize8>>;
+
+extern "C" {
+    void app_main(void)
+    {
+        // Initialize the waveform generator with the gated waveform.
+        ESP32Waveu<UserWaveConfig> waveu;
+
+        // Emit 5 cycles of 10 kHz per trigger, idle at mid-scale in between.
+        UserWaveConfig::settings_type burst;
+        burst.cycles = 5;
+        burst.frequency = 10000.0f;
+        burst.triggerOffsetSamples = 0;
+        waveu.chan.configureBurst(burst);
+
+        // Also start a burst on every rising edge of the trigger GPIO.
+        ESP_ERROR_CHECK(waveu.chan.attachGpioTrigger(TRIGGER_GPIO, GPIO_INTR_POSEDGE));
+
+        OscillatorArgs waveArgs(burst.frequency);
+
+        Result result = waveu.tryConfigure(waveArgs);
+        if (result) {
+            result = waveu.tryStart();
+        }
+        if (!result) {
+            ESP_LOGE(TAG, "Failed to start: %s", result.toString());
+        }
+
+        // Fire a software trigger once per second and report the latency.
+        while (1) {
+            waveu.chan.trigger();
+            vTaskDelay(pdMS_TO_TICKS(1000));
+
+            BurstStats stats = waveu.chan.stats();
+            ESP_LOGI(TAG, "triggers=%u, ignored=%u, post-to-render=%uus, offset=%u samples",
+                     (unsigned)stats.triggers, (unsigned)stats.ignoredTriggers,
+                     (unsigned)stats.lastPostToRenderUs, (unsigned)stats.lastOffsetSamples);
+        }
+    }
+}
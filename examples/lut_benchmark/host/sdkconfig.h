@@ -0,0 +1,4 @@
+#pragma once
+
+// Stand-in for the header generated by ESP-IDF when the benchmark is built on a host.
+// No Waveu options are enabled, so the profiler hooks in PhaseGenerator compile to nothing.
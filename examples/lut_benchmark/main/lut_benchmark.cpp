@@ -0,0 +1,514 @@
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "Decimated.h"
+#include "LUTHelper.h"
+#include "PhaseGenerator.h"
+
+using tinyalg::waveu::LinearUpsampler;
+using tinyalg::waveu::LUTHelper;
+using tinyalg::waveu::LUTIndex;
+using tinyalg::waveu::LUTIndexFunction;
+using tinyalg::waveu::LUTIndexMapper;
+using tinyalg::waveu::LUTSize;
+using tinyalg::waveu::PhaseGenerator;
+
+namespace {
+
+// Same as ESP32Config::SAMPLE_RATE.
+constexpr uint32_t SAMPLE_RATE = 1000000;
+
+#ifdef ESP_PLATFORM
+constexpr size_t FFT_SIZE = 4096;           // Fits into internal RAM
+constexpr size_t TIMED_SAMPLES = 1 << 18;
+#else
+constexpr size_t FFT_SIZE = 65536;
+constexpr size_t TIMED_SAMPLES = 1 << 22;
+#endif
+
+// Half width of the Blackman-Harris main lobe in bins, plus margin.
+constexpr size_t LOBE_BINS = 5;
+constexpr int NUM_HARMONICS = 10;
+// Images of the table length, i.e. harmonics k * size +/- 1 for k = 1..NUM_TABLE_IMAGES.
+constexpr int NUM_TABLE_IMAGES = 4;
+
+constexpr LUTSize LUT_SIZES[] = {
+    tinyalg::waveu::LUT_16, tinyalg::waveu::LUT_32, tinyalg::waveu::LUT_64,
+    tinyalg::waveu::LUT_128, tinyalg::waveu::LUT_256, tinyalg::waveu::LUT_512,
+    tinyalg::waveu::LUT_1024, tinyalg::waveu::LUT_2048, tinyalg::waveu::LUT_4096,
+    tinyalg::waveu::LUT_8192,
+#ifndef ESP_PLATFORM
+    tinyalg::waveu::LUT_16384, tinyalg::waveu::LUT_32768, tinyalg::waveu::LUT_65536,
+#endif
+};
+
+constexpr float FREQUENCIES[] = { 1000.0f, 10000.0f, 50000.0f, 200000.0f };
+
+constexpr float UPSAMPLER_FREQUENCIES[] = { 1000.0f, 2000.0f, 5000.0f };
+
+enum class LookupMode { Truncate, Interpolate };
+
+/**
+ * @brief Spectral figures of one capture.
+ */
+struct Quality {
+    double thd_dbc;     // Harmonics 2..NUM_HARMONICS and the table images relative to the fundamental
+    double sfdr_dbc;    // Largest spur below the fundamental
+    double snr_db;      // Fundamental over everything except DC, harmonics and table images
+    double sinad_db;    // Fundamental over everything except DC
+};
+
+/**
+ * @brief Describes one LUT data type and how the application maps it to the 8-bit DAC.
+ */
+template <typename T>
+struct LutType;
+
+template <>
+struct LutType<int16_t> {
+    static constexpr const char* NAME = "int16";
+    static constexpr double AMPLITUDE = 32767.0;
+    static constexpr double OFFSET = 0.0;
+    static uint8_t toDac(int32_t v) { return (uint8_t)((v + 32768) >> 8); }
+};
+
+template <>
+struct LutType<uint16_t> {
+    static constexpr const char* NAME = "uint16";
+    static constexpr double AMPLITUDE = 32767.5;
+    static constexpr double OFFSET = 32767.5;
+    static uint8_t toDac(int32_t v) { return (uint8_t)(v >> 8); }
+};
+
+template <>
+struct LutType<uint8_t> {
+    static constexpr const char* NAME = "uint8";
+    static constexpr double AMPLITUDE = 127.5;
+    static constexpr double OFFSET = 127.5;
+    static uint8_t toDac(int32_t v) { return (uint8_t)v; }
+};
+
+void fft(std::vector<std::complex<double>>& a) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double angle = -2.0 * M_PI / (double)len;
+        const std::complex<double> wlen(std::cos(angle), std::sin(angle));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1.0);
+            for (size_t k = 0; k < len / 2; k++) {
+                std::complex<double> u = a[i + k];
+                std::complex<double> v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+double blackmanHarris(size_t i, size_t n) {
+    const double x = 2.0 * M_PI * (double)i / (double)n;
+    return 0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2 * x) - 0.01168 * std::cos(3 * x);
+}
+
+double toDb(double ratio) {
+    return 10.0 * std::log10(ratio > 0.0 ? ratio : 1e-30);
+}
+
+/**
+ * @brief Computes THD, SFDR, SNR and SINAD of a capture of a sine wave.
+ *
+ * A table of `tableLength` entries per period steps through the sine, so besides the
+ * low harmonics of the amplitude error it distorts at harmonics `k * tableLength +/- 1`.
+ * These are aliased into the band and counted as distortion as well.
+ *
+ * @param capture FFT_SIZE samples.
+ * @param frequency The frequency actually generated, in Hz.
+ * @param tableLength The number of table entries per period.
+ */
+Quality analyze(const std::vector<double>& capture, double frequency, size_t tableLength) {
+    const size_t n = capture.size();
+    double mean = 0.0;
+    for (double v : capture) {
+        mean += v;
+    }
+    mean /= (double)n;
+
+    std::vector<std::complex<double>> spectrum(n);
+    for (size_t i = 0; i < n; i++) {
+        spectrum[i] = (capture[i] - mean) * blackmanHarris(i, n);
+    }
+    fft(spectrum);
+
+    const size_t half = n / 2;
+    std::vector<double> power(half + 1);
+    for (size_t k = 0; k <= half; k++) {
+        power[k] = std::norm(spectrum[k]);
+    }
+
+    // Marks the bins that belong to DC, the fundamental or a harmonic.
+    std::vector<uint8_t> owner(half + 1, 0);
+    auto lobe = [&](size_t center, uint8_t tag) {
+        double sum = 0.0;
+        size_t lo = (center > LOBE_BINS) ? center - LOBE_BINS : 0;
+        size_t hi = (center + LOBE_BINS < half) ? center + LOBE_BINS : half;
+        for (size_t k = lo; k <= hi; k++) {
+            if (owner[k] == 0) {
+                owner[k] = tag;
+                sum += power[k];
+            }
+        }
+        return sum;
+    };
+    auto binOf = [&](double f) {
+        // Fold the frequency into the first Nyquist zone.
+        double folded = std::fmod(f, (double)SAMPLE_RATE);
+        if (folded > SAMPLE_RATE / 2.0) {
+            folded = SAMPLE_RATE - folded;
+        }
+        return (size_t)std::lround(folded * (double)n / SAMPLE_RATE);
+    };
+
+    lobe(0, 1);
+    const size_t fundamentalBin = binOf(frequency);
+    const double signal = lobe(fundamentalBin, 2);
+    double harmonics = 0.0;
+    for (int h = 2; h <= NUM_HARMONICS; h++) {
+        harmonics += lobe(binOf(frequency * h), 3);
+    }
+    for (int k = 1; k <= NUM_TABLE_IMAGES; k++) {
+        // lobe() skips bins that are already owned, so an image is never counted twice.
+        harmonics += lobe(binOf(frequency * (double)(k * tableLength - 1)), 3);
+        harmonics += lobe(binOf(frequency * (double)(k * tableLength + 1)), 3);
+    }
+
+    double total = 0.0;
+    double peak = 0.0;
+    double spur = 0.0;
+    for (size_t k = 0; k <= half; k++) {
+        if (owner[k] == 1) {
+            continue;
+        }
+        total += power[k];
+        if (owner[k] == 2) {
+            peak = (power[k] > peak) ? power[k] : peak;
+        } else {
+            spur = (power[k] > spur) ? power[k] : spur;
+        }
+    }
+    const double noise = total - signal - harmonics;
+
+    return {
+        toDb(harmonics / signal),
+        toDb(peak / spur),
+        toDb(signal / noise),
+        toDb(signal / (noise + harmonics)),
+    };
+}
+
+/**
+ * @brief A sine table and the lookup path used by the waveform generator.
+ */
+template <typename T>
+class Table {
+public:
+    Table(LUTSize size, LookupMode mode)
+        : size_(size), mode_(mode), bits_(__builtin_ctz((unsigned)size)), lut_(size),
+          getIndex_(LUTHelper::getIndexFunction(size)), phaseGenerator_(SAMPLE_RATE) {
+        for (size_t i = 0; i < (size_t)size; i++) {
+            lut_[i] = (T)std::floor(LutType<T>::AMPLITUDE * std::sin(2.0 * M_PI * (double)i / (double)size)
+                                    + LutType<T>::OFFSET + 0.5);
+        }
+    }
+
+    void setFrequency(float frequency) {
+        phaseGenerator_.setFrequency(frequency);
+        phaseGenerator_.reset();
+    }
+
+    int32_t next() {
+        phaseGenerator_.updatePhase();
+        const uint32_t phase = phaseGenerator_.getPhase();
+        const int index = getIndex_(phase, PhaseGenerator::N_BITS);
+        if (mode_ == LookupMode::Truncate) {
+            return lut_[index];
+        }
+        // Linear interpolation with the 16 phase bits below the index.
+        const int32_t a = lut_[index];
+        const int32_t b = lut_[(index + 1) & (size_ - 1)];
+        const int32_t frac = (int32_t)((phase << bits_) >> 16);
+        return a + (int32_t)(((int64_t)(b - a) * frac) >> 16);
+    }
+
+    size_t bytes() const { return lut_.size() * sizeof(T); }
+
+private:
+    int size_;
+    LookupMode mode_;
+    int bits_;
+    std::vector<T> lut_;
+    LUTIndexFunction getIndex_;
+    PhaseGenerator phaseGenerator_;
+};
+
+template <typename T>
+void benchmark(LUTSize size, LookupMode mode, float frequency) {
+    Table<T> table(size, mode);
+
+    // The frequency actually generated, after quantization of the phase increment.
+    const uint32_t increment = (uint32_t)((double)frequency / SAMPLE_RATE * 4294967296.0);
+    const double actual = (double)increment * SAMPLE_RATE / 4294967296.0;
+
+    std::vector<double> lutCapture(FFT_SIZE);
+    std::vector<double> dacCapture(FFT_SIZE);
+    table.setFrequency(frequency);
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        int32_t v = table.next();
+        lutCapture[i] = (double)v;
+        dacCapture[i] = (double)LutType<T>::toDac(v);
+    }
+    const Quality lut = analyze(lutCapture, actual, (size_t)size);
+    const Quality dac = analyze(dacCapture, actual, (size_t)size);
+
+    // Time the lookup path alone, including the conversion to DAC codes.
+    table.setFrequency(frequency);
+    volatile uint8_t sink = 0;
+    uint8_t acc = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TIMED_SAMPLES; i++) {
+        acc ^= LutType<T>::toDac(table.next());
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = acc;
+    (void)sink;
+    const double ns = std::chrono::duration<double, std::nano>(end - begin).count() / TIMED_SAMPLES;
+
+    printf("{\"lut_size\":%d,\"type\":\"%s\",\"mode\":\"%s\",\"frequency_hz\":%.3f,"
+           "\"table_bytes\":%u,\"ns_per_sample\":%.2f,"
+           "\"table\":{\"thd_dbc\":%.2f,\"sfdr_dbc\":%.2f,\"snr_db\":%.2f,\"sinad_db\":%.2f},"
+           "\"dac\":{\"thd_dbc\":%.2f,\"sfdr_dbc\":%.2f,\"snr_db\":%.2f,\"sinad_db\":%.2f}}\n",
+           (int)size, LutType<T>::NAME, mode == LookupMode::Truncate ? "truncate" : "interpolate", actual,
+           (unsigned)table.bytes(), ns,
+           lut.thd_dbc, lut.sfdr_dbc, lut.snr_db, lut.sinad_db,
+           dac.thd_dbc, dac.sfdr_dbc, dac.snr_db, dac.sinad_db);
+    fflush(stdout);
+}
+
+/**
+ * @brief Measures the images left by `LinearUpsampler`, as used by `Decimated`.
+ *
+ * A 16-bit sine is computed at `SAMPLE_RATE / Factor` and interpolated to `SAMPLE_RATE`.
+ * The image rejection is the distance from the fundamental to the largest image at
+ * `k * SAMPLE_RATE / Factor +- frequency`.
+ */
+template <size_t Factor>
+void benchmarkUpsampler(float frequency) {
+    const double reducedRate = (double)SAMPLE_RATE / Factor;
+    if (frequency >= reducedRate / 2.0) {
+        return;
+    }
+
+    LinearUpsampler<uint16_t, Factor> upsampler;
+    size_t reducedIndex = 0;
+    auto reducedSample = [&]() {
+        const double v = std::sin(2.0 * M_PI * frequency * (double)reducedIndex++ / reducedRate);
+        return (uint16_t)std::floor(32767.5 * v + 32767.5 + 0.5);
+    };
+
+    std::vector<double> capture(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        if (i % Factor == 0) {
+            upsampler.push(reducedSample());
+        }
+        capture[i] = (double)upsampler.next();
+    }
+
+    double mean = 0.0;
+    for (double v : capture) {
+        mean += v;
+    }
+    mean /= (double)FFT_SIZE;
+    std::vector<std::complex<double>> spectrum(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        spectrum[i] = (capture[i] - mean) * blackmanHarris(i, FFT_SIZE);
+    }
+    fft(spectrum);
+
+    auto lobe = [&](double f) {
+        const size_t center = (size_t)std::lround(f * (double)FFT_SIZE / SAMPLE_RATE);
+        double sum = 0.0;
+        for (size_t k = (center > LOBE_BINS) ? center - LOBE_BINS : 0; k <= center + LOBE_BINS && k <= FFT_SIZE / 2; k++) {
+            sum += std::norm(spectrum[k]);
+        }
+        return sum;
+    };
+    const double signal = lobe(frequency);
+    double image = 0.0;
+    for (size_t k = 1; k * reducedRate - frequency < SAMPLE_RATE / 2.0; k++) {
+        for (double f : { k * reducedRate - frequency, k * reducedRate + frequency }) {
+            if (f < SAMPLE_RATE / 2.0) {
+                const double p = lobe(f);
+                image = (p > image) ? p : image;
+            }
+        }
+    }
+
+    // Time the interpolation alone.
+    volatile uint16_t sink = 0;
+    uint16_t acc = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TIMED_SAMPLES; i += Factor) {
+        upsampler.push((uint16_t)i);
+        for (size_t j = 0; j < Factor; j++) {
+            acc ^= upsampler.next();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = acc;
+    (void)sink;
+    const double ns = std::chrono::duration<double, std::nano>(end - begin).count() / TIMED_SAMPLES;
+
+    printf("{\"upsampler\":\"linear\",\"factor\":%u,\"reduced_rate\":%.1f,\"frequency_hz\":%.3f,"
+           "\"image_rejection_db\":%.2f,\"ns_per_sample\":%.2f}\n",
+           (unsigned)Factor, reducedRate, (double)frequency, toDb(signal / image), ns);
+    fflush(stdout);
+}
+
+template <size_t... Factors>
+void sweepUpsampler(std::index_sequence<Factors...>) {
+    for (float frequency : UPSAMPLER_FREQUENCIES) {
+        (benchmarkUpsampler<Factors>(frequency), ...);
+    }
+}
+
+enum class IndexScheme { FunctionPointer, Template, MultiplyHigh, TemplateBlock };
+
+const char* toString(IndexScheme scheme) {
+    switch (scheme) {
+        case IndexScheme::FunctionPointer: return "function_pointer";
+        case IndexScheme::Template: return "template";
+        case IndexScheme::MultiplyHigh: return "multiply_high";
+        default: return "template_block";
+    }
+}
+
+/**
+ * @brief Times phase update, index computation and lookup of an int16 table of `Size` entries.
+ *
+ * Compares the `LUTHelper::getIndexFunction()` pointers, which only exist for the
+ * predefined power-of-two sizes, with the inline `LUTIndex<Size>` and the runtime
+ * `LUTIndexMapper`, per sample and in blocks of 32 samples as in `Pipeline`.
+ */
+template <size_t Size>
+void benchmarkIndex(IndexScheme scheme) {
+    constexpr size_t BLOCK = 32;
+    LUTIndexFunction getIndex = nullptr;
+    if (scheme == IndexScheme::FunctionPointer
+        && !LUTHelper::tryGetIndexFunction((LUTSize)Size, getIndex)) {
+        return;
+    }
+    std::vector<int16_t> lut(Size);
+    for (size_t i = 0; i < Size; i++) {
+        lut[i] = (int16_t)std::lround(32767.0 * std::sin(2.0 * M_PI * (double)i / (double)Size));
+    }
+    const LUTIndexMapper mapper((uint32_t)Size);
+    PhaseGenerator phaseGenerator(SAMPLE_RATE);
+    phaseGenerator.setFrequency(10000.0f);
+
+    volatile int32_t sink = 0;
+    int32_t acc = 0;
+    auto begin = std::chrono::steady_clock::now();
+    if (scheme == IndexScheme::TemplateBlock) {
+        uint32_t phases[BLOCK];
+        uint32_t indices[BLOCK];
+        for (size_t i = 0; i < TIMED_SAMPLES; i += BLOCK) {
+            phaseGenerator.fillPhases(phases, BLOCK);
+            LUTIndex<Size>::fill(phases, indices, BLOCK);
+            for (size_t j = 0; j < BLOCK; j++) {
+                acc += lut[indices[j]];
+            }
+        }
+    } else {
+        for (size_t i = 0; i < TIMED_SAMPLES; i++) {
+            const uint32_t phase = phaseGenerator.nextPhase();
+            switch (scheme) {
+                case IndexScheme::FunctionPointer:
+                    acc += lut[getIndex(phase, PhaseGenerator::N_BITS)];
+                    break;
+                case IndexScheme::Template:
+                    acc += lut[LUTIndex<Size>::index(phase)];
+                    break;
+                default:
+                    acc += lut[mapper.index(phase)];
+                    break;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = acc;
+    (void)sink;
+    const double ns = std::chrono::duration<double, std::nano>(end - begin).count() / TIMED_SAMPLES;
+
+    printf("{\"index\":\"%s\",\"lut_size\":%u,\"power_of_two\":%s,\"ns_per_sample\":%.2f}\n",
+           toString(scheme), (unsigned)Size, LUTIndex<Size>::POWER_OF_TWO ? "true" : "false", ns);
+    fflush(stdout);
+}
+
+template <size_t... Sizes>
+void sweepIndex(std::index_sequence<Sizes...>) {
+    for (IndexScheme scheme : { IndexScheme::FunctionPointer, IndexScheme::Template,
+                                IndexScheme::MultiplyHigh, IndexScheme::TemplateBlock }) {
+        (benchmarkIndex<Sizes>(scheme), ...);
+    }
+}
+
+template <typename T>
+void sweep() {
+    for (LUTSize size : LUT_SIZES) {
+        for (LookupMode mode : { LookupMode::Truncate, LookupMode::Interpolate }) {
+            for (float frequency : FREQUENCIES) {
+                benchmark<T>(size, mode, frequency);
+            }
+        }
+    }
+}
+
+void runBenchmark() {
+    sweep<int16_t>();
+    sweep<uint16_t>();
+    sweep<uint8_t>();
+    sweepUpsampler(std::index_sequence<2, 4, 8, 16, 32, 64>{});
+    // Powers of two, then exact-period lengths such as 1 kHz at 1 MSa/s.
+    sweepIndex(std::index_sequence<256, 2048, 4096, 65536, 1000, 3000, 48000>{});
+}
+
+} // namespace
+
+#ifdef ESP_PLATFORM
+extern "C" {
+    void app_main(void)
+    {
+        runBenchmark();
+    }
+}
+#else
+int main() {
+    runBenchmark();
+    return 0;
+}
+#endif
@@ -0,0 +1,44 @@
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "ESP32Waveu.h"
+
+using namespace tinyalg::waveu;
+
+static const char* TAG = "UserWaveConfig";
+
+// A 1 kHz sine carrier, tremolo by a 4 Hz triangle at half depth,
+// faded in over 10 ms after start, quantized for the 8-bit DAC.
+using UserWaveConfig = Pipeline<
+    Oscillator<LUT<Sine, LUT_256>>,
+    Modulator<LUT<Triangle, LUT_64>, 16384>,
+    Envelope<10000, 10000>,
+    Quantize8>;
+
+extern "C" {
+    void app_main(void)
+    {
+        // Initialize the waveform generator with the pipeline.
+        ESP32Waveu<UserWaveConfig> waveu;
+
+        // Set the rate of the tremolo directly on the stage.
+        waveu.chan.stage<1>().setFrequency(4.0f);
+
+        // Set the carrier frequency through the arguments understood by Oscillator.
+        OscillatorArgs waveArgs(1000.0f);
+
+        // Configure the waveform generator with the specified arguments, then start
+        // the waveform generation process. The Result API works without exceptions.
+        Result result = waveu.tryConfigure(waveArgs);
+        if (result) {
+            result = waveu.tryStart();
+        }
+        if (!result) {
+            ESP_LOGE(TAG, "Failed to start: %s", result.toString());
+        }
+
+        // Prevent app_main() from exiting, keeping local variables in memory.
+        vTaskDelay(portMAX_DELAY);
+    }
+}
@@ -76,15 +76,17 @@ extern "C" {
         // Define the waveform arguments, which is empty.
         UserWaveArgs waveArgs;
 
-        try {
-            // Configure the waveform generator with the specified arguments.
-            waveu.configure(waveArgs);
+        // Configure the waveform generator with the specified arguments.
+        tinyalg::waveu::Result result = waveu.tryConfigure(waveArgs);
 
-            // Start the waveform generation process.
-            waveu.start();
-
-        } catch (const tinyalg::waveu::InvalidStateTransitionException& e) {
-            ESP_LOGE(TAG, "Exception: %s\n", e.what());
+        // Start the waveform generation process.
+        if (result) {
+            result = waveu.tryStart();
+        }
+        if (result == tinyalg::waveu::ErrorCode::InvalidState) {
+            ESP_LOGE(TAG, "Invalid state transition");
+        } else if (!result) {
+            ESP_LOGE(TAG, "Failed to start: %s", result.toString());
         }
 
         // Prevent app_main() from exiting, keeping local variables in memory.
@@ -11,11 +11,12 @@ using tinyalg::waveu::LUTHelper;
 using tinyalg::waveu::LUTSize;
 using tinyalg::waveu::lut_type_t;
 using tinyalg::waveu::LUT_256;
+using tinyalg::waveu::ProfileStage;
 
 static const char* TAG = "UserWaveConfig";
 
 // Derived class for user wave arguments
-class UserWaveArgs : public tinyalg::waveu::WaveConfigArgs {
+class UserWaveArgs : public tinyalg::waveu::TypedWaveConfigArgs<UserWaveArgs> {
 public:
     float frequency;
 
@@ -65,8 +66,11 @@ public:
     }
 
     void configure(const tinyalg::waveu::WaveConfigArgs& args) override {
-        const auto& waveArgs = dynamic_cast<const UserWaveArgs&>(args); // Safe because caller ensures type
-        double freq = waveArgs.frequency;
+        const auto* waveArgs = args.as<UserWaveArgs>(); // Type check without RTTI
+        if (waveArgs == nullptr) {
+            return;
+        }
+        double freq = waveArgs->frequency;
 
         // Sets the frequency and calculates the phase increment.
         setPhaseGeneratorFrequency(freq);
@@ -86,10 +90,18 @@ public:
         uint32_t currentPhase = _phaseGenerator->getPhase();
 
         // Step 3: Map the phase value to an appropriate index in the lookup table.
-        int lutIndex = _getIndex(currentPhase, PhaseGenerator::N_BITS);
+        int lutIndex;
+        {
+            WAVEU_PROFILE_SAMPLED_SCOPE(ProfileStage::IndexCompute);
+            lutIndex = _getIndex(currentPhase, PhaseGenerator::N_BITS);
+        }
 
         // Step 4: Fetch the corresponding voltage value (0-255) from the lookup table using the macro.
-        lut_type_t digi_val = GET_LUT_VALUE(_lut, lutIndex);
+        lut_type_t digi_val;
+        {
+            WAVEU_PROFILE_SAMPLED_SCOPE(ProfileStage::LutFetch);
+            digi_val = GET_LUT_VALUE(_lut, lutIndex);
+        }
 
         // Return the voltage value for the sample.
         return (uint8_t)digi_val;
@@ -145,23 +157,52 @@ extern "C" {
         // within a 16 ms timer cycle, used for timing alignment.
         UserWaveArgs waveArgs(312.5f);
 
-        try {
-            // Configure the generator with arguments.
-            waveu.configure(waveArgs);
+        // Configure the generator with arguments.
+        tinyalg::waveu::Result result = waveu.tryConfigure(waveArgs);
+
+        if (result) {
+#ifdef CONFIG_WAVEU_TRACE
+            // Record the timeline of the pipeline, dropping the events of the previous run.
+            tinyalg::waveu::Tracer::clear();
+            tinyalg::waveu::Tracer::start();
+#endif
 
             // Start waveform generation.
-            waveu.start();
+            result = waveu.tryStart();
+        }
+
+        if (result) {
+            ESP_LOGI(TAG, "startTimer() took %uus",
+                     (unsigned)tinyalg::waveu::ESP32Config::lastStartLatencyUs.load());
 
             // Keep the current frequency active for 20 seconds.
             vTaskDelay(pdMS_TO_TICKS(20000));
 
             // Stop waveform generation process.
-            waveu.stop();
+            result = waveu.tryStop();
+        }
+
+        if (result) {
+            ESP_LOGI(TAG, "stopTimer() took %uus",
+                     (unsigned)tinyalg::waveu::ESP32Config::lastStopLatencyUs.load());
+
+            // Print the per-stage cycle statistics (requires CONFIG_WAVEU_PROFILER).
+            WAVEU_PROFILE_DUMP();
+
+#ifdef CONFIG_WAVEU_TRACE
+            // Print the last periods as Chrome trace JSON for Perfetto.
+            tinyalg::waveu::Tracer::stop();
+            tinyalg::waveu::Tracer::exportChromeTrace(stdout);
+#endif
 
             // Reset the generator for another start.
-            waveu.reset();
-        } catch (const tinyalg::waveu::InvalidStateTransitionException& e) {
-            ESP_LOGE(TAG, "Exception: %s\n", e.what());
+            result = waveu.tryReset();
+        }
+
+        if (result == tinyalg::waveu::ErrorCode::InvalidState) {
+            ESP_LOGE(TAG, "Invalid state transition");
+        } else if (!result) {
+            ESP_LOGE(TAG, "Waveform generation failed: %s", result.toString());
         }
         
         // Log completion of the example.
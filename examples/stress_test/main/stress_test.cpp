@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "HostWaveu.h"
+#include "Queues.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+const char* TAG = "StressTest";
+
+constexpr uint32_t SAMPLE_RATE = 48000;     // Sa/s
+constexpr uint32_t TIMER_PERIOD = 8000;     // us
+constexpr uint32_t SCENARIO_MS = 5000;
+/// Periods without any output while running before the watchdog declares a stall.
+constexpr uint32_t WATCHDOG_PERIODS = 25;
+/// Faulty buffers tolerated in a scenario that must be clean, in percent of all buffers.
+/// The tasks of the POSIX port are host threads, which the host may delay at any time.
+constexpr uint32_t CLEAN_TOLERANCE_PERCENT = 2;
+
+constexpr UBaseType_t TIMER_TASK_PRIORITY = configMAX_PRIORITIES - 1;
+constexpr UBaseType_t WATCHDOG_TASK_PRIORITY = configMAX_PRIORITIES - 2;
+/// Above the producer, below the consumer.
+constexpr UBaseType_t LOAD_TASK_PRIORITY = CONFIG_WAVEU_PRODUCER_TASK_PRIORITY + 1;
+
+/**
+ * @brief The faults injected while a scenario runs. Each delay is drawn uniformly
+ *        from [0, max] for every timer tick, rendered buffer or written buffer.
+ */
+struct Faults {
+    std::atomic<uint32_t> timerJitterUs{0};     // Delay of each timer tick
+    std::atomic<uint32_t> renderJitterUs{0};    // Extra render time of each buffer
+    std::atomic<uint32_t> writeJitterUs{0};     // Extra DAC write time of each buffer
+    std::atomic<uint32_t> loadBusyUs{0};        // CPU time taken by the load task per burst
+    std::atomic<uint32_t> loadPeriodMs{0};      // Time between bursts; 0 disables the load
+};
+
+Faults faults;
+
+struct Scenario {
+    const char* name;
+    uint32_t timerJitterUs;
+    uint32_t renderJitterUs;
+    uint32_t writeJitterUs;
+    uint32_t loadBusyUs;
+    uint32_t loadPeriodMs;
+    OverloadPolicy policy;
+    bool mustBeClean;   // Fail on underruns, stale buffers or discontinuities beyond the tolerance
+};
+
+// The buffer period is 8 ms; render and write jitter beyond it must be absorbed by
+// the overload policy, and nothing may ever stall.
+constexpr Scenario SCENARIOS[] = {
+    {"nominal",               0,    0,    0,    0,    0,  OverloadPolicy::RepeatLast, true},
+    {"timer_jitter",          3000, 0,    0,    0,    0,  OverloadPolicy::RepeatLast, true},
+    {"slow_producer",         0,    9000, 0,    0,    0,  OverloadPolicy::RepeatLast, false},
+    {"slow_consumer",         0,    0,    9000, 0,    0,  OverloadPolicy::RepeatLast, false},
+    {"competing_load",        0,    0,    0,    6000, 10, OverloadPolicy::RepeatLast, false},
+    {"worst_case",            2000, 5000, 2000, 4000, 20, OverloadPolicy::RepeatLast, false},
+    {"worst_case_skip_ahead", 2000, 5000, 2000, 4000, 20, OverloadPolicy::SkipAhead,  false},
+};
+
+uint32_t nextRandom(uint32_t& state) {
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+uint32_t randomUpTo(uint32_t& state, uint32_t max) {
+    return (max == 0) ? 0 : nextRandom(state) % (max + 1);
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Occupies the calling task for `us` microseconds without yielding, like a render
+ *        or a DMA write would. Tasks of higher priority still preempt it.
+ */
+void busyWaitUs(uint32_t us) {
+    const int64_t end = nowUs() + us;
+    while (nowUs() < end) {
+    }
+}
+
+/**
+ * @brief A waveform whose samples count up by one, so that the sink can tell fresh,
+ *        repeated and skipped buffers apart. Injects the render jitter.
+ */
+class CounterWave : public BasicWaveConfigInterface<uint16_t> {
+public:
+    using sample_type = uint16_t;
+
+    void initialize(uint32_t) override {}
+
+    void configure(const WaveConfigArgs&) override {}
+
+    void prepareCycle(double) override {
+        busyWaitUs(randomUpTo(random_, faults.renderJitterUs.load(std::memory_order_relaxed)));
+    }
+
+    uint16_t nextSample() override { return counter_++; }
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    uint16_t nextSampleB() override { return (uint16_t)(counter_ - 1); }
+#endif
+
+    /// Enables `OverloadPolicy::SkipAhead`.
+    void advance(uint64_t samples) { counter_ += (uint16_t)samples; }
+
+    void reset() override { counter_ = 0; }
+
+private:
+    uint16_t counter_ = 0;
+    uint32_t random_ = 0x12345678;
+};
+
+using Board = HostConfig<uint16_t, SAMPLE_RATE, TIMER_PERIOD>;
+
+/**
+ * @brief `HostConfig` paced by a dedicated high-priority task instead of a FreeRTOS
+ *        software timer, so that every tick can be delayed by the timer jitter.
+ */
+class StressBoard : public Board {
+public:
+    void prepareTimer() override {
+        xTaskCreate(timerTask, "stressTimerTask", 4096, this, TIMER_TASK_PRIORITY, nullptr);
+        xTaskCreate(consumerTask, "waveformDataOutputTask", CONFIG_WAVEU_CONSUMER_TASK_STACK_SIZE, this,
+                    CONFIG_WAVEU_CONSUMER_TASK_PRIORITY, nullptr);
+    }
+
+    void startTimer() override {
+        BufferScheduler::startOutput();
+        running_.store(true, std::memory_order_release);
+    }
+
+    void stopTimer() override {
+        running_.store(false, std::memory_order_release);
+        BufferScheduler::stopOutput();
+    }
+
+    void cleanupTimer() override {
+        exit_.store(true, std::memory_order_release);
+    }
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+private:
+    static void timerTask(void* args) {
+        StressBoard* board = static_cast<StressBoard*>(args);
+        uint32_t random = 0x9e3779b9;
+        TickType_t lastWake = xTaskGetTickCount();
+        while (!board->exit_.load(std::memory_order_acquire)) {
+            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TIMER_PERIOD / 1000));
+            if (board->running()) {
+                busyWaitUs(randomUpTo(random, faults.timerJitterUs.load(std::memory_order_relaxed)));
+                board->tick();
+            }
+        }
+        vTaskDelete(NULL);
+    }
+
+    static void consumerTask(void* args) {
+        StressBoard* board = static_cast<StressBoard*>(args);
+        while (board->consumeBuffer(portMAX_DELAY)) {
+        }
+        vTaskDelete(NULL);
+    }
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> exit_{false};
+};
+
+/**
+ * @brief Checks the output stream and the queues. Written by the sink and the watchdog.
+ */
+struct Monitor {
+    std::atomic<uint32_t> buffers{0};
+    std::atomic<uint32_t> staleBuffers{0};      // Buffers replaying samples already output
+    std::atomic<uint32_t> discontinuities{0};   // Buffers skipping ahead of the previous one
+    std::atomic<uint32_t> corruptBuffers{0};    // Buffers not counting up inside
+    std::atomic<uint32_t> outputGaps{0};        // Buffers output more than 1.5 periods after the previous one
+    std::atomic<uint32_t> maxGapUs{0};
+    std::atomic<uint32_t> maxGenerationDepth{0};
+    std::atomic<uint32_t> maxOutputDepth{0};
+    std::atomic<uint32_t> outputFullPeriods{0}; // Periods the consumer found no room left in dataOutputQueue
+
+    // Sink state, only touched by the consumer task.
+    bool primed = false;
+    uint16_t expected = 0;
+    int64_t lastOutputUs = 0;
+    uint32_t random = 0x2545f491;
+
+    void restart() {
+        buffers = 0;
+        staleBuffers = 0;
+        discontinuities = 0;
+        corruptBuffers = 0;
+        outputGaps = 0;
+        maxGapUs = 0;
+        maxGenerationDepth = 0;
+        maxOutputDepth = 0;
+        outputFullPeriods = 0;
+        primed = false;
+    }
+};
+
+Monitor monitor;
+
+template <typename T>
+void updateMax(std::atomic<T>& max, T value) {
+    T current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief The simulated DAC: checks continuity and timing, then takes the write jitter.
+ */
+void sink(const uint16_t* samples, size_t len, void* context) {
+    Monitor& m = *static_cast<Monitor*>(context);
+    const int64_t now = nowUs();
+    const uint16_t first = samples[0];
+
+    if (m.primed) {
+        // The counter wraps around, so compare the distance instead of the values.
+        const int16_t distance = (int16_t)(uint16_t)(first - m.expected);
+        if (distance < 0) {
+            m.staleBuffers.fetch_add(1, std::memory_order_relaxed);
+        } else if (distance > 0) {
+            m.discontinuities.fetch_add(1, std::memory_order_relaxed);
+        }
+        const int64_t gap = now - m.lastOutputUs;
+        updateMax(m.maxGapUs, (uint32_t)gap);
+        if (gap > (int64_t)TIMER_PERIOD * 3 / 2) {
+            m.outputGaps.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    for (size_t i = Board::CHANNELS; i < len; i += Board::CHANNELS) {
+        if (samples[i] != (uint16_t)(samples[i - Board::CHANNELS] + 1)) {
+            m.corruptBuffers.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    m.primed = true;
+    m.expected = (uint16_t)(samples[len - Board::CHANNELS] + 1);
+    m.lastOutputUs = now;
+    m.buffers.fetch_add(1, std::memory_order_relaxed);
+
+    busyWaitUs(randomUpTo(m.random, faults.writeJitterUs.load(std::memory_order_relaxed)));
+}
+
+using StressWaveu = Waveu<StressBoard, CounterWave>;
+
+StressWaveu* waveu = nullptr;
+
+void printQueues() {
+    ESP_LOGE(TAG, "dataGenerationQueue: %u waiting, %u free; dataOutputQueue: %u waiting, %u free",
+             (unsigned)uxQueueMessagesWaiting(dataGenerationQueue), (unsigned)uxQueueSpacesAvailable(dataGenerationQueue),
+             (unsigned)uxQueueMessagesWaiting(dataOutputQueue), (unsigned)uxQueueSpacesAvailable(dataOutputQueue));
+}
+
+/**
+ * @brief Samples the queue depths every period and aborts the run if the output or
+ *        the producer stops making progress.
+ */
+void watchdogTask(void*) {
+    uint32_t lastBuffers = 0;
+    uint64_t lastSampleIndex = 0;
+    uint32_t idleBuffers = 0;
+    uint32_t idleProducer = 0;
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TIMER_PERIOD / 1000));
+
+        const UBaseType_t generation = uxQueueMessagesWaiting(dataGenerationQueue);
+        const UBaseType_t output = uxQueueMessagesWaiting(dataOutputQueue);
+        updateMax(monitor.maxGenerationDepth, (uint32_t)generation);
+        updateMax(monitor.maxOutputDepth, (uint32_t)output);
+        // dataGenerationQueue holds a single request, so only dataOutputQueue can saturate.
+        if (uxQueueSpacesAvailable(dataOutputQueue) == 0) {
+            monitor.outputFullPeriods.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!waveu->brd.running()) {
+            idleBuffers = 0;
+            idleProducer = 0;
+            lastBuffers = monitor.buffers;
+            lastSampleIndex = waveu->getSampleIndex();
+            continue;
+        }
+        const uint32_t buffers = monitor.buffers;
+        const uint64_t sampleIndex = waveu->getSampleIndex();
+        idleBuffers = (buffers == lastBuffers) ? idleBuffers + 1 : 0;
+        idleProducer = (sampleIndex == lastSampleIndex) ? idleProducer + 1 : 0;
+        lastBuffers = buffers;
+        lastSampleIndex = sampleIndex;
+        if (idleBuffers >= WATCHDOG_PERIODS || idleProducer >= WATCHDOG_PERIODS) {
+            ESP_LOGE(TAG, "Deadlock: no %s for %" PRIu32 " periods (state %s, sample index %" PRIu64 ")",
+                     (idleBuffers >= WATCHDOG_PERIODS) ? "output" : "rendering", WATCHDOG_PERIODS,
+                     StressWaveu::toString(waveu->getState()), sampleIndex);
+            printQueues();
+            printf("{\"result\":\"deadlock\"}\n");
+            fflush(stdout);
+            exit(2);
+        }
+    }
+}
+
+/**
+ * @brief Competes for the CPU above the producer: busy for `loadBusyUs` every `loadPeriodMs`.
+ */
+void loadTask(void*) {
+    for (;;) {
+        const uint32_t period = faults.loadPeriodMs.load(std::memory_order_relaxed);
+        if (period == 0) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        busyWaitUs(faults.loadBusyUs.load(std::memory_order_relaxed));
+        vTaskDelay(pdMS_TO_TICKS(period));
+    }
+}
+
+#ifdef CONFIG_WAVEU_TRACE
+/**
+ * @brief Writes the last periods of a scenario to `trace_<scenario>.json` for Perfetto.
+ */
+void exportTrace(const Scenario& scenario) {
+    Tracer::stop();
+    char path[64];
+    snprintf(path, sizeof(path), "trace_%s.json", scenario.name);
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return;
+    }
+    Tracer::exportChromeTrace(file);
+    fclose(file);
+}
+#endif
+
+/**
+ * @brief Runs one scenario and prints its report as a JSON line.
+ *
+ * @return false if the scenario must be clean and has too many faulty buffers.
+ */
+bool runScenario(const Scenario& scenario) {
+    faults.timerJitterUs = scenario.timerJitterUs;
+    faults.renderJitterUs = scenario.renderJitterUs;
+    faults.writeJitterUs = scenario.writeJitterUs;
+    faults.loadBusyUs = scenario.loadBusyUs;
+    faults.loadPeriodMs = scenario.loadPeriodMs;
+
+    // Every scenario starts from a fresh stream, so that the sink can check it from sample 0.
+    Result result = waveu->setOverloadPolicy(scenario.policy);
+    if (result && waveu->getState() == StressWaveu::State::Stopped) {
+        result = waveu->tryReset();
+    }
+    if (!result) {
+        ESP_LOGE(TAG, "%s: cannot prepare: %s", scenario.name, result.toString());
+        return false;
+    }
+    const OverloadStats before = waveu->getOverloadStats();
+    monitor.restart();
+#ifdef CONFIG_WAVEU_TRACE
+    Tracer::clear();
+    Tracer::start();
+#endif
+
+    result = waveu->tryStart();
+    if (!result) {
+        ESP_LOGE(TAG, "%s: cannot start: %s", scenario.name, result.toString());
+        return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SCENARIO_MS));
+    result = waveu->tryStop();
+    if (!result) {
+        ESP_LOGE(TAG, "%s: cannot stop: %s", scenario.name, result.toString());
+        return false;
+    }
+#ifdef CONFIG_WAVEU_TRACE
+    exportTrace(scenario);
+#endif
+
+    const OverloadStats after = waveu->getOverloadStats();
+    const uint32_t expected = SCENARIO_MS * 1000 / TIMER_PERIOD;
+    const uint32_t underruns = (after.lateBuffers - before.lateBuffers)
+                             + (after.repeatedBuffers - before.repeatedBuffers)
+                             + (after.fadedBuffers - before.fadedBuffers)
+                             + (after.skippedBuffers - before.skippedBuffers)
+                             + (after.fallbackBuffers - before.fallbackBuffers);
+    // Output gaps are reported but not judged: on a host they include the latency of the
+    // operating system scheduler, which the pipeline cannot absorb.
+    // A repeated buffer also reaches the sink as a stale one; count each fault once.
+    const uint32_t faulty = std::max(underruns, monitor.staleBuffers + monitor.discontinuities + monitor.corruptBuffers);
+    const bool clean = faulty == 0;
+    const bool pass = !scenario.mustBeClean || faulty * 100 <= monitor.buffers * CLEAN_TOLERANCE_PERCENT;
+
+    printf("{\"scenario\":\"%s\",\"timer_jitter_us\":%" PRIu32 ",\"render_jitter_us\":%" PRIu32
+           ",\"write_jitter_us\":%" PRIu32 ",\"load_busy_us\":%" PRIu32 ",\"load_period_ms\":%" PRIu32 ","
+           "\"buffers\":%" PRIu32 ",\"expected_buffers\":%" PRIu32 ","
+           "\"underruns\":{\"late\":%" PRIu32 ",\"repeated\":%" PRIu32 ",\"faded\":%" PRIu32
+           ",\"skipped\":%" PRIu32 ",\"fallback\":%" PRIu32 ",\"output_gaps\":%" PRIu32 ",\"max_gap_us\":%" PRIu32 "},"
+           "\"stale_buffers\":%" PRIu32 ",\"discontinuities\":%" PRIu32 ",\"corrupt_buffers\":%" PRIu32 ","
+           "\"queues\":{\"dropped_requests\":%" PRIu32 ",\"dropped_outputs\":%" PRIu32
+           ",\"max_generation_depth\":%" PRIu32 ",\"max_output_depth\":%" PRIu32
+           ",\"output_full_periods\":%" PRIu32 "},"
+           "\"result\":\"%s\"}\n",
+           scenario.name, scenario.timerJitterUs, scenario.renderJitterUs, scenario.writeJitterUs,
+           scenario.loadBusyUs, scenario.loadPeriodMs,
+           monitor.buffers.load(), expected,
+           after.lateBuffers - before.lateBuffers, after.repeatedBuffers - before.repeatedBuffers,
+           after.fadedBuffers - before.fadedBuffers, after.skippedBuffers - before.skippedBuffers,
+           after.fallbackBuffers - before.fallbackBuffers, monitor.outputGaps.load(), monitor.maxGapUs.load(),
+           monitor.staleBuffers.load(), monitor.discontinuities.load(), monitor.corruptBuffers.load(),
+           after.droppedRequests - before.droppedRequests, after.droppedOutputs - before.droppedOutputs,
+           monitor.maxGenerationDepth.load(), monitor.maxOutputDepth.load(),
+           monitor.outputFullPeriods.load(),
+           pass ? (clean ? "clean" : "degraded") : "fail");
+    fflush(stdout);
+    return pass;
+}
+
+} // namespace
+
+extern "C" {
+    void app_main(void)
+    {
+        // Never destroyed: exit() ends the process while the tasks still run.
+        waveu = new StressWaveu();
+        waveu->brd.setSink(sink, &monitor);
+
+        xTaskCreate(watchdogTask, "stressWatchdogTask", 4096, nullptr, WATCHDOG_TASK_PRIORITY, nullptr);
+        xTaskCreate(loadTask, "stressLoadTask", 4096, nullptr, LOAD_TASK_PRIORITY, nullptr);
+
+        WaveConfigArgs args;
+        Result result = waveu->tryConfigure(args);
+        if (!result) {
+            ESP_LOGE(TAG, "Failed to configure: %s", result.toString());
+            exit(1);
+        }
+
+        bool pass = true;
+        for (const Scenario& scenario : SCENARIOS) {
+            pass = runScenario(scenario) && pass;
+        }
+        exit(pass ? 0 : 1);
+    }
+}
@@ -15,7 +15,7 @@ using tinyalg::waveu::LUT_256;
 static const char* TAG = "UserWaveConfig";
 
 // Derived class for user wave arguments
-class UserWaveArgs : public tinyalg::waveu::WaveConfigArgs {
+class UserWaveArgs : public tinyalg::waveu::TypedWaveConfigArgs<UserWaveArgs> {
 public:
     float frequency;
     float amplitude;
@@ -88,17 +88,23 @@ public:
         initializePhaseGenerator(sampleRate);
 
         // Retrieves a function to calculate the LUT index from a phase.
-        _getIndex = LUTHelper::getIndexFunction(_lutSize);
+        tinyalg::waveu::Result result = LUTHelper::tryGetIndexFunction(_lutSize, _getIndex);
+        if (!result) {
+            ESP_LOGE(TAG, "Unsupported LUT size: %s", result.toString());
+        }
     }
 
     void configure(const tinyalg::waveu::WaveConfigArgs& args) override {
-        const auto& waveArgs = dynamic_cast<const UserWaveArgs&>(args); // Safe because caller ensures type
+        const auto* waveArgs = args.as<UserWaveArgs>(); // Type check without RTTI
+        if (waveArgs == nullptr) {
+            return;
+        }
 
         // Sets the desired frequency and calculates the phase increment.
-        setPhaseGeneratorFrequency(waveArgs.frequency);
+        setPhaseGeneratorFrequency(waveArgs->frequency);
 
         // Validates and adjusts amplitude and offset for the 8-bit DAC.
-        auto [adjustedAmplitude, adjustedOffset] = LUTHelper::adjustAmplitudeAndOffset(waveArgs.amplitude, waveArgs.offset);
+        auto [adjustedAmplitude, adjustedOffset] = LUTHelper::adjustAmplitudeAndOffset(waveArgs->amplitude, waveArgs->offset);
 
         // Fills the values to the LUT using the supplied function.
         populateLUTs(adjustedAmplitude, adjustedOffset);
@@ -153,15 +159,17 @@ extern "C" {
         float offset = 127.5f;
         UserWaveArgs waveArgs(frequency, amplitude, offset);
 
-        try {
-            // Configure the waveform generator with the specified arguments.
-            waveu.configure(waveArgs);
+        // Configure the waveform generator with the specified arguments.
+        tinyalg::waveu::Result result = waveu.tryConfigure(waveArgs);
 
-            // Start the waveform generation process.
-            waveu.start();
-
-        } catch (const tinyalg::waveu::InvalidStateTransitionException& e) {
-            ESP_LOGE(TAG, "Exception: %s\n", e.what());
+        // Start the waveform generation process.
+        if (result) {
+            result = waveu.tryStart();
+        }
+        if (result == tinyalg::waveu::ErrorCode::InvalidState) {
+            ESP_LOGE(TAG, "Invalid state transition");
+        } else if (!result) {
+            ESP_LOGE(TAG, "Failed to start: %s", result.toString());
         }
 
         // Prevent app_main() from exiting, keeping local variables in memory.
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "DataTypes.h"
+
 namespace tinyalg::waveu {
 
 /**
@@ -8,13 +14,24 @@ namespace tinyalg::waveu {
  * This interface defines the methods required to configure and manage hardware components 
  * such as DACs, GPIOs, and timers. It serves as a contract for concrete implementations 
  * tailored to specific hardware platforms.
+ * 
+ * The sample type is carried through `Waveu`, the ping/pong buffers and the
+ * WaveConfig render API, so converters wider than 8 bits are fed at their native width.
+ * 
+ * @tparam Sample The type of one DAC code, e.g. `uint8_t` or `uint16_t`.
  */
-class BoardConfigInterface {
+template <typename Sample>
+class BasicBoardConfigInterface {
 public:
+    /**
+     * @brief The type of one sample in the ping/pong buffers.
+     */
+    using sample_type = Sample;
+
     /**
      * @brief Virtual destructor for proper cleanup of derived classes.
      */
-    virtual ~BoardConfigInterface() = default;
+    virtual ~BasicBoardConfigInterface() = default;
 
     /**
      * @brief Initialize the DAC (Digital-to-Analog Converter) for waveform output.
@@ -68,6 +85,65 @@ public:
      * generator, typically to a known initial state.
      */
     virtual void reset() = 0;
+
+    /**
+     * @brief Retrieves a monotonic time in microseconds.
+     * 
+     * `Waveu` converts the time between `stop()` and `start()` to a sample count for
+     * `RestartPolicy::PhaseContinuous`. The default implementation counts FreeRTOS ticks;
+     * boards with a finer clock override it.
+     * 
+     * @return The time since an arbitrary origin in microseconds.
+     */
+    virtual int64_t getTimeUs() {
+        return (int64_t)xTaskGetTickCount() * 1000000 / configTICK_RATE_HZ;
+    }
+
+    /**
+     * @brief Retrieves the size of the buffers the DAC driver allocates for DMA.
+     * 
+     * Reported by `Waveu::memoryFootprint()`. The default implementation reports none.
+     * 
+     * @return The size in bytes.
+     */
+    virtual size_t dmaBufferBytes() const {
+        return 0;
+    }
+
+    /**
+     * @brief Retrieves the size of the copy of the buffer kept for `startCyclic()`.
+     * 
+     * Reported by `Waveu::memoryFootprint()`. The default implementation reports none,
+     * as for boards whose driver copies the buffer into its DMA buffers.
+     * 
+     * @return The size in bytes.
+     */
+    virtual size_t cyclicBufferBytes() const {
+        return 0;
+    }
+
+    /**
+     * @brief Outputs a buffer repeatedly without involving the CPU.
+     * 
+     * Called while the timer is stopped. The buffer contents are copied, so the
+     * buffer can be reused once this method returns.
+     * 
+     * @param buffer The samples of an integer number of waveform periods.
+     * @param len The number of samples in the buffer, counting both channels in alternate mode.
+     */
+    virtual void startCyclic(const Sample* buffer, size_t len) = 0;
+
+    /**
+     * @brief Ends cyclic output and prepares the DAC for streaming again.
+     * 
+     * The ping buffer is output first when the timer is started next.
+     */
+    virtual void stopCyclic() = 0;
 };
 
+/**
+ * @brief The interface of boards with an 8-bit DAC such as the ESP32.
+ */
+using BoardConfigInterface = BasicBoardConfigInterface<data_buf_type_t>;
+
 }
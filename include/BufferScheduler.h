@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Counters of missed deadlines, see `Waveu::setOverloadPolicy()`.
+ */
+struct OverloadStats {
+    /// Buffers rendered in full but finished after their output period had begun.
+    uint32_t lateBuffers;
+    /// Overdue buffers replaced by a copy of the previous buffer (`OverloadPolicy::RepeatLast`).
+    uint32_t repeatedBuffers;
+    /// Overdue buffers replaced by a fade to midscale (`OverloadPolicy::FadeToMidscale`).
+    uint32_t fadedBuffers;
+    /// Overdue buffers skipped on the timeline (`OverloadPolicy::SkipAhead`).
+    uint32_t skippedBuffers;
+    /// Buffers rendered in the fallback mode (`OverloadPolicy::Fallback`).
+    uint32_t fallbackBuffers;
+    /// Render requests the timer could not queue because the producer was too far behind.
+    uint32_t droppedRequests;
+    /// Output requests the timer could not queue because the consumer was too far behind.
+    uint32_t droppedOutputs;
+    /// Parameter events dropped because `CONFIG_WAVEU_EVENT_QUEUE_LENGTH` events with earlier
+    /// sample indices were pending.
+    uint32_t droppedEvents;
+};
+
+/**
+ * @brief The per-period hand-over of ping/pong buffers shared by all board configurations.
+ *
+ * Every timer period the buffer rendered during the previous period is handed to the
+ * consumer through `dataOutputQueue`, and the other buffer is requested from the
+ * producer through `dataGenerationQueue`. A board calls `startOutput()` and `stopOutput()`
+ * from `startTimer()` and `stopTimer()`, and `tick()` from its timer callback.
+ */
+class BufferScheduler {
+public:
+    static const char* TAG;
+
+    /**
+     * @brief Clears a stop request and hands over the pre-rendered buffer right away.
+     *
+     * Called before the board's periodic timer is started. Does not block.
+     */
+    static void startOutput();
+
+    /**
+     * @brief Makes `tick()` return without handing over buffers.
+     *
+     * Waits for a tick that is already past the check, so no buffer is handed over or
+     * requested once it returns. Call it from a task other than the timer's.
+     */
+    static void stopOutput();
+
+    /**
+     * @brief The body of the board's timer callback.
+     *
+     * @param ticksToWait Maximum time to wait for space in the queues. Pass 0 from
+     *                    contexts that must not block, such as the FreeRTOS timer task.
+     */
+    static void tick(TickType_t ticksToWait);
+
+    /**
+     * @brief Makes the ping buffer the next one handed to the consumer.
+     *
+     * Called after a reset and after cyclic output, when the ping buffer is pre-rendered.
+     */
+    static void resetToPing();
+
+    /**
+     * @brief Hands the next buffer to the consumer and requests the other one from the producer.
+     *
+     * @param ticksToWait Maximum time to wait for space in the queues.
+     */
+    static void scheduleBuffers(TickType_t ticksToWait);
+
+    /**
+     * @brief Checks whether the buffer requested in timer period `period` is overdue.
+     *
+     * A buffer requested in one period is handed to the consumer at the start of the
+     * next one. Once that has happened, the consumer is already waiting for it.
+     *
+     * @param period The `period` of the render request.
+     */
+    static bool isOverdue(uint32_t period);
+
+    /**
+     * @brief Number of render requests dropped because `dataGenerationQueue` was full.
+     */
+    static uint32_t droppedRequests();
+
+    /**
+     * @brief Number of output requests dropped because `dataOutputQueue` was full.
+     */
+    static uint32_t droppedOutputs();
+};
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "driver/gpio.h"
+#endif
+
+#include "CycleCounter.h"
+#include "DataTypes.h"
+#include "WaveConfigInterface.h"
+#include "WaveConfigTraits.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Parameters of a burst.
+ *
+ * Use it as `Burst<WaveConfig>::settings_type`.
+ *
+ * @tparam WaveConfig The gated WaveConfig, which determines the sample type and midscale.
+ */
+template <typename WaveConfig>
+struct BurstSettings {
+    /// Number of waveform cycles emitted per burst.
+    uint32_t cycles = 1;
+    /// Frequency of the wrapped waveform in Hz, used to convert cycles to samples.
+    float frequency = 1000.0f;
+    /// DAC code output between bursts; midscale of the WaveConfig by default.
+    sample_type_of_t<WaveConfig> idleLevel = midscale_of_v<WaveConfig>;
+    /// Samples from the start of one burst to the start of the next; 0 for one-shot bursts.
+    uint32_t repeatIntervalSamples = 0;
+    /// Offset of the first burst sample from the start of the buffer following a trigger.
+    uint32_t triggerOffsetSamples = 0;
+};
+
+/**
+ * @brief Trigger statistics of a `Burst`.
+ *
+ * Each field is read atomically, but a snapshot taken while running may mix values of
+ * two consecutive triggers.
+ */
+struct BurstStats {
+    /// Number of bursts started by a trigger.
+    uint32_t triggers;
+    /// Number of triggers that arrived while a burst was still active and were ignored.
+    uint32_t ignoredTriggers;
+    /// Microseconds from the last `trigger()` call to the producer picking it up.
+    uint32_t lastPostToRenderUs;
+    /// Offset of the last triggered burst inside its buffer in samples.
+    uint32_t lastOffsetSamples;
+};
+
+/**
+ * @brief Gates a WaveConfig into bursts of N cycles separated by a constant idle level.
+ *
+ * `Burst<UserWaveConfig>` conforms to the same `BasicWaveConfigInterface` as `UserWaveConfig`
+ * and can be used wherever `UserWaveConfig` can. While idle, the output is filled with
+ * `idleLevel` at the native sample width.
+ * A burst begins at phase zero: the wrapped WaveConfig's `reset()` is called at the
+ * first sample of every burst, so it should be cheap.
+ *
+ * Triggers take effect at a defined sample position:
+ * - `trigger()` / `triggerFromISR()` / a GPIO edge: at `triggerOffsetSamples` into the
+ *   next buffer rendered by the producer.
+ * - `scheduleTrigger()`: at an exact absolute sample index. This is the simulated
+ *   trigger source for hardware-free testing.
+ *
+ * The trigger-to-output latency is `lastPostToRenderUs` plus `lastOffsetSamples`
+ * plus one buffer period, since a rendered buffer is output one timer period later.
+ *
+ * @tparam WaveConfig The WaveConfig to gate.
+ */
+template <typename WaveConfig>
+class Burst : public WaveConfig {
+public:
+    using sample_type = sample_type_of_t<WaveConfig>;
+    using settings_type = BurstSettings<WaveConfig>;
+
+    static_assert(std::is_base_of_v<BasicWaveConfigInterface<sample_type>, WaveConfig>,
+                  "WaveConfig must derive from BasicWaveConfigInterface");
+
+    void initialize(uint32_t sampleRate) override {
+        sampleRate_ = sampleRate;
+        WaveConfig::initialize(sampleRate);
+        updateBurstLength();
+    }
+
+    /**
+     * @brief Sets the burst parameters.
+     *
+     * Call this while the waveform generator is not running.
+     */
+    void configureBurst(const settings_type& settings) {
+        settings_ = settings;
+        updateBurstLength();
+    }
+
+    /**
+     * @brief Requests a burst from any task.
+     */
+    void trigger() {
+        postedAtUs_.store(CycleCounter::micros(), std::memory_order_relaxed);
+        pending_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Requests a burst from an interrupt handler.
+     */
+    void triggerFromISR() {
+        trigger();
+    }
+
+    /**
+     * @brief Schedules a burst at an absolute sample index.
+     *
+     * Used as a deterministic, simulated trigger source. Only one scheduled trigger
+     * can be outstanding, a later call replaces it; call this from a single task.
+     *
+     * The index is published with a sequence counter, so the producer never reads a
+     * half-written index and never discards a trigger scheduled after the one it took.
+     * If the producer renders while the index is being written, it picks the trigger
+     * up at the next buffer; a trigger that is overdue by then starts immediately.
+     *
+     * @param sampleIndex The index of the first burst sample, counted from the last `reset()`.
+     */
+    void scheduleTrigger(uint64_t sampleIndex) {
+        const uint32_t sequence = scheduleSequence_.load(std::memory_order_relaxed);
+        scheduleSequence_.store(sequence + 1, std::memory_order_relaxed);   // Odd while writing
+        std::atomic_thread_fence(std::memory_order_release);
+        scheduledAtLow_.store((uint32_t)sampleIndex, std::memory_order_relaxed);
+        scheduledAtHigh_.store((uint32_t)(sampleIndex >> 32), std::memory_order_relaxed);
+        scheduleSequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+#ifndef CONFIG_IDF_TARGET_LINUX
+    /**
+     * @brief Starts a burst on every edge of a GPIO input. Not available on the linux target.
+     *
+     * @param pin The GPIO to use as trigger input.
+     * @param edge The interrupt type, e.g. `GPIO_INTR_POSEDGE`.
+     * @return ESP_OK on success, otherwise the error of the failing GPIO call.
+     */
+    esp_err_t attachGpioTrigger(gpio_num_t pin, gpio_int_type_t edge) {
+        gpio_config_t io_conf = {};
+        io_conf.intr_type = edge;
+        io_conf.mode = GPIO_MODE_INPUT;
+        io_conf.pin_bit_mask = 1ULL << pin;
+        esp_err_t err = gpio_config(&io_conf);
+        if (err != ESP_OK) {
+            return err;
+        }
+        err = gpio_install_isr_service(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) { // Already installed is fine.
+            return err;
+        }
+        return gpio_isr_handler_add(pin, &Burst::gpioIsr, this);
+    }
+#endif
+
+    /**
+     * @brief Retrieves the trigger statistics. Can be called from any task.
+     */
+    BurstStats stats() const {
+        BurstStats stats;
+        stats.triggers = triggers_.load(std::memory_order_relaxed);
+        stats.ignoredTriggers = ignoredTriggers_.load(std::memory_order_relaxed);
+        stats.lastPostToRenderUs = lastPostToRenderUs_.load(std::memory_order_relaxed);
+        stats.lastOffsetSamples = lastOffsetSamples_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /**
+     * @brief Number of samples rendered since the last `reset()`.
+     *
+     * Call this from the waveform generation task or while the generator is stopped.
+     */
+    uint64_t renderedSamples() const { return position_; }
+
+    void reset() override {
+        WaveConfig::reset();
+        position_ = 0;
+        remaining_ = 0;
+        triggerAt_ = NEVER;
+        nextRepeatAt_ = NEVER;
+        pending_.store(false, std::memory_order_relaxed);
+        // Discard the scheduled trigger, including one being written right now.
+        consumedSequence_ = (scheduleSequence_.load(std::memory_order_acquire) + 1) & ~1U;
+    }
+
+    sample_type nextSample() override {
+        sample_type value;
+        renderBlock(&value, 1);
+        return value;
+    }
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    sample_type nextSampleB() override {
+        return lastActive_ ? WaveConfig::nextSampleB() : settings_.idleLevel;
+    }
+#endif
+
+    /**
+     * @brief Renders `n` samples, switching between the wrapped waveform and the idle level.
+     */
+    void renderBlock(sample_type* out, size_t n) {
+        pickUpTriggers(n);
+
+        size_t pos = 0;
+        while (pos < n) {
+            if (remaining_ > 0) {
+                size_t len = (remaining_ < n - pos) ? (size_t)remaining_ : n - pos;
+                renderActive(out + pos, len);
+                remaining_ -= len;
+                pos += len;
+                lastActive_ = true;
+                continue;
+            }
+
+            uint64_t now = position_ + pos;
+            uint64_t start = nextStart();
+            if (start <= now) {
+                beginBurst(now);
+                continue;
+            }
+            size_t len = (start - now < n - pos) ? (size_t)(start - now) : n - pos;
+            std::fill_n(out + pos, len, settings_.idleLevel);
+            pos += len;
+            lastActive_ = false;
+        }
+        position_ += n;
+    }
+
+    /**
+     * @brief Moves on by `samples` samples as if they had been rendered. Only available if
+     *        the wrapped WaveConfig implements `advance()`.
+     *
+     * Triggers are picked up as by `renderBlock()`. Repeated bursts that end within the
+     * jump are skipped in constant time; the wrapped WaveConfig is advanced from the start
+     * of the last burst only.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_advance_v<W>>>
+    void advance(uint64_t samples) {
+        pickUpTriggers(samples);
+
+        const uint64_t end = position_ + samples;
+        while (position_ < end) {
+            if (remaining_ > 0) {
+                uint64_t len = (remaining_ < end - position_) ? remaining_ : end - position_;
+                WaveConfig::advance(len);
+                remaining_ -= len;
+                position_ += len;
+                lastActive_ = true;
+                continue;
+            }
+
+            uint64_t start = nextStart();
+            if (start >= end) {
+                position_ = end;
+                lastActive_ = false;
+                break;
+            }
+            if (start > position_) {
+                position_ = start;
+            }
+            const uint64_t interval = settings_.repeatIntervalSamples;
+            if (start == nextRepeatAt_ && triggerAt_ >= end && interval != 0 && burstSamples_ <= interval) {
+                // Every burst restarts the waveform; only the last one started matters.
+                position_ += (end - 1 - position_) / interval * interval;
+            }
+            beginBurst(position_);
+        }
+    }
+
+private:
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+#ifndef CONFIG_IDF_TARGET_LINUX
+    static void gpioIsr(void* arg) {
+        static_cast<Burst*>(arg)->triggerFromISR();
+    }
+#endif
+
+    void updateBurstLength() {
+        if (sampleRate_ != 0 && settings_.frequency > 0.0f) {
+            burstSamples_ = (uint32_t)((double)settings_.cycles * sampleRate_ / settings_.frequency + 0.5);
+        }
+    }
+
+    void pickUpTriggers(uint64_t n) {
+        if (pending_.exchange(false, std::memory_order_acquire)) {
+            uint32_t offset = settings_.triggerOffsetSamples;
+            lastPostToRenderUs_.store(CycleCounter::micros() - postedAtUs_.load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+            lastOffsetSamples_.store(offset, std::memory_order_relaxed);
+            acceptTrigger(position_ + offset);
+        }
+        uint32_t sequence;
+        uint64_t scheduledAt;
+        if (readScheduledTrigger(sequence, scheduledAt) && scheduledAt < position_ + n) {
+            acceptTrigger((scheduledAt < position_) ? position_ : scheduledAt);
+            consumedSequence_ = sequence;
+        }
+    }
+
+    /**
+     * @return false if no new trigger is scheduled, or if it is being written right now.
+     */
+    bool readScheduledTrigger(uint32_t& sequence, uint64_t& at) const {
+        sequence = scheduleSequence_.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0 || sequence == consumedSequence_) {
+            return false;
+        }
+        const uint32_t low = scheduledAtLow_.load(std::memory_order_relaxed);
+        const uint32_t high = scheduledAtHigh_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (scheduleSequence_.load(std::memory_order_relaxed) != sequence) {
+            return false;
+        }
+        at = ((uint64_t)high << 32) | low;
+        return true;
+    }
+
+    void acceptTrigger(uint64_t at) {
+        // A trigger that lands while a burst is still running is dropped.
+        if (at < position_ + remaining_) {
+            ignoredTriggers_.store(ignoredTriggers_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        triggerAt_ = at;
+    }
+
+    uint64_t nextStart() const {
+        return (triggerAt_ < nextRepeatAt_) ? triggerAt_ : nextRepeatAt_;
+    }
+
+    void beginBurst(uint64_t now) {
+        if (triggerAt_ <= now) {
+            triggers_.store(triggers_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            triggerAt_ = NEVER;
+        }
+        remaining_ = burstSamples_;
+        nextRepeatAt_ = (settings_.repeatIntervalSamples != 0) ? now + settings_.repeatIntervalSamples : NEVER;
+        WaveConfig::reset();
+        if (remaining_ == 0) {
+            // Nothing to emit; avoid spinning on a zero-length burst.
+            nextRepeatAt_ = NEVER;
+        }
+    }
+
+    void renderActive(sample_type* out, size_t len) {
+        if constexpr (has_render_block_v<WaveConfig>) {
+            WaveConfig::renderBlock(out, len);
+        } else {
+            for (size_t i = 0; i < len; ++i) {
+                out[i] = WaveConfig::nextSample();
+            }
+        }
+    }
+
+    settings_type settings_;
+    uint32_t sampleRate_ = 0;
+    uint32_t burstSamples_ = 0;
+
+    // Producer-side state
+    uint64_t position_ = 0;
+    uint64_t remaining_ = 0;
+    uint64_t triggerAt_ = NEVER;
+    uint64_t nextRepeatAt_ = NEVER;
+    bool lastActive_ = false;
+    uint32_t consumedSequence_ = 0;     // scheduleSequence_ of the last trigger taken
+
+    // Statistics, written by the producer only
+    std::atomic<uint32_t> triggers_{0};
+    std::atomic<uint32_t> ignoredTriggers_{0};
+    std::atomic<uint32_t> lastPostToRenderUs_{0};
+    std::atomic<uint32_t> lastOffsetSamples_{0};
+
+    // Trigger inputs shared with other tasks and interrupts
+    std::atomic<bool> pending_{false};
+    std::atomic<uint32_t> postedAtUs_{0};
+    // The scheduled index is split into halves because 64-bit atomics are not lock-free
+    // on Xtensa. scheduleSequence_ is odd while they are written.
+    std::atomic<uint32_t> scheduleSequence_{0};
+    std::atomic<uint32_t> scheduledAtLow_{0};
+    std::atomic<uint32_t> scheduledAtHigh_{0};
+};
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "sdkconfig.h"
+#include "ParameterEvent.h"
+#include "WaveConfigArgs.h"
+#include "WaveConfigInterface.h"
+#include "WaveConfigTraits.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Locks channel B of a WaveConfig to channel A at a fixed offset of whole samples.
+ *
+ * In alternate mode (`CONFIG_WAVEU_CHANNEL_MODE_ALTER`) both DAC channels are rendered by
+ * one WaveConfig. This wrapper delays one of them by `setOffset()` frames, so the two
+ * outputs keep an exact phase relationship of `offset * 360 * frequency / SAMPLE_RATE`
+ * degrees, independent of stops, restarts and events. Positive offsets delay channel B,
+ * negative offsets delay channel A.
+ *
+ * The delay line is primed from a clean state: after `reset()` the wrapper renders the
+ * first `offset` frames of the WaveConfig into it, so the delayed channel starts at the
+ * beginning of the waveform and the leading channel `offset` frames into it. The
+ * WaveConfig only ever renders forward, so stages without `advance()`, such as
+ * `Envelope`, see every frame once. The relationship holds from the first sample after
+ * `initialize()`, `configure()`, `reset()` or `advance()`. Channel B of a `Pipeline` is a
+ * copy of channel A, so the wrapper turns it into a delayed copy.
+ *
+ * In simultaneous mode both DAC channels output the same samples and the offset is ignored.
+ * @code
+ * // Channel B lags channel A by 90 degrees at 1 kHz.
+ * using Wave = ChannelOffset<Pipeline<Oscillator<LUT<Sine, LUT_256>>, Quantize8>, 1024>;
+ * tinyalg::waveu::ESP32Waveu<Wave> waveu;
+ * waveu.chan.setPhaseOffset(90.0f, 1000.0f);
+ * @endcode
+ *
+ * @tparam WaveConfig The WaveConfig to wrap. It must implement `advance(uint64_t)`.
+ * @tparam MaxOffset The largest offset in frames.
+ */
+template <typename WaveConfig, size_t MaxOffset>
+class ChannelOffset : public BasicWaveConfigInterface<typename WaveConfig::sample_type> {
+public:
+    using sample_type = typename WaveConfig::sample_type;
+    static constexpr sample_type MIDSCALE = midscale_of_v<WaveConfig>;
+
+    static_assert(has_advance_v<WaveConfig>, "ChannelOffset requires WaveConfig::advance(uint64_t)");
+    static_assert(MaxOffset > 0, "MaxOffset must be positive");
+
+    /**
+     * @brief Accesses the wrapped WaveConfig, e.g. to change its parameters.
+     */
+    WaveConfig& wave() { return wave_; }
+
+    /**
+     * @brief Sets the offset of channel B relative to channel A in frames.
+     *
+     * Can be called from any task. The waveform generation task applies it before the
+     * next buffer, in `prepareCycle()`, and primes the delay line anew from the current
+     * position, so the leading channel skips ahead by the new offset. While stopped, the
+     * offset is applied by the next `configure()`, `reset()`, `advance()` or `start()`.
+     *
+     * @param frames The offset, clamped to [-MaxOffset, MaxOffset]. Positive values delay channel B.
+     */
+    void setOffset(int32_t frames) {
+        const int32_t max = (int32_t)MaxOffset;
+        requestedOffset_.store((frames > max) ? max : (frames < -max) ? -max : frames,
+                               std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Retrieves the offset last set, which may not have been applied yet.
+     */
+    int32_t getOffset() const { return requestedOffset_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Sets the offset as a phase at a frequency, rounded to whole frames.
+     *
+     * The resolution is `360 * frequency / SAMPLE_RATE` degrees. Takes effect like `setOffset()`.
+     *
+     * @param degrees The phase by which channel B lags channel A.
+     * @param frequency The frequency of the waveform in Hz.
+     */
+    void setPhaseOffset(float degrees, float frequency) {
+        if (frequency <= 0.0f) {
+            return;
+        }
+        setOffset((int32_t)std::lround((double)degrees / 360.0 * (double)sampleRate_ / (double)frequency));
+    }
+
+    void initialize(uint32_t sampleRate) override {
+        sampleRate_ = sampleRate;
+        wave_.initialize(sampleRate);
+        applyRequestedOffset();
+        prime();
+    }
+
+    void configure(const WaveConfigArgs& args) override {
+        tryConfigure(args);
+    }
+
+    /**
+     * @brief Configures the wrapped WaveConfig and primes the delay line from its reset state.
+     */
+    Result tryConfigure(const WaveConfigArgs& args) override {
+        Result result = wave_.tryConfigure(args);
+        reset();
+        return result;
+    }
+
+    void prepareCycle(double elapsedTime) override {
+        if (applyRequestedOffset()) {
+            prime();
+        }
+        wave_.prepareCycle(elapsedTime);
+    }
+
+    /**
+     * @brief Forwards a parameter event to the wrapped WaveConfig. Only available if it
+     *        handles events.
+     *
+     * Channel A sees the event at its sample index and the delayed channel `offset` frames later.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_apply_event_v<W>>>
+    void applyEvent(const ParameterEvent& event) {
+        wave_.applyEvent(event);
+    }
+
+    /**
+     * @brief Retrieves the frequency of the wrapped WaveConfig. Only available if it reports one.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_get_frequency_v<W>>>
+    float getFrequency() {
+        return wave_.getFrequency();
+    }
+
+    /**
+     * @brief Jumps ahead by `samples` frames, rendering forward through the delay line.
+     *
+     * The WaveConfig jumps to `offset` frames before the new position and the delay line
+     * is primed from there. Shorter jumps are rendered frame by frame, unless the offset
+     * has changed, in which case the leading channel skips ahead as with `setOffset()`.
+     */
+    void advance(uint64_t samples) {
+        const bool changed = applyRequestedOffset();
+        const size_t length = delayLength();
+        if (samples >= length) {
+            wave_.advance(samples - length);
+            prime();
+        } else if (changed) {
+            wave_.advance(samples);
+            prime();
+        } else {
+            for (uint64_t i = 0; i < samples; ++i) {
+                nextSample();
+            }
+        }
+    }
+
+    sample_type nextSample() override {
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+        const sample_type a = wave_.nextSample();
+        const sample_type b = wave_.nextSampleB();
+        if (offset_ >= 0) {
+            nextB_ = delay(b);
+            return a;
+        }
+        nextB_ = b;
+        return delay(a);
+#else
+        return wave_.nextSample();
+#endif
+    }
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    sample_type nextSampleB() override {
+        return nextB_;
+    }
+#endif
+
+    void reset() override {
+        wave_.reset();
+        applyRequestedOffset();
+        prime();
+    }
+
+private:
+    /**
+     * @brief Takes over the offset last set with `setOffset()`.
+     *
+     * @return true if the offset has changed. The delay line then has to be primed anew.
+     */
+    bool applyRequestedOffset() {
+        const int32_t requested = requestedOffset_.load(std::memory_order_relaxed);
+        if (requested == offset_) {
+            return false;
+        }
+        offset_ = requested;
+        return true;
+    }
+
+    /**
+     * @brief The length of the delay line, 0 in simultaneous mode.
+     */
+    size_t delayLength() const {
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+        return (size_t)(offset_ >= 0 ? offset_ : -offset_);
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Pushes the current sample of the delayed channel and returns the one `offset` frames ago.
+     */
+    sample_type delay(sample_type current) {
+        const size_t length = delayLength();
+        if (length == 0) {
+            return current;
+        }
+        const sample_type delayed = line_[pos_];
+        line_[pos_] = current;
+        pos_ = (pos_ + 1 == length) ? 0 : pos_ + 1;
+        return delayed;
+    }
+
+    /**
+     * @brief Fills the delay line by rendering the next `offset` frames of the delayed channel.
+     */
+    void prime() {
+        pos_ = 0;
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+        const size_t length = delayLength();
+        for (size_t i = 0; i < length; ++i) {
+            const sample_type a = wave_.nextSample();
+            const sample_type b = wave_.nextSampleB();
+            line_[i] = (offset_ >= 0) ? b : a;
+        }
+#endif
+    }
+
+    WaveConfig wave_;
+    uint32_t sampleRate_ = 0;
+    int32_t offset_ = 0;                        // Applied offset, owned by the waveform generation task
+    std::atomic<int32_t> requestedOffset_{0};   // Written by setOffset() from any task
+    sample_type line_[MaxOffset] = {};
+    size_t pos_ = 0;
+    sample_type nextB_ = 0;
+};
+
+} // namespace tinyalg::waveu
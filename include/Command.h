@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "Result.h"
+#include "WaveConfigArgs.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief A buffer length holding an integer number of waveform periods.
+ */
+struct CyclicPeriod {
+    /// Number of frames in the buffer.
+    size_t frames;
+    /// Number of waveform periods in the buffer.
+    uint32_t cycles;
+    /// The exactly periodic frequency `cycles * SAMPLE_RATE / frames` in Hz.
+    double frequency;
+};
+
+/**
+ * @brief Control operations executed by the waveform generation task.
+ */
+enum class CommandType : uint8_t {
+    Configure,
+    Start,
+    Stop,
+    Reset,
+    StartCyclic,
+    ResumeStreaming,    ///< Issued by `Waveu::postEvent()` to leave cyclic output.
+};
+
+/**
+ * @brief How `Waveu::start()` continues the waveform after `Waveu::stop()`.
+ */
+enum class RestartPolicy : uint8_t {
+    Resume,             ///< Continue with the sample after the last one output, as if time had stood still.
+    PhaseContinuous,    ///< Continue with the sample due now, as if the output had never stopped.
+    Restart,            ///< Start over at sample 0 like after `Waveu::reset()`.
+};
+
+/**
+ * @brief What the waveform generation task outputs instead of a buffer it cannot render in time.
+ */
+enum class OverloadPolicy : uint8_t {
+    RepeatLast,         ///< Output the previous buffer again; the waveform is delayed by one buffer.
+    FadeToMidscale,     ///< Ramp to midscale and hold it; the next buffer ramps back in.
+    SkipAhead,          ///< Output the previous buffer again and skip the missed samples on the timeline.
+    Fallback,           ///< Render at a quarter of the sample rate with sample-and-hold for a few buffers.
+};
+
+/**
+ * @brief Progress or outcome of a command.
+ */
+enum class CommandStatus : uint8_t {
+    Pending,        ///< Queued or being executed.
+    Done,           ///< Executed successfully.
+    InvalidState,   ///< Not allowed in the state the generator was in when the command was executed.
+    QueueFull,      ///< Not queued because the command queue was full.
+    Expired,        ///< Executed, but the outcome has been overwritten by later commands.
+    InvalidArgument,///< Rejected by `WaveConfig::tryConfigure()`, or `WaveConfig::configure()` threw.
+    NoMemory,       ///< `WaveConfig::tryConfigure()` ran out of memory.
+};
+
+/**
+ * @brief Maps a command outcome to a `Result`.
+ *
+ * `Done` and `Expired` map to `ErrorCode::Ok`, `Pending` to `ErrorCode::Pending`,
+ * `InvalidArgument` and `NoMemory` to the `ErrorCode` of the same name.
+ */
+Result toResult(CommandStatus status);
+
+/**
+ * @brief A control operation and its arguments.
+ */
+struct Command {
+    CommandType type;
+    /// `Configure`: the arguments, which must stay valid until the command has completed.
+    const WaveConfigArgs* args;
+    /// `StartCyclic`: the buffer length and frequency to output.
+    CyclicPeriod period;
+};
+
+static_assert(std::is_trivially_copyable_v<Command>, "Command must be trivially copyable");
+
+/**
+ * @brief Records the outcome of executed commands for their `CommandHandle`s.
+ *
+ * Commands are identified by their position in the command queue, which increases
+ * in execution order. The outcome of the last `SLOTS` commands is kept. Only the
+ * waveform generation task calls `complete()`.
+ */
+class CommandTracker {
+public:
+    /// Number of outcomes kept; twice the number of commands that can be queued.
+    static constexpr size_t SLOTS = 2 * CONFIG_WAVEU_COMMAND_QUEUE_LENGTH;
+
+    CommandTracker() = default;
+    CommandTracker(const CommandTracker&) = delete;
+    CommandTracker& operator=(const CommandTracker&) = delete;
+
+    /**
+     * @brief Stores the outcome of a command and wakes a task waiting for it.
+     *
+     * @param position The position of the command in the queue.
+     * @param status The outcome.
+     * @param state The generator state observed when the command was executed.
+     */
+    void complete(uint32_t position, CommandStatus status, uint8_t state);
+
+    /**
+     * @brief Checks whether the command at `position` has been executed.
+     */
+    bool done(uint32_t position) const;
+
+    /**
+     * @brief Retrieves the outcome of the command at `position`.
+     *
+     * @param state If not null, receives the generator state observed by the command.
+     */
+    CommandStatus status(uint32_t position, uint8_t* state) const;
+
+    /**
+     * @brief Registers the task to notify when the command at `position` completes.
+     */
+    void setWaiter(uint32_t position, TaskHandle_t task);
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> tag{UINT32_MAX};   // Position of the command stored here
+        std::atomic<uint8_t> status{0};
+        std::atomic<uint8_t> state{0};
+        std::atomic<TaskHandle_t> waiter{nullptr};
+    };
+
+    Slot slots_[SLOTS];
+    std::atomic<uint32_t> completed_{0};    // Number of commands executed
+};
+
+/**
+ * @brief Tracks the completion of a command submitted to a `Waveu`.
+ *
+ * A handle is a small value that can be copied freely and checked from any task.
+ * `wait()` blocks the calling task on a task notification (index 0) until the waveform
+ * generation task has executed the command. Only one task should wait on a command.
+ */
+class CommandHandle {
+public:
+    CommandHandle() = default;
+
+    CommandHandle(CommandTracker* tracker, uint32_t position)
+        : tracker_(tracker), position_(position), immediate_(CommandStatus::Pending) {}
+
+    explicit CommandHandle(CommandStatus status) : immediate_(status) {}
+
+    /**
+     * @brief Checks whether the command has been executed or rejected.
+     */
+    bool done() const;
+
+    /**
+     * @brief Retrieves the outcome, or `CommandStatus::Pending` if not executed yet.
+     */
+    CommandStatus status() const;
+
+    /**
+     * @brief Waits until the command has been executed.
+     *
+     * Must not be called from the waveform generation task.
+     *
+     * @param ticksToWait The maximum time to wait.
+     * @return The outcome, or `CommandStatus::Pending` on timeout.
+     */
+    CommandStatus wait(TickType_t ticksToWait = portMAX_DELAY) const;
+
+    /**
+     * @brief Retrieves the outcome as a `Result`, or `ErrorCode::Pending` if not executed yet.
+     */
+    Result result() const { return toResult(status()); }
+
+    /**
+     * @brief The generator state observed when the command was executed, as `Waveu::State`.
+     */
+    uint8_t observedState() const;
+
+private:
+    CommandTracker* tracker_ = nullptr;
+    uint32_t position_ = 0;
+    CommandStatus immediate_ = CommandStatus::QueueFull;
+};
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include "sdkconfig.h"
+
+// The linux target of ESP-IDF defines ESP_PLATFORM but has neither a cycle counter nor esp_timer.
+#if defined(ESP_PLATFORM) && !defined(CONFIG_IDF_TARGET_LINUX)
+#define WAVEU_HAS_CPU_CYCLE_COUNTER 1
+#else
+#define WAVEU_HAS_CPU_CYCLE_COUNTER 0
+#endif
+
+#if WAVEU_HAS_CPU_CYCLE_COUNTER
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Thin wrapper around the CPU cycle counter.
+ *
+ * On ESP32 targets this reads the CCOUNT register through `esp_cpu_get_cycle_count()`,
+ * which costs a single instruction. On a host build it falls back to `std::chrono::steady_clock`
+ * and reports nanoseconds, so one "cycle" equals one nanosecond.
+ *
+ * @note The counter is per core and wraps around every 2^32 cycles (about 17.9 s at 240 MHz).
+ *       Differences of two readings taken on the same core remain valid across the wrap.
+ */
+class CycleCounter {
+public:
+    /**
+     * @brief Reads the current value of the cycle counter.
+     *
+     * @return The current cycle count of the calling core.
+     */
+    static inline uint32_t now() {
+#if WAVEU_HAS_CPU_CYCLE_COUNTER
+        return (uint32_t)esp_cpu_get_cycle_count();
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief Retrieves the core ID of the caller.
+     *
+     * @return The core the calling task is running on, or 0 on a host build.
+     */
+    static inline int coreId() {
+#if WAVEU_HAS_CPU_CYCLE_COUNTER
+        return esp_cpu_get_core_id();
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Reads a microsecond timestamp that is consistent across cores.
+     *
+     * Unlike the cycle counter, this clock can be compared between tasks pinned to
+     * different cores. Only the lower 32 bits are returned (wraps after ~71 minutes).
+     *
+     * @return The time since boot in microseconds.
+     */
+    static inline uint32_t micros() {
+#if WAVEU_HAS_CPU_CYCLE_COUNTER
+        return (uint32_t)esp_timer_get_time();
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief Number of counter ticks per microsecond.
+     *
+     * Used to convert timestamps taken with `esp_timer_get_time()` (e.g. across cores)
+     * into the same unit as the cycle counter.
+     */
+    static constexpr uint32_t cyclesPerMicrosecond() {
+#if WAVEU_HAS_CPU_CYCLE_COUNTER && defined(CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ)
+        return CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+#else
+        return 1000;
+#endif
+    }
+};
+
+} // namespace tinyalg::waveu
@@ -13,6 +13,11 @@ enum LUTSize {
     LUT_512 = 512,
     LUT_1024 = 1024,
     LUT_2048 = 2048,
+    LUT_4096 = 4096,
+    LUT_8192 = 8192,
+    LUT_16384 = 16384,
+    LUT_32768 = 32768,
+    LUT_65536 = 65536,
 };
 
 #ifdef CONFIG_WAVEU_LUT_TYPE_INT16
@@ -23,11 +28,13 @@ enum LUTSize {
     typedef uint8_t lut_type_t;
 #endif
 
+// Sample type of the 8-bit DAC of the ESP32. Other boards define their own `sample_type`.
 typedef uint8_t data_buf_type_t;
 
 typedef struct {
     bool data;
     bool terminationTrigger;
+    uint32_t period;    // Timer period in which the buffer was requested, see BufferScheduler::isOverdue()
 } data_generation_msg_type_t;
 
 typedef struct {
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "sdkconfig.h"
+#include "ParameterEvent.h"
+#include "WaveConfigArgs.h"
+#include "WaveConfigInterface.h"
+#include "WaveConfigTraits.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Expands a stream of DAC codes by a power-of-two factor with linear interpolation.
+ *
+ * Codes are kept with 8 fractional bits, so the per-sample step of any factor up to 256
+ * is exact and the interpolated segment ends exactly on the next input code.
+ *
+ * @tparam Sample The sample type, at most 16 bits wide.
+ * @tparam Factor The upsampling factor, a power of two.
+ */
+template <typename Sample, size_t Factor>
+class LinearUpsampler {
+public:
+    static_assert(Factor >= 1 && Factor <= 256 && (Factor & (Factor - 1)) == 0,
+                  "Factor must be a power of two up to 256");
+    static_assert(sizeof(Sample) <= 2, "Sample must be at most 16 bits wide");
+
+    /**
+     * @brief Starts a new segment towards `code`, reached after `Factor` outputs.
+     */
+    void push(Sample code) {
+        const int32_t target = (int32_t)code << FRAC_BITS;
+        if (!primed_) {
+            // Start at the first code instead of ramping up from zero.
+            value_ = target;
+            primed_ = true;
+        }
+        step_ = (target - value_) / (int32_t)Factor;
+    }
+
+    /**
+     * @brief Outputs the next interpolated code.
+     */
+    Sample next() {
+        value_ += step_;
+        return (Sample)((value_ + (1 << (FRAC_BITS - 1))) >> FRAC_BITS);
+    }
+
+    /**
+     * @brief Moves on by `n` outputs of the current segment without computing them.
+     */
+    void skip(size_t n) {
+        value_ += (int32_t)n * step_;
+    }
+
+    void reset() {
+        value_ = 0;
+        step_ = 0;
+        primed_ = false;
+    }
+
+private:
+    static constexpr int FRAC_BITS = 8;
+
+    int32_t value_ = 0;
+    int32_t step_ = 0;
+    bool primed_ = false;
+};
+
+/**
+ * @brief Renders a WaveConfig at `1 / Factor` of the sample rate and interpolates to the DAC rate.
+ *
+ * For slow outputs, such as sub-kHz control signals, most of the CPU time of the producer
+ * is spent computing samples that hardly differ. This wrapper initializes `WaveConfig` with
+ * `sampleRate / Factor`, so its frequencies and durations keep their meaning, pulls one
+ * sample from it every `Factor` output samples, and fills the gaps with `LinearUpsampler`.
+ * The cost per output sample is one addition and a shift plus `1 / Factor` of the cost of
+ * the wrapped WaveConfig.
+ *
+ * Linear interpolation suppresses the images at multiples of the reduced rate with a
+ * sinc^2 response: the further the signal is below the reduced rate, the better. See the
+ * `lut_benchmark` example for measured image rejection. The output lags by one reduced-rate
+ * sample, and parameter events take effect at the next reduced-rate sample.
+ * @code
+ * // A 50 Hz sine rendered at 15625 Sa/s instead of 1 MSa/s.
+ * using Wave = Decimated<Pipeline<Oscillator<LUT<Sine, LUT_256>>, Quantize8>, 64>;
+ * tinyalg::waveu::ESP32Waveu<Wave> waveu;
+ * waveu.chan.wave().stage<0>().setFrequency(50.0f);
+ * @endcode
+ *
+ * @tparam WaveConfig The WaveConfig to render at the reduced rate.
+ * @tparam Factor The decimation factor, a power of two from 2 to 64.
+ */
+template <typename WaveConfig, size_t Factor>
+class Decimated : public BasicWaveConfigInterface<typename WaveConfig::sample_type> {
+public:
+    using sample_type = typename WaveConfig::sample_type;
+    static constexpr sample_type MIDSCALE = midscale_of_v<WaveConfig>;
+
+    static_assert(Factor >= 2 && Factor <= 64 && (Factor & (Factor - 1)) == 0,
+                  "Factor must be a power of two from 2 to 64");
+
+    static constexpr size_t FACTOR = Factor;
+
+    /**
+     * @brief Accesses the wrapped WaveConfig, e.g. to change its parameters.
+     */
+    WaveConfig& wave() { return wave_; }
+
+    void initialize(uint32_t sampleRate) override {
+        wave_.initialize(sampleRate / Factor);
+        resetInterpolation();
+    }
+
+    void configure(const WaveConfigArgs& args) override {
+        wave_.configure(args);
+    }
+
+    Result tryConfigure(const WaveConfigArgs& args) override {
+        return wave_.tryConfigure(args);
+    }
+
+    void prepareCycle(double elapsedTime) override {
+        wave_.prepareCycle(elapsedTime);
+    }
+
+    /**
+     * @brief Forwards a parameter event to the wrapped WaveConfig. Only available if it
+     *        handles events.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_apply_event_v<W>>>
+    void applyEvent(const ParameterEvent& event) {
+        wave_.applyEvent(event);
+    }
+
+    /**
+     * @brief Retrieves the frequency of the wrapped WaveConfig. Only available if it reports one.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_get_frequency_v<W>>>
+    float getFrequency() {
+        return wave_.getFrequency();
+    }
+
+    /**
+     * @brief Moves on by `samples` samples as if they had been rendered. Only available if
+     *        the wrapped WaveConfig implements `advance()`.
+     *
+     * The wrapped WaveConfig is advanced over the skipped reduced-rate samples; only the
+     * last one or two, which the interpolation starts from, are rendered.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_advance_v<W>>>
+    void advance(uint64_t samples) {
+        // Finish the current segment.
+        if (count_ != 0) {
+            const size_t len = (samples < Factor - count_) ? (size_t)samples : Factor - count_;
+            skipOutputs(len);
+            count_ = (count_ + len) & (Factor - 1);
+            samples -= len;
+        }
+        // Whole segments end exactly on their reduced-rate sample, so only the last one is needed.
+        const uint64_t segments = samples / Factor;
+        if (segments > 0) {
+            skipReduced(segments - 1);
+            pushReduced();
+            skipOutputs(Factor);
+        }
+        const size_t rest = (size_t)(samples & (Factor - 1));
+        if (rest > 0) {
+            pushReduced();
+            skipOutputs(rest);
+            count_ = rest;
+        }
+    }
+
+    sample_type nextSample() override {
+        if (count_ == 0) {
+            upsampler_.push(nextReduced(1));
+        }
+        count_ = (count_ + 1) & (Factor - 1);
+        return upsampler_.next();
+    }
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    sample_type nextSampleB() override {
+        // Called right after nextSample(); a new segment has just started if count_ is 1.
+        if (count_ == 1) {
+            upsamplerB_.push(wave_.nextSampleB());
+        }
+        return upsamplerB_.next();
+    }
+#endif
+
+    /**
+     * @brief Renders `n` samples, pulling the reduced-rate samples in blocks.
+     *
+     * Only the reduced-rate samples needed for these `n` samples are rendered, so that
+     * events applied between two calls are not delayed further.
+     */
+    void renderBlock(sample_type* out, size_t n) {
+        while (n > 0) {
+            if (count_ == 0) {
+                upsampler_.push(nextReduced((n + Factor - 1) / Factor));
+            }
+            const size_t len = (n < Factor - count_) ? n : Factor - count_;
+            for (size_t i = 0; i < len; ++i) {
+                out[i] = upsampler_.next();
+            }
+            count_ = (count_ + len) & (Factor - 1);
+            out += len;
+            n -= len;
+        }
+    }
+
+    void reset() override {
+        wave_.reset();
+        resetInterpolation();
+    }
+
+private:
+    /// Number of reduced-rate samples rendered at once by `renderBlock()`.
+    static constexpr size_t REDUCED_BLOCK = 32;
+
+    /**
+     * @brief Takes the next reduced-rate sample, rendering up to `needed` of them if none is left.
+     *
+     * `nextSample()` and `renderBlock()` share this cursor, so samples rendered ahead by
+     * one are not skipped by the other.
+     */
+    sample_type nextReduced(size_t needed) {
+        if (reducedPos_ == reducedLen_) {
+            refill(needed);
+        }
+        return reduced_[reducedPos_++];
+    }
+
+    /**
+     * @brief Starts a segment as `nextSample()` does when `count_` is 0.
+     */
+    void pushReduced() {
+        upsampler_.push(nextReduced(1));
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+        upsamplerB_.push(wave_.nextSampleB());
+#endif
+    }
+
+    void skipOutputs(size_t n) {
+        upsampler_.skip(n);
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+        upsamplerB_.skip(n);
+#endif
+    }
+
+    /**
+     * @brief Drops `n` reduced-rate samples, the ones rendered ahead first.
+     */
+    template <typename W = WaveConfig, typename = std::enable_if_t<has_advance_v<W>>>
+    void skipReduced(uint64_t n) {
+        const size_t buffered = reducedLen_ - reducedPos_;
+        const size_t len = (n < buffered) ? (size_t)n : buffered;
+        reducedPos_ += len;
+        if (n > len) {
+            wave_.advance(n - len);
+        }
+    }
+
+    void refill(size_t needed) {
+        reducedLen_ = (needed < REDUCED_BLOCK) ? needed : REDUCED_BLOCK;
+        reducedPos_ = 0;
+        if constexpr (has_render_block_v<WaveConfig>) {
+            wave_.renderBlock(reduced_, reducedLen_);
+        } else {
+            for (size_t i = 0; i < reducedLen_; ++i) {
+                reduced_[i] = wave_.nextSample();
+            }
+        }
+    }
+
+    void resetInterpolation() {
+        upsampler_.reset();
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+        upsamplerB_.reset();
+#endif
+        count_ = 0;
+        reducedPos_ = 0;
+        reducedLen_ = 0;
+    }
+
+    WaveConfig wave_;
+    LinearUpsampler<sample_type, Factor> upsampler_;
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    LinearUpsampler<sample_type, Factor> upsamplerB_;
+#endif
+    size_t count_ = 0;  // Output samples since the last reduced-rate sample
+    sample_type reduced_[REDUCED_BLOCK];
+    size_t reducedPos_ = 0;
+    size_t reducedLen_ = 0;
+};
+
+} // namespace tinyalg::waveu
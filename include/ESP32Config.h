@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "driver/dac_continuous.h"
@@ -22,9 +23,25 @@ typedef struct {
 class ESP32Config : public BoardConfigInterface {
 public:
     static constexpr uint32_t SAMPLE_RATE = 1000 * KILO; // Sa/s
+
+#ifdef CONFIG_WAVEU_LEAN_MEMORY
+private:
+    static constexpr size_t BYTES_PER_MS = (SAMPLE_RATE / KILO)
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+                  * NUM_CHANNELS
+#endif
+                  * sizeof(uint8_t);
+    // The ping/pong buffers and the DMA buffers, which hold one of them, share the budget.
+    static constexpr uint32_t BUDGET_PERIOD_MS = CONFIG_WAVEU_MEMORY_BUDGET / (3 * BYTES_PER_MS);
+    static constexpr uint32_t LATENCY_PERIOD_MS = CONFIG_WAVEU_LATENCY_TARGET_US / KILO;
+    static constexpr uint32_t PERIOD_MS = (BUDGET_PERIOD_MS < LATENCY_PERIOD_MS) ? BUDGET_PERIOD_MS : LATENCY_PERIOD_MS;
+    static constexpr size_t DMA_BUF_MAX = 4000; // A DMA descriptor holds up to 4092 bytes
+
+public:
+    static constexpr uint32_t TIMER_PERIOD = ((PERIOD_MS > 0) ? PERIOD_MS : 1) * KILO; // us
+#else
     static constexpr uint32_t TIMER_PERIOD = 16 * KILO; // us
-    static constexpr int DAC_DMA_DESC_NUM = 18;
-    static constexpr int DAC_DMA_BUF_SIZE = 4000;
+#endif
 
     static constexpr size_t LEN_DATA_BUFFER =
                     (SAMPLE_RATE / KILO) * (TIMER_PERIOD / KILO)
@@ -33,8 +50,26 @@ public:
 #endif
                   * sizeof(uint8_t);    // Length of each buffer
 
+#ifdef CONFIG_WAVEU_LEAN_MEMORY
+    // Just enough DMA buffers for one ping/pong buffer, as cyclic output requires. This
+    // leaves no slack: the DMA queue holds at most one buffer, so the consumer task must
+    // write the next buffer within one timer period or the DAC underruns. Keep the
+    // consumer task at a high priority, and disable CONFIG_WAVEU_LEAN_MEMORY if writes jitter.
+    static constexpr int DAC_DMA_DESC_NUM =
+                    (LEN_DATA_BUFFER + DMA_BUF_MAX - 1) / DMA_BUF_MAX < 2 ? 2 : (LEN_DATA_BUFFER + DMA_BUF_MAX - 1) / DMA_BUF_MAX;
+    static constexpr int DAC_DMA_BUF_SIZE =
+                    ((LEN_DATA_BUFFER + DAC_DMA_DESC_NUM - 1) / DAC_DMA_DESC_NUM + 3) & ~3;
+
+    // Allocated from DMA-capable heap by the constructor and freed by the destructor.
+    static data_buf_type_t* pingDataBuffer;
+    static data_buf_type_t* pongDataBuffer;
+#else
+    static constexpr int DAC_DMA_DESC_NUM = 18;
+    static constexpr int DAC_DMA_BUF_SIZE = 4000;
+
     static data_buf_type_t pingDataBuffer[LEN_DATA_BUFFER];
     static data_buf_type_t pongDataBuffer[LEN_DATA_BUFFER];
+#endif
 
 private:
 
@@ -55,16 +90,75 @@ public:
 
     static esp_timer_handle_t timer_handle;
 
+    /// @brief Measured duration of the last `startTimer()` call in microseconds. Can be read from any task.
+    static std::atomic<uint32_t> lastStartLatencyUs;
+    /// @brief Measured duration of the last `stopTimer()` call in microseconds. Can be read from any task.
+    static std::atomic<uint32_t> lastStopLatencyUs;
+
     ESP32Config();
     ~ESP32Config();
 
     void initializeDac() override;     // Initialize DAC
     void setupGpio() override;         // Setup GPIO pins for DAC output
     void prepareTimer() override;
+
+    /**
+     * @brief Starts waveform output without blocking.
+     * 
+     * The buffer pre-rendered by `Waveu::configure()`/`Waveu::reset()` (or the buffer
+     * rendered last before `stop()`) is handed to the consumer immediately, the other
+     * buffer is requested from the producer, and the periodic timer is started.
+     * 
+     * Latency: the call performs two non-blocking queue sends and
+     * `esp_timer_start_periodic()`, and never waits for another task. The first sample
+     * reaches the DAC as soon as the consumer task has copied the buffer into the DMA
+     * descriptors. Every call is measured: the duration of the last one is kept in
+     * `lastStartLatencyUs`, and the `StartOutput` stage of the profiler and span of the
+     * tracer record the distribution and the worst case on the target.
+     */
     void startTimer() override;
+
+    /**
+     * @brief Stops waveform output without blocking.
+     * 
+     * Output ends at a buffer boundary: the buffers already handed to the consumer
+     * are played to their last sample, nothing after that. This is at most one
+     * buffer (`TIMER_PERIOD`) after the call, or two if the timer callback was
+     * running concurrently.
+     * 
+     * Latency: one atomic store plus `esp_timer_stop()`, without waiting for another
+     * task. The duration of the last call is kept in `lastStopLatencyUs`, the
+     * distribution in the `StopOutput` stage of the profiler and span of the tracer.
+     */
     void stopTimer() override;
     void cleanupTimer() override;
     void reset() override;
+
+    /**
+     * @brief Hands a buffer to `dac_continuous_write_cyclically()`.
+     * 
+     * The buffer is copied into the DMA descriptors, which are then linked into a
+     * ring, so the DAC repeats it forever at no CPU cost. `len` must not exceed
+     * `DAC_DMA_DESC_NUM * DAC_DMA_BUF_SIZE`.
+     */
+    void startCyclic(const data_buf_type_t* buffer, size_t len) override;
+
+    /**
+     * @brief Disables and re-enables the DAC channels to leave cyclic output.
+     */
+    void stopCyclic() override;
+
+    /**
+     * @brief Retrieves the time of `esp_timer_get_time()` in microseconds.
+     */
+    int64_t getTimeUs() override { return esp_timer_get_time(); }
+
+    /**
+     * @brief Retrieves the size of the DMA buffers of the DAC driver,
+     *        `DAC_DMA_DESC_NUM * DAC_DMA_BUF_SIZE`.
+     */
+    size_t dmaBufferBytes() const override { return (size_t)DAC_DMA_DESC_NUM * DAC_DMA_BUF_SIZE; }
+
     static void timerCallback(void *args);
 };
 
@@ -11,8 +11,19 @@ using ESP32Waveu = Waveu<ESP32Config, WaveConfig>;
 
 }  // namespace tinyalg::waveu
 
+#include "BandLimited.h"
+#include "Burst.h"
+#include "ChannelOffset.h"
+#include "Decimated.h"
+#include "Expression.h"
 #include "LUTHelper.h"
+#include "ModulationEngine.h"
 #include "PhaseGenerator.h"
+#include "Pipeline.h"
+#include "Profiler.h"
+#include "RecorderTap.h"
+#include "Tracer.h"
 #include "WaveConfig.h"
 #include "WaveConfigArgs.h"
 #include "WaveConfigInterface.h"
+#include "Wavetable.h"
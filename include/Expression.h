@@ -0,0 +1,383 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "DataTypes.h"
+#include "LUTHelper.h"
+#include "ParameterEvent.h"
+#include "PhaseGenerator.h"
+#include "Pipeline.h"
+#include "Result.h"
+#include "WaveConfigArgs.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Instructions of the stack machine that evaluates an `Expression`.
+ */
+enum class ExpressionOp : uint8_t {
+    Constant,   ///< Pushes `value`.
+    Phase,      ///< Pushes the phase `p` in [0, 1).
+    Time,       ///< Pushes the time `t` in seconds.
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Neg,
+    Abs,
+    Min,
+    Max,
+    Sin,
+    Tri,
+    Saw,
+    Pulse,
+    Clamp,
+};
+
+/**
+ * @brief One instruction of a compiled `Expression`.
+ */
+struct ExpressionInstruction {
+    ExpressionOp op;
+    float value;    ///< The operand of `ExpressionOp::Constant`.
+};
+
+/**
+ * @brief A waveform described by a formula over the phase `p` and the time `t`, compiled at runtime.
+ *
+ * The language has numbers, `pi`, the variables `p` (phase of the oscillator in [0, 1))
+ * and `t` (seconds, see `ExpressionOscillator`), `+ - * /`, unary minus, parentheses and the functions
+ * - `sin(x)`, `tri(x)`, `saw(x)`: periodic in `x` with a period of 1, in [-1, 1],
+ * - `pulse(x, duty)`: 1 for the first `duty` of each period of `x`, -1 for the rest,
+ * - `clamp(x, lo, hi)`, `min(a, b)`, `max(a, b)`, `abs(x)`.
+ *
+ * The shapes match `Sine`, `Triangle`, `Sawtooth` and `Square` of `Pipeline.h`, so
+ * `sin(p)` is one sine period per oscillator period, `sin(3 * p) / 3` its third harmonic.
+ *
+ * `compile()` translates the source into postfix bytecode and folds constant
+ * subexpressions on the way, so `sin(p) * (1 / 3)` costs one multiplication by a constant.
+ * `evaluateBlock()` runs each instruction over a whole block of samples, which keeps the
+ * interpreter's dispatch out of the per-sample cost. `ExpressionOscillator` goes further
+ * for formulas without `t`: they are pure functions of the phase and are compiled into a
+ * lookup table once.
+ * @code
+ * Expression e;
+ * size_t where = 0;
+ * if (!Expression::compile("0.8 * sin(p) + 0.2 * pulse(4 * p, 0.25)", e, &where)) {
+ *     printf("Syntax error at offset %u\n", (unsigned)where);
+ * }
+ * @endcode
+ */
+class Expression {
+public:
+    /// Maximum number of instructions after constant folding.
+    static constexpr size_t MAX_INSTRUCTIONS = 48;
+    /// Maximum depth of the evaluation stack.
+    static constexpr size_t MAX_STACK = 8;
+    /// Maximum number of samples per `evaluateBlock()` call.
+    static constexpr size_t MAX_BLOCK = 32;
+
+    /**
+     * @brief The registers of `evaluateBlock()`, kept by the caller to stay off the task stack.
+     */
+    struct Scratch {
+        float stack[MAX_STACK][MAX_BLOCK];
+    };
+
+    /**
+     * @brief Parses and compiles `source`.
+     *
+     * @param source The formula, a null-terminated string.
+     * @param out Receives the compiled expression; unchanged on failure.
+     * @param errorOffset If not null, receives the offset into `source` of a syntax error.
+     * @return `ErrorCode::InvalidArgument` on a syntax error, an unknown name, or if the
+     *         expression exceeds `MAX_INSTRUCTIONS` or `MAX_STACK`.
+     */
+    static Result compile(const char* source, Expression& out, size_t* errorOffset = nullptr);
+
+    /**
+     * @brief Whether an expression has been compiled into this object.
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Whether the expression depends on `t`. If not, it is a pure function of the phase.
+     */
+    bool usesTime() const { return usesTime_; }
+
+    /**
+     * @brief The number of instructions after constant folding.
+     */
+    size_t size() const { return size_; }
+
+    const ExpressionInstruction* code() const { return code_; }
+
+    /**
+     * @brief Evaluates the expression for one phase and time with full-precision `std::sin()`.
+     *
+     * Used to fill tables; an empty expression evaluates to 0.
+     */
+    float evaluate(float phase, float time) const;
+
+    /**
+     * @brief Evaluates the expression for `n` samples at once.
+     *
+     * `sin()` is interpolated from a 1024-point table with an error below 2e-5.
+     *
+     * @param phase The phase of each sample in [0, 1).
+     * @param time The time of each sample in seconds.
+     * @param out Receives `n` values; 0 for an empty expression.
+     * @param n The number of samples, at most `MAX_BLOCK`.
+     * @param scratch The registers.
+     */
+    void evaluateBlock(const float* phase, const float* time, float* out, size_t n, Scratch& scratch) const;
+
+private:
+    friend class ExpressionCompiler;
+
+    ExpressionInstruction code_[MAX_INSTRUCTIONS] = {};
+    uint8_t size_ = 0;
+    bool usesTime_ = false;
+};
+
+/**
+ * @brief Arguments accepted by `ExpressionOscillator::configure()`.
+ */
+class ExpressionArgs : public TypedWaveConfigArgs<ExpressionArgs> {
+public:
+    /// The formula; must stay valid until the configure command has completed.
+    const char* expression;
+    /// The frequency of the phase `p` in Hz.
+    float frequency;
+
+    ExpressionArgs(const char* expression, float frequency) : expression(expression), frequency(frequency) {}
+};
+
+/**
+ * @brief Source stage: a `PhaseGenerator` driving an `Expression`.
+ *
+ * A formula without `t` is rendered once into a table of `Size` entries through
+ * `LUTHelper::tryFillTable()` and then costs the same as `Oscillator<LUT<...>>`. A formula
+ * with `t` runs as block bytecode: the phases and times of a sub-block are computed
+ * together and the expression is evaluated once per `Pipeline::BLOCK_SIZE` samples.
+ * @code
+ * using Wave = Pipeline<ExpressionOscillator<LUT_1024>, Quantize8>;
+ * tinyalg::waveu::ESP32Waveu<Wave> waveu;
+ * // Pure function of the phase: compiled into a table.
+ * ExpressionArgs organ("0.6 * sin(p) + 0.3 * sin(2 * p) + 0.1 * sin(4 * p)", 440.0f);
+ * waveu.configure(organ);
+ * // Depends on time: a 2 Hz tremolo, evaluated as bytecode.
+ * ExpressionArgs tremolo("sin(p) * (0.6 + 0.4 * tri(2 * t))", 440.0f);
+ * waveu.configure(tremolo);
+ * @endcode
+ *
+ * `t` counts the seconds since `reset()` and wraps around to 0 every `TIME_WRAP_SECONDS`,
+ * so that it keeps a resolution finer than a sample in single precision. A periodic
+ * function of `t` stays continuous across the wrap if its frequency is a multiple of
+ * `1 / TIME_WRAP_SECONDS` Hz, e.g. any whole number of Hz.
+ *
+ * A formula that does not compile is logged and leaves the previous one in place;
+ * `Waveu::tryConfigure()` returns the error. Validate formulas from user input with
+ * `Expression::compile()` first.
+ *
+ * @tparam Size The size of the table for formulas without `t`.
+ */
+template <LUTSize Size = LUT_1024>
+class ExpressionOscillator {
+public:
+    static constexpr size_t SIZE = static_cast<size_t>(Size);
+    static_assert((SIZE & (SIZE - 1)) == 0, "LUT size must be a power of two");
+
+    static inline const char* TAG = "Waveu-Expression";
+
+    /// The period after which `t` wraps around to 0. At 64 s a float still resolves 8 us.
+    static constexpr uint32_t TIME_WRAP_SECONDS = 64;
+
+    void initialize(uint32_t sampleRate) {
+        sampleRate_ = sampleRate;
+        phaseGenerator_ = PhaseGenerator(sampleRate);
+        reset();
+    }
+
+    /**
+     * @brief Takes the formula and the frequency from `ExpressionArgs`, or the frequency
+     *        from `OscillatorArgs`.
+     */
+    void configure(const WaveConfigArgs& args) {
+        tryConfigure(args);
+    }
+
+    /**
+     * @brief `configure()` returning the error of `load()`, so that `Waveu::tryConfigure()`
+     *        reports a formula that does not compile.
+     */
+    Result tryConfigure(const WaveConfigArgs& args) {
+        Result result;
+        if (const auto* exprArgs = args.as<ExpressionArgs>()) {
+            result = load(exprArgs->expression);
+            if (!result) {
+                ESP_LOGE(TAG, "Cannot compile \"%s\": %s", exprArgs->expression, result.toString());
+            }
+            setFrequency(exprArgs->frequency);
+        } else if (const auto* oscArgs = args.as<OscillatorArgs>()) {
+            setFrequency(oscArgs->frequency);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Compiles and switches to a new formula.
+     *
+     * Call it from the waveform generation task, or while stopped. Filling the table of a
+     * formula without `t` takes `Size` evaluations.
+     *
+     * @return `ErrorCode::InvalidArgument` if the formula does not compile; the previous one stays.
+     */
+    Result load(const char* source) {
+        Expression compiled;
+        Result result = Expression::compile(source, compiled);
+        if (!result) {
+            return result;
+        }
+        discardPending();
+        expression_ = compiled;
+        tableMode_ = !expression_.usesTime();
+        if (tableMode_) {
+            return LUTHelper::tryFillTable(table_, Size,
+                                           [this](float phase) { return expression_.evaluate(phase, 0.0f); });
+        }
+        return ErrorCode::Ok;
+    }
+
+    /**
+     * @brief Whether the current formula has been compiled into a table.
+     */
+    bool isTabulated() const { return tableMode_; }
+
+    const Expression& expression() const { return expression_; }
+
+    void setFrequency(float frequency) {
+        discardPending();
+        phaseGenerator_.setFrequency(frequency);
+    }
+
+    float getFrequency() const { return phaseGenerator_.getFrequency(); }
+
+    void reset() {
+        phaseGenerator_.reset();
+        sample_ = 0;
+        pos_ = 0;
+        len_ = 0;
+    }
+
+    void advance(uint64_t samples) {
+        discardPending();
+        phaseGenerator_.advance(samples);
+        sample_ += samples;
+    }
+
+    void applyEvent(const ParameterEvent& event) {
+        if (event.type == ParameterEventType::Frequency) {
+            setFrequency(event.value.f);
+        } else if (event.type == ParameterEventType::Phase) {
+            discardPending();
+            phaseGenerator_.setPhase(event.value.u);
+        }
+    }
+
+    /**
+     * @brief Evaluates the bytecode for the next `n` samples.
+     */
+    void beginBlock(size_t n) {
+        if (!tableMode_ && pos_ == len_) {
+            evaluate(n);
+        }
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t) {
+        if (tableMode_) {
+            return table_[phaseGenerator_.nextPhase() >> (PhaseGenerator::N_BITS - INDEX_BITS)];
+        }
+        if (pos_ == len_) {
+            // Not prepared by beginBlock(), e.g. when used outside a Pipeline.
+            evaluate(Expression::MAX_BLOCK);
+        }
+        return block_[pos_++];
+    }
+
+    PhaseGenerator& phaseGenerator() { return phaseGenerator_; }
+
+private:
+    static constexpr int log2(size_t n) { return (n <= 1) ? 0 : 1 + log2(n >> 1); }
+    static constexpr int INDEX_BITS = log2(SIZE);
+
+    /**
+     * @brief Renders the next `n` samples of the bytecode into `block_` and moves past them.
+     */
+    void evaluate(size_t n) {
+        if (n > Expression::MAX_BLOCK) {
+            n = Expression::MAX_BLOCK;
+        }
+        uint32_t phases[Expression::MAX_BLOCK];
+        phaseGenerator_.fillPhases(phases, n);
+        // Wrap the sample count rather than t itself, so the times of a block are exact
+        // offsets from a start that stays small enough for single precision.
+        const uint64_t wrap = (uint64_t)TIME_WRAP_SECONDS * sampleRate_;
+        const uint32_t first = (uint32_t)(sample_ % wrap);
+        const float secondsPerSample = 1.0f / (float)sampleRate_;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t s = first + (uint32_t)(i + 1);
+            if (s >= wrap) {
+                s -= (uint32_t)wrap;
+            }
+            phase_[i] = (float)(phases[i] >> 8) * (1.0f / (1 << 24));
+            time_[i] = (float)s * secondsPerSample;
+        }
+        sample_ += n;
+        float values[Expression::MAX_BLOCK];
+        expression_.evaluateBlock(phase_, time_, values, n, scratch_);
+        for (size_t i = 0; i < n; ++i) {
+            float v = values[i];
+            if (!(v >= -1.0f)) {
+                v = (v == v) ? -1.0f : 0.0f;    // NaN outputs silence
+            } else if (v > 1.0f) {
+                v = 1.0f;
+            }
+            block_[i] = (int32_t)(v * 32767.0f);
+        }
+        pos_ = 0;
+        len_ = n;
+    }
+
+    /**
+     * @brief Steps back over samples evaluated ahead but not output yet, so a parameter
+     *        change takes effect at the next sample.
+     */
+    void discardPending() {
+        const size_t pending = len_ - pos_;
+        if (pending > 0) {
+            phaseGenerator_.advance((uint64_t)0 - pending);
+            sample_ -= pending;
+        }
+        pos_ = 0;
+        len_ = 0;
+    }
+
+    PhaseGenerator phaseGenerator_{0};
+    uint32_t sampleRate_ = 1;
+    Expression expression_;
+    bool tableMode_ = true;
+    int16_t table_[SIZE] = {};
+    uint64_t sample_ = 0;       // Samples evaluated since reset(), for t
+    int32_t block_[Expression::MAX_BLOCK] = {};
+    size_t pos_ = 0;
+    size_t len_ = 0;
+    float phase_[Expression::MAX_BLOCK];
+    float time_[Expression::MAX_BLOCK];
+    Expression::Scratch scratch_;
+};
+
+} // namespace tinyalg::waveu
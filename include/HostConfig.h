@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "BoardConfigInterface.h"
+#include "BufferScheduler.h"
+#include "DataTypes.h"
+#include "Profiler.h"
+#include "Queues.h"
+#include "Semaphores.h"
+#include "Tracer.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Output statistics of a `HostConfig`.
+ */
+struct HostOutputStats {
+    /// Ping/pong buffers handed to the sink.
+    uint32_t buffers;
+    /// Samples handed to the sink, cyclic repetitions included, counting both channels in alternate mode.
+    uint64_t samples;
+    /// Repetitions of the cyclic buffer handed to the sink.
+    uint32_t cyclicRepeats;
+};
+
+/**
+ * @brief A reference board without hardware that hands rendered buffers to a callback.
+ *
+ * Runs the same producer/consumer protocol as `ESP32Config`, paced by a FreeRTOS
+ * software timer instead of `esp_timer`, and passes every buffer at its native width
+ * to a sink instead of a DAC. It exercises sample types wider than 8 bits, e.g.
+ * `HostConfig<uint16_t>` for a 16-bit converter, on any FreeRTOS port including the
+ * ESP-IDF linux target.
+ *
+ * Cyclic output is emulated by handing the cyclic buffer to the sink once per timer
+ * period, from the timer task.
+ *
+ * @tparam Sample The sample type, e.g. `uint16_t`.
+ * @tparam SampleRate The nominal sample rate in Sa/s, a multiple of 1000.
+ * @tparam TimerPeriod The buffer period in microseconds, a multiple of the tick period.
+ */
+template <typename Sample, uint32_t SampleRate = 48000, uint32_t TimerPeriod = 16000>
+class HostConfig : public BasicBoardConfigInterface<Sample> {
+public:
+    static_assert(SampleRate % 1000 == 0, "SampleRate must be a multiple of 1000");
+    static_assert(TimerPeriod % 1000 == 0, "TimerPeriod must be a multiple of 1 ms");
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    static constexpr size_t CHANNELS = 2;
+#else
+    static constexpr size_t CHANNELS = 1;
+#endif
+
+    static constexpr uint32_t SAMPLE_RATE = SampleRate; // Sa/s
+    static constexpr uint32_t TIMER_PERIOD = TimerPeriod; // us
+
+    /// Length of each buffer in samples.
+    static constexpr size_t LEN_DATA_BUFFER = (SAMPLE_RATE / 1000) * (TIMER_PERIOD / 1000) * CHANNELS;
+
+    alignas(4) static inline Sample pingDataBuffer[LEN_DATA_BUFFER] = {};
+    alignas(4) static inline Sample pongDataBuffer[LEN_DATA_BUFFER] = {};
+
+    /**
+     * @brief Receives each buffer as it would be written to the DAC.
+     *
+     * @param samples The buffer. It is only valid during the call.
+     * @param len The number of samples, counting both channels in alternate mode.
+     * @param context The pointer passed to `setSink()`.
+     */
+    using Sink = void (*)(const Sample* samples, size_t len, void* context);
+
+    static inline const char* TAG = "Waveu-HostConfig";
+
+    ~HostConfig() override {
+        ESP_LOGD(TAG, "Running the destructor ~HostConfig()...");
+    }
+
+    /**
+     * @brief Sets the callback receiving the output. Call it before `Waveu::start()`.
+     */
+    void setSink(Sink sink, void* context) {
+        sink_ = sink;
+        sinkContext_ = context;
+    }
+
+    /**
+     * @brief Retrieves the output statistics.
+     */
+    HostOutputStats stats() const {
+        return { buffers_.load(std::memory_order_relaxed), samples_.load(std::memory_order_relaxed),
+                 cyclicRepeats_.load(std::memory_order_relaxed) };
+    }
+
+    void initializeDac() override {}
+
+    void setupGpio() override {}
+
+    void prepareTimer() override {
+        timer_ = xTimerCreate("Host Timer", pdMS_TO_TICKS(TIMER_PERIOD / 1000), pdTRUE, this,
+                              &HostConfig::timerCallback);
+        if (timer_ == nullptr) {
+            ESP_LOGE(TAG, "Timer cannot be created.");
+        }
+
+        // Invoke the consumer task.
+        UBaseType_t uxPriority = CONFIG_WAVEU_CONSUMER_TASK_PRIORITY;
+        xTaskCreate(waveformDataOutputTask, "waveformDataOutputTask", CONFIG_WAVEU_CONSUMER_TASK_STACK_SIZE, this, uxPriority, nullptr);
+        ESP_LOGI(TAG, "waveformDataOutputTask at priority %d.", uxPriority);
+    }
+
+    void startTimer() override {
+        WAVEU_PROFILE_SCOPE(ProfileStage::StartOutput);
+        WAVEU_TRACE_SCOPE(TraceEvent::StartOutput, 0);
+        // Output the pre-rendered buffer right away instead of waiting for the first period.
+        BufferScheduler::startOutput();
+        xTimerStart(timer_, 0);
+    }
+
+    void stopTimer() override {
+        WAVEU_PROFILE_SCOPE(ProfileStage::StopOutput);
+        WAVEU_TRACE_SCOPE(TraceEvent::StopOutput, 0);
+        BufferScheduler::stopOutput();
+        xTimerStop(timer_, 0);
+    }
+
+    void cleanupTimer() override {
+        if (timer_ != nullptr) {
+            xTimerDelete(timer_, 0);
+            timer_ = nullptr;
+        }
+    }
+
+    void reset() override {
+        // The ping buffer is pre-rendered and output first after a reset.
+        BufferScheduler::resetToPing();
+    }
+
+    /**
+     * @brief Reads the monotonic host clock, like `esp_timer_get_time()` on the ESP32.
+     */
+    int64_t getTimeUs() override {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    size_t cyclicBufferBytes() const override { return sizeof(cyclicBuffer_); }
+
+    void startCyclic(const Sample* buffer, size_t len) override {
+        len = std::min(len, LEN_DATA_BUFFER);
+        std::copy_n(buffer, len, cyclicBuffer_);
+        cyclicLength_ = len;
+        cyclic_.store(true, std::memory_order_release);
+        xTimerStart(timer_, 0);
+    }
+
+    void stopCyclic() override {
+        cyclic_.store(false, std::memory_order_release);
+        xTimerStop(timer_, 0);
+        BufferScheduler::resetToPing();
+    }
+
+    /**
+     * @brief Runs one timer period. Called by the timer, or directly to step without a scheduler.
+     */
+    void tick() {
+        if (cyclic_.load(std::memory_order_acquire)) {
+            output(cyclicBuffer_, cyclicLength_);
+            cyclicRepeats_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // The timer task must not block.
+        BufferScheduler::tick(0);
+    }
+
+    /**
+     * @brief Outputs one buffer requested by the timer. Called by the consumer task, or
+     *        directly to step without a scheduler.
+     *
+     * @return false if a termination was requested.
+     */
+    bool consumeBuffer(TickType_t ticksToWait) {
+        data_output_msg_type_t receivedData;
+        if (xQueueReceive(dataOutputQueue, &receivedData, ticksToWait) != pdTRUE) {
+            return true;
+        }
+        if (receivedData.terminationTrigger) {
+            return false;
+        }
+        WAVEU_TRACE_INSTANT(TraceEvent::OutputQueueReceive, receivedData.data);
+
+        Sample* buffer = receivedData.data ? pingDataBuffer : pongDataBuffer;
+        SemaphoreHandle_t semaphore = receivedData.data ? pingBufferSemaphore : pongBufferSemaphore;
+        BaseType_t taken;
+        {
+            WAVEU_TRACE_SCOPE(TraceEvent::ConsumerWait, receivedData.data);
+            taken = xSemaphoreTake(semaphore, portMAX_DELAY);
+        }
+        if (taken == pdTRUE) {
+            {
+                WAVEU_TRACE_SCOPE(TraceEvent::DacWrite, receivedData.data);
+                output(buffer, LEN_DATA_BUFFER);
+            }
+            buffers_.fetch_add(1, std::memory_order_relaxed);
+            xSemaphoreGive(semaphore);
+        }
+        return true;
+    }
+
+private:
+    static void timerCallback(TimerHandle_t timer) {
+        static_cast<HostConfig*>(pvTimerGetTimerID(timer))->tick();
+    }
+
+    static void waveformDataOutputTask(void* args) {
+        HostConfig* instance = static_cast<HostConfig*>(args);
+        while (instance->consumeBuffer(portMAX_DELAY)) {
+        }
+        ESP_LOGI(TAG, "Stopping waveformDataOutputTask...");
+        vTaskDelete(NULL);
+    }
+
+    void output(const Sample* buffer, size_t len) {
+        if (sink_ != nullptr) {
+            sink_(buffer, len, sinkContext_);
+        }
+        samples_.fetch_add(len, std::memory_order_relaxed);
+    }
+
+    TimerHandle_t timer_ = nullptr;
+    Sink sink_ = nullptr;
+    void* sinkContext_ = nullptr;
+
+    std::atomic<bool> cyclic_{false};
+    size_t cyclicLength_ = 0;
+    alignas(4) static inline Sample cyclicBuffer_[LEN_DATA_BUFFER] = {};
+
+    std::atomic<uint32_t> buffers_{0};
+    std::atomic<uint64_t> samples_{0};
+    std::atomic<uint32_t> cyclicRepeats_{0};
+};
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Waveu.h"       // Includes the Waveu class template
+#include "HostConfig.h"  // Includes the HostConfig reference board
+
+namespace tinyalg::waveu {
+
+// Alias for Waveu specialized with HostConfig at the sample type of the WaveConfig
+template <typename WaveConfig, typename Sample = typename WaveConfig::sample_type>
+using HostWaveu = Waveu<HostConfig<Sample>, WaveConfig>;
+
+}  // namespace tinyalg::waveu
+
+#include "BandLimited.h"
+#include "Burst.h"
+#include "ChannelOffset.h"
+#include "Decimated.h"
+#include "Expression.h"
+#include "LUTHelper.h"
+#include "ModulationEngine.h"
+#include "PhaseGenerator.h"
+#include "Pipeline.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "WaveConfig.h"
+#include "WaveConfigArgs.h"
+#include "WaveConfigInterface.h"
+#include "Wavetable.h"
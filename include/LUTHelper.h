@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional> // For std::function
 #include "DataTypes.h"
+#include "Result.h"
 
 namespace tinyalg::waveu {
 
@@ -12,14 +14,24 @@ using LUTIndexFunction = int(*)(size_t phaseValue, size_t numBits);
 
 class LUTHelper {
 public:
-    static inline int calculateIndex_16(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_32(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_64(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_128(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_256(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_512(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_1024(size_t phaseValue, size_t numBits);
-    static inline int calculateIndex_2048(size_t phaseValue, size_t numBits);
+    /**
+     * @brief Computes the index into a table of `2^Bits` entries from the upper bits of the phase.
+     *
+     * Instantiated for every size supported by `getIndexFunction()`.
+     */
+    template <int Bits>
+    static inline int calculateIndex(size_t phaseValue, size_t numBits) {
+        return (int)((phaseValue >> (numBits - Bits)) & ((size_t(1) << Bits) - 1));
+    }
+
+    static inline int calculateIndex_16(size_t phaseValue, size_t numBits) { return calculateIndex<4>(phaseValue, numBits); }
+    static inline int calculateIndex_32(size_t phaseValue, size_t numBits) { return calculateIndex<5>(phaseValue, numBits); }
+    static inline int calculateIndex_64(size_t phaseValue, size_t numBits) { return calculateIndex<6>(phaseValue, numBits); }
+    static inline int calculateIndex_128(size_t phaseValue, size_t numBits) { return calculateIndex<7>(phaseValue, numBits); }
+    static inline int calculateIndex_256(size_t phaseValue, size_t numBits) { return calculateIndex<8>(phaseValue, numBits); }
+    static inline int calculateIndex_512(size_t phaseValue, size_t numBits) { return calculateIndex<9>(phaseValue, numBits); }
+    static inline int calculateIndex_1024(size_t phaseValue, size_t numBits) { return calculateIndex<10>(phaseValue, numBits); }
+    static inline int calculateIndex_2048(size_t phaseValue, size_t numBits) { return calculateIndex<11>(phaseValue, numBits); }
 
     /**
      * @brief Retrieves a function pointer to calculate the LUT index for a given LUT size.
@@ -29,7 +41,7 @@ public:
      * function returned is tailored to the specified LUT size.
      *
      * @param lutSize The size of the Lookup Table (LUT) for which the index function is required.
-     *                Valid values include predefined sizes such as LUT_16, LUT_32, etc.
+     *                Valid values are the predefined sizes from LUT_16 to LUT_65536.
      * 
      * @return A function pointer of type `LUTIndexFunction` that computes the LUT index.
      *         The function returned takes two parameters:
@@ -38,9 +50,37 @@ public:
      * 
      * @note The returned function is optimized for the specified LUT size and assumes that
      *       the input parameters are within valid ranges.
+     * 
+     * @note The call through the function pointer cannot be inlined. Renderers that know
+     *       the table size at compile time should use `LUTIndex`, others `LUTIndexMapper`.
+     * 
+     * @throws std::invalid_argument If `lutSize` is not supported. Built without exceptions,
+     *         the call aborts instead; use `tryGetIndexFunction()` there.
      */
     static LUTIndexFunction getIndexFunction(LUTSize lutSize);
 
+    /**
+     * @brief Retrieves the LUT index function without throwing.
+     * 
+     * @param lutSize The size of the Lookup Table (LUT).
+     * @param indexFunction Receives the function on success.
+     * @return `ErrorCode::InvalidArgument` if `lutSize` is not supported.
+     */
+    static Result tryGetIndexFunction(LUTSize lutSize, LUTIndexFunction& indexFunction);
+
+    /**
+     * @brief Fills a Q15 table of one period from a shape function.
+     * 
+     * Entry `i` holds `shape(i / lutSize)` scaled by 32767 and rounded; values outside
+     * [-1, 1] are clamped. Index the table with the function from `getIndexFunction()`.
+     * 
+     * @param table Receives `lutSize` entries.
+     * @param lutSize The size of the table, one of the sizes supported by `getIndexFunction()`.
+     * @param shape Maps a phase in [0, 1) to a value in [-1, 1].
+     * @return `ErrorCode::InvalidArgument` if `lutSize` is not supported.
+     */
+    static Result tryFillTable(int16_t* table, LUTSize lutSize, const std::function<float(float)>& shape);
+
     /**
      * @brief Adjusts amplitude and offset to ensure they fit within valid bounds.
      * 
@@ -58,4 +98,87 @@ public:
     static std::pair<float, float> adjustAmplitudeAndOffset(float amplitude, float offset);
 };
 
+/**
+ * @brief Maps a phase to the index into a table of `Size` entries, with the size known at compile time.
+ *
+ * For a power of two, the index is the upper bits of the phase. Any other size, e.g. a
+ * table holding exactly one period of a frequency that does not divide the sample rate,
+ * uses the upper word of `phase * Size`: one 32x32->64-bit multiplication and no division.
+ * Both compile to a few inline instructions, unlike the function pointers of `LUTHelper`.
+ *
+ * @tparam Size The number of table entries, at least 2.
+ */
+template <size_t Size>
+struct LUTIndex {
+    static_assert(Size >= 2 && Size <= (size_t(1) << 31), "Size must be between 2 and 2^31");
+
+    static constexpr bool POWER_OF_TWO = (Size & (Size - 1)) == 0;
+
+    /**
+     * @brief The index for a 32-bit phase, full scale being one period.
+     */
+    static constexpr uint32_t index(uint32_t phase) {
+        if constexpr (POWER_OF_TWO) {
+            return phase >> (32 - log2(Size));
+        } else {
+            return (uint32_t)(((uint64_t)phase * Size) >> 32);
+        }
+    }
+
+    /**
+     * @brief Computes the indices of `n` phases, e.g. from `PhaseGenerator::fillPhases()`.
+     */
+    static void fill(const uint32_t* phases, uint32_t* indices, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            indices[i] = index(phases[i]);
+        }
+    }
+
+private:
+    static constexpr int log2(size_t n) { return (n <= 1) ? 0 : 1 + log2(n >> 1); }
+};
+
+/**
+ * @brief Maps a phase to the index into a table of any length chosen at runtime.
+ *
+ * Uses the multiply-high scheme of `LUTIndex` for all lengths, so it works for powers of
+ * two as well. The low word of the product is the position between two entries, which
+ * can drive linear interpolation.
+ */
+class LUTIndexMapper {
+public:
+    /**
+     * @param length The number of table entries, at least 1.
+     */
+    explicit LUTIndexMapper(uint32_t length) : length_(length) {}
+
+    uint32_t length() const { return length_; }
+
+    /**
+     * @brief The index for a 32-bit phase, full scale being one period.
+     */
+    inline uint32_t index(uint32_t phase) const {
+        return (uint32_t)(((uint64_t)phase * length_) >> 32);
+    }
+
+    /**
+     * @brief The position between entry `index(phase)` and the next one, full scale being one entry.
+     */
+    inline uint32_t fraction(uint32_t phase) const {
+        return (uint32_t)((uint64_t)phase * length_);
+    }
+
+    /**
+     * @brief Computes the indices of `n` phases, e.g. from `PhaseGenerator::fillPhases()`.
+     */
+    void fill(const uint32_t* phases, uint32_t* indices, size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            indices[i] = index(phases[i]);
+        }
+    }
+
+private:
+    uint32_t length_;
+};
+
 } // namespace tinyalg::waveu
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "Result.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief A waveform shape: maps a phase in [0, 1) to a value, normally in [-1, 1].
+ *
+ * The `value` functions of the `LUT` shapes, e.g. `&Sine::value`, qualify.
+ */
+using LUTShape = float (*)(float phase);
+
+/**
+ * @brief The element type of a shared table.
+ */
+enum class LUTElementType : uint8_t {
+    Int16,
+    Uint16,
+    Uint8,
+};
+
+/**
+ * @brief The `LUTElementType` of a C++ type.
+ */
+template <typename T>
+struct lut_element_type;
+
+template <>
+struct lut_element_type<int16_t> {
+    static constexpr LUTElementType value = LUTElementType::Int16;
+};
+
+template <>
+struct lut_element_type<uint16_t> {
+    static constexpr LUTElementType value = LUTElementType::Uint16;
+};
+
+template <>
+struct lut_element_type<uint8_t> {
+    static constexpr LUTElementType value = LUTElementType::Uint8;
+};
+
+template <typename T>
+inline constexpr LUTElementType lut_element_type_v = lut_element_type<T>::value;
+
+/**
+ * @brief Identifies a table: entry `i` is `shape(i / size) * amplitude + offset`, rounded
+ *        and clamped to the range of `type`.
+ *
+ * Keys compare `amplitude` and `offset` quantized to `1 / QUANTUM` of an output step, so
+ * values that differ only by float rounding, or `0.0f` and `-0.0f`, share a table.
+ */
+struct LUTKey {
+    /// Quantization steps per output step when comparing `amplitude` and `offset`.
+    static constexpr float QUANTUM = 64.0f;
+
+    LUTShape shape;
+    uint32_t size;
+    LUTElementType type;
+    float amplitude;
+    float offset;
+
+    bool operator==(const LUTKey& other) const {
+        return shape == other.shape && size == other.size && type == other.type
+            && quantize(amplitude) == quantize(other.amplitude) && quantize(offset) == quantize(other.offset);
+    }
+
+    /**
+     * @brief Rounds a finite parameter to `1 / QUANTUM` of an output step.
+     */
+    static int64_t quantize(float value) {
+        constexpr double LIMIT = 1e18;  // Far beyond any output range, within int64_t
+        const double scaled = (double)value * QUANTUM;
+        return std::llround(scaled > LIMIT ? LIMIT : scaled < -LIMIT ? -LIMIT : scaled);
+    }
+
+    /**
+     * @brief The key of a table of `T` with `size` entries.
+     */
+    template <typename T>
+    static LUTKey of(LUTShape shape, uint32_t size, float amplitude, float offset = 0.0f) {
+        return {shape, size, lut_element_type_v<T>, amplitude, offset};
+    }
+};
+
+class LUTRegistry;
+
+/**
+ * @brief A counted reference to an immutable table of the `LUTRegistry`.
+ *
+ * Copying a reference shares the table, destroying the last reference frees it. The
+ * table data does not move while referenced, so renderers may keep the pointer from
+ * `data()` and read it without any locking. Copying, assigning and destroying
+ * references lock the registry and must not be done on the render path.
+ */
+class SharedLUT {
+public:
+    SharedLUT() = default;
+    SharedLUT(const SharedLUT& other);
+    SharedLUT(SharedLUT&& other) noexcept;
+    SharedLUT& operator=(const SharedLUT& other);
+    SharedLUT& operator=(SharedLUT&& other) noexcept;
+    ~SharedLUT() { reset(); }
+
+    /**
+     * @brief Drops the reference, freeing the table if it was the last one.
+     */
+    void reset();
+
+    explicit operator bool() const { return entry_ != nullptr; }
+
+    /**
+     * @brief The table entries, or nullptr for an empty reference.
+     *
+     * @tparam T The element type the table was built with.
+     */
+    template <typename T>
+    const T* data() const { return static_cast<const T*>(data_); }
+
+    /**
+     * @brief The number of table entries, or 0 for an empty reference.
+     */
+    uint32_t size() const { return size_; }
+
+    /**
+     * @brief The number of references to the table, including this one.
+     */
+    uint32_t useCount() const;
+
+private:
+    friend class LUTRegistry;
+
+    struct Entry;
+
+    explicit SharedLUT(Entry* entry);
+
+    Entry* entry_ = nullptr;
+    const void* data_ = nullptr;
+    uint32_t size_ = 0;
+};
+
+/**
+ * @brief Process-wide cache of tables shared between WaveConfigs.
+ *
+ * Oscillator banks, both channels of a `Waveu` or repeated `initialize()` calls would
+ * otherwise each build and hold an identical table. `acquire()` builds a table on the
+ * first request for its `LUTKey` and hands out counted references to it for later
+ * ones; the table is freed when the last reference is dropped.
+ * @code
+ * SharedLUT sine = LUTRegistry::instance().acquire(LUTKey::of<int16_t>(&Sine::value, 1024, 32767.0f));
+ * const int16_t* table = sine.data<int16_t>();   // Read without locking while `sine` lives.
+ * @endcode
+ *
+ * Building and freeing tables is serialized by a mutex. Reading a table through the
+ * pointer of its reference never touches the registry, so the render path is lock-free.
+ */
+class LUTRegistry {
+public:
+    /**
+     * @brief The registry of the process. Created on first use and never destroyed, so
+     *        references in static objects can be released at any time.
+     */
+    static LUTRegistry& instance();
+
+    LUTRegistry(const LUTRegistry&) = delete;
+    LUTRegistry& operator=(const LUTRegistry&) = delete;
+
+    /**
+     * @brief Returns a reference to the table of `key`, building it if necessary.
+     *
+     * @throws std::invalid_argument If `key` has no shape, a size of 0, or a non-finite
+     *         amplitude or offset.
+     * @throws std::bad_alloc If the table cannot be allocated.
+     */
+    SharedLUT acquire(const LUTKey& key);
+
+    /**
+     * @brief Returns a reference to the table of `key` without throwing.
+     *
+     * @param key The table.
+     * @param out Receives the reference on success.
+     * @return `ErrorCode::InvalidArgument` if `key` has no shape, a size of 0, or a
+     *         non-finite amplitude or offset,
+     *         `ErrorCode::NoMemory` if the table cannot be allocated.
+     */
+    Result tryAcquire(const LUTKey& key, SharedLUT& out);
+
+    /**
+     * @brief The number of tables currently held.
+     */
+    size_t tableCount() const;
+
+    /**
+     * @brief The memory currently held by tables, including their bookkeeping, in bytes.
+     */
+    size_t totalBytes() const;
+
+    /**
+     * @brief The largest value `totalBytes()` has reached.
+     */
+    size_t peakBytes() const;
+
+private:
+    friend class SharedLUT;
+
+    LUTRegistry();
+
+    /**
+     * @brief Finds or builds the table of `key` and counts a new reference to it.
+     *
+     * @return The entry, or nullptr if it cannot be allocated.
+     */
+    SharedLUT::Entry* retainOrBuild(const LUTKey& key);
+    void retain(SharedLUT::Entry* entry);
+    void release(SharedLUT::Entry* entry);
+    uint32_t useCount(const SharedLUT::Entry* entry) const;
+
+    SemaphoreHandle_t mutex_;
+    StaticSemaphore_t mutexBuffer_;
+    SharedLUT::Entry* entries_ = nullptr;
+    size_t tableCount_ = 0;
+    size_t totalBytes_ = 0;
+    size_t peakBytes_ = 0;
+};
+
+} // namespace tinyalg::waveu
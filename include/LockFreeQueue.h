@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Bounded multi-producer, single-consumer queue without locks.
+ *
+ * Each cell carries a sequence number that tells whether it is free for the
+ * producer of a given lap or holds data for the consumer. `push()` never blocks:
+ * it fails immediately when the queue is full and only retries when another
+ * producer claimed the same cell concurrently. `pop()` is wait-free. Both can be
+ * called from tasks and interrupt handlers, since they only use 32-bit atomics.
+ *
+ * @tparam T A trivially copyable element type.
+ * @tparam Capacity The number of cells; must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class LockFreeQueue {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+    LockFreeQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store((uint32_t)i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    /**
+     * @brief Appends an element. Safe to call from any task or ISR.
+     *
+     * @param value The element to append.
+     * @param position If not null, receives the position of the element in the queue.
+     *                 Positions count up from zero in the order elements are popped.
+     * @return true if the element was queued, false if the queue is full.
+     */
+    bool push(const T& value, uint32_t* position = nullptr) {
+        uint32_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & MASK];
+            uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        if (position != nullptr) {
+            *position = pos;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element. Must only be called by the single consumer.
+     *
+     * @param value Receives the element.
+     * @param position If not null, receives the position the element was pushed at.
+     * @return true if an element was removed, false if the queue is empty.
+     */
+    bool pop(T& value, uint32_t* position = nullptr) {
+        Cell* cell = &cells_[dequeuePos_ & MASK];
+        uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+        if ((int32_t)(seq - (dequeuePos_ + 1)) < 0) {
+            return false; // Empty
+        }
+        value = cell->data;
+        if (position != nullptr) {
+            *position = dequeuePos_;
+        }
+        cell->sequence.store(dequeuePos_ + Capacity, std::memory_order_release);
+        dequeuePos_++;
+        return true;
+    }
+
+    /**
+     * @brief Checks whether an element is ready for the consumer.
+     *
+     * A single acquire load, cheap enough to be polled once per buffer.
+     */
+    bool empty() const {
+        const Cell* cell = &cells_[dequeuePos_ & MASK];
+        return (int32_t)(cell->sequence.load(std::memory_order_acquire) - (dequeuePos_ + 1)) < 0;
+    }
+
+private:
+    static constexpr uint32_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        T data;
+    };
+
+    Cell cells_[Capacity];
+    std::atomic<uint32_t> enqueuePos_{0};
+    uint32_t dequeuePos_ = 0;   // Owned by the consumer
+};
+
+} // namespace tinyalg::waveu
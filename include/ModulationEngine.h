@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ParameterEvent.h"
+#include "PhaseGenerator.h"
+#include "Pipeline.h"
+#include "WaveConfigArgs.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief How an operator reacts to the output of the operator before it.
+ */
+enum class ModulationType : uint8_t {
+    Frequency,  ///< The input is added to the phase increment (FM).
+    Phase,      ///< The input is added to the phase at the table lookup (PM).
+};
+
+/**
+ * @brief Fixed-point modulation index in Q16.16; `MODULATION_INDEX_ONE` is an index of 1.0.
+ */
+static constexpr int32_t MODULATION_INDEX_ONE = 1 << 16;
+
+/**
+ * @brief A phase accumulator and a `LUT` whose phase can be modulated by a Q15 input.
+ *
+ * The modulation depth is kept as a phase-increment (FM) or phase (PM) deviation per
+ * full-scale input, so `process()` applies the input with one multiply and a shift.
+ * Floating point is only used when a frequency or index changes.
+ *
+ * @tparam Table A `LUT` instantiation.
+ * @tparam Type How the input modulates the operator.
+ */
+template <typename Table, ModulationType Type = ModulationType::Frequency>
+class Operator {
+public:
+    static constexpr ModulationType TYPE = Type;
+
+    void initialize(uint32_t sampleRate) {
+        sampleRate_ = sampleRate;
+        table_.initialize();
+    }
+
+    /**
+     * @brief Sets the frequency of the operator without modulation.
+     */
+    void setFrequency(float frequency) {
+        frequency_ = frequency;
+        increment_ = (uint32_t)((double)frequency / (double)sampleRate_ * (double)(1ULL << PhaseGenerator::N_BITS));
+    }
+
+    float getFrequency() const { return frequency_; }
+
+    uint32_t getPhaseIncrement() const { return increment_; }
+
+    /**
+     * @brief Sets the depth at which the input modulates the operator.
+     *
+     * @param indexQ16 The modulation index in Q16.16. For FM it is the peak frequency
+     *                 deviation over the modulator frequency, for PM the peak phase
+     *                 deviation in radians.
+     * @param modulatorIncrement The phase increment of the modulating operator, used by FM.
+     */
+    void setIndex(int32_t indexQ16, uint32_t modulatorIncrement) {
+        indexQ16_ = indexQ16;
+        if constexpr (Type == ModulationType::Frequency) {
+            // Peak deviation = index * modulator frequency, in phase-increment units.
+            depth_ = ((int64_t)indexQ16 * modulatorIncrement) >> 16;
+        } else {
+            // Peak deviation = index / 2pi periods, in phase units.
+            depth_ = (int64_t)std::llround((double)indexQ16 / MODULATION_INDEX_ONE / (2.0 * M_PI)
+                                           * (double)(1ULL << PhaseGenerator::N_BITS));
+        }
+    }
+
+    int32_t getIndex() const { return indexQ16_; }
+
+    void setPhase(uint32_t phase) { phase_ = phase; }
+
+    void reset() { phase_ = 0; }
+
+    /**
+     * @brief Jumps ahead by `samples` samples at the unmodulated frequency.
+     *
+     * Exact for phase modulation. With frequency modulation the phase deviation
+     * accumulated over the jump is ignored; it is bounded by the modulation index.
+     */
+    void advance(uint64_t samples) { phase_ += (uint32_t)samples * increment_; }
+
+    /**
+     * @brief Advances the operator by one sample.
+     *
+     * @param modulation The output of the previous operator in Q15.
+     * @return The table value in Q15.
+     */
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t modulation) {
+        const uint32_t deviation = (uint32_t)(((int64_t)modulation * depth_) >> 15);
+        if constexpr (Type == ModulationType::Frequency) {
+            phase_ += increment_ + deviation;
+            return table_.lookup(phase_);
+        } else {
+            phase_ += increment_;
+            return table_.lookup(phase_ + deviation);
+        }
+    }
+
+private:
+    Table table_;
+    uint32_t sampleRate_ = 0;
+    float frequency_ = 0.0f;
+    uint32_t increment_ = 0;
+    uint32_t phase_ = 0;
+    int32_t indexQ16_ = 0;
+    int64_t depth_ = 0;
+};
+
+/**
+ * @brief A chain of `Operator`s, each modulating the next one, as a Pipeline source stage.
+ *
+ * The first operator runs unmodulated; the output of operator `I - 1` modulates
+ * operator `I`, and the last operator (the carrier) is the output. Two operators make
+ * classic two-operator FM or PM, more operators make a modulator stack:
+ * @code
+ * // 1 kHz carrier, frequency modulated by 100 Hz at index 2.5.
+ * using Fm = ModulationEngine<Operator<LUT<Sine, LUT_256>>, Operator<LUT<Sine, LUT_1024>>>;
+ * using Wave = Pipeline<Fm, Quantize8>;
+ * waveu.chan.stage<0>().setFrequency(0, 100.0f);
+ * waveu.chan.stage<0>().setIndex(1, MODULATION_INDEX_ONE * 5 / 2);
+ * waveu.configure(OscillatorArgs(1000.0f));
+ * @endcode
+ *
+ * Everything runs in integer arithmetic per sample: one table lookup, one multiply
+ * and a few additions per operator.
+ *
+ * @tparam Operators The operators, first modulator first and carrier last.
+ */
+template <typename... Operators>
+class ModulationEngine {
+public:
+    static_assert(sizeof...(Operators) > 0, "ModulationEngine needs at least one operator");
+
+    static constexpr size_t NUM_OPERATORS = sizeof...(Operators);
+    static constexpr size_t CARRIER = NUM_OPERATORS - 1;
+
+    void initialize(uint32_t sampleRate) {
+        std::apply([sampleRate](auto&... op) { (op.initialize(sampleRate), ...); }, operators_);
+    }
+
+    /**
+     * @brief Takes the carrier frequency from `OscillatorArgs`.
+     */
+    void configure(const WaveConfigArgs& args) {
+        if (const auto* oscArgs = args.as<OscillatorArgs>()) {
+            setFrequency(oscArgs->frequency);
+        }
+    }
+
+    /**
+     * @brief Sets the frequency of an operator and updates the FM depth it drives.
+     *
+     * @param op The index of the operator, 0 for the first modulator.
+     * @param frequency The frequency in Hz.
+     */
+    void setFrequency(size_t op, float frequency) {
+        forOperator(op, [this, frequency](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            std::get<I>(operators_).setFrequency(frequency);
+            if constexpr (I + 1 < NUM_OPERATORS) {
+                updateIndex<I + 1>();
+            }
+        });
+    }
+
+    /**
+     * @brief Sets the carrier frequency.
+     */
+    void setFrequency(float frequency) { setFrequency(CARRIER, frequency); }
+
+    /**
+     * @brief Retrieves the carrier frequency.
+     */
+    float getFrequency() const { return std::get<CARRIER>(operators_).getFrequency(); }
+
+    /**
+     * @brief Sets the index at which operator `op - 1` modulates operator `op`.
+     *
+     * @param op The index of the modulated operator, at least 1.
+     * @param indexQ16 The modulation index in Q16.16, see `Operator::setIndex()`.
+     */
+    void setIndex(size_t op, int32_t indexQ16) {
+        forOperator(op, [this, indexQ16](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            if constexpr (I > 0) {
+                std::get<I>(operators_).setIndex(indexQ16, std::get<I - 1>(operators_).getPhaseIncrement());
+            }
+        });
+    }
+
+    /**
+     * @brief Accesses an operator.
+     */
+    template <size_t I>
+    auto& op() { return std::get<I>(operators_); }
+
+    /**
+     * @brief Restarts all operators at phase zero.
+     */
+    void reset() {
+        std::apply([](auto&... op) { (op.reset(), ...); }, operators_);
+    }
+
+    /**
+     * @brief Jumps all operators ahead by `samples` samples, see `Operator::advance()`.
+     */
+    void advance(uint64_t samples) {
+        std::apply([samples](auto&... op) { (op.advance(samples), ...); }, operators_);
+    }
+
+    /**
+     * @brief Handles `Frequency` and `Phase` events for the carrier.
+     */
+    void applyEvent(const ParameterEvent& event) {
+        if (event.type == ParameterEventType::Frequency) {
+            setFrequency(event.value.f);
+        } else if (event.type == ParameterEventType::Phase) {
+            std::get<CARRIER>(operators_).setPhase(event.value.u);
+        }
+    }
+
+    /**
+     * @brief Renders one sample. The input is ignored.
+     */
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t) {
+        return processChain(std::index_sequence_for<Operators...>{});
+    }
+
+    /**
+     * @brief Renders `n` samples in Q15 into `out`.
+     */
+    void render(int32_t* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = processChain(std::index_sequence_for<Operators...>{});
+        }
+    }
+
+private:
+    template <typename F, size_t... Is>
+    void forOperator(size_t op, F&& f, std::index_sequence<Is...>) {
+        ((op == Is ? f(std::integral_constant<size_t, Is>{}) : void()), ...);
+    }
+
+    template <typename F>
+    void forOperator(size_t op, F&& f) {
+        forOperator(op, std::forward<F>(f), std::index_sequence_for<Operators...>{});
+    }
+
+    template <size_t I>
+    void updateIndex() {
+        auto& op = std::get<I>(operators_);
+        op.setIndex(op.getIndex(), std::get<I - 1>(operators_).getPhaseIncrement());
+    }
+
+    template <size_t... Is>
+    WAVEU_ALWAYS_INLINE int32_t processChain(std::index_sequence<Is...>) {
+        int32_t x = 0;
+        ((x = std::get<Is>(operators_).process(x)), ...);
+        return x;
+    }
+
+    std::tuple<Operators...> operators_;
+};
+
+} // namespace tinyalg::waveu
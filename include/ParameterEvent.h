@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Kinds of parameter changes that can be scheduled at a sample index.
+ */
+enum class ParameterEventType : uint8_t {
+    Frequency,  ///< `value.f` holds the new frequency in Hz.
+    Amplitude,  ///< `value.f` holds the new amplitude, 1.0 being full scale.
+    Phase,      ///< `value.u` holds the new phase (full scale of `PhaseGenerator::N_BITS` is one period).
+    Shape,      ///< `value.u` holds a WaveConfig-defined shape selector.
+    Offset,     ///< `value.f` holds the new DC offset, 1.0 being full scale.
+};
+
+/**
+ * @brief A parameter change keyed to an absolute sample index.
+ *
+ * Sample indices count the samples (frames in alternate mode) rendered since the last
+ * `Waveu::configure()` or `Waveu::reset()`; both start over at sample 0, as does
+ * `start()` with `RestartPolicy::Restart`. The change takes effect exactly before the
+ * sample with this index is rendered. Events whose index has already passed are
+ * applied at the start of the next buffer.
+ */
+struct ParameterEvent {
+    uint64_t sampleIndex;
+    ParameterEventType type;
+    union {
+        float f;
+        uint32_t u;
+    } value;
+
+    static ParameterEvent frequency(uint64_t sampleIndex, float hz) {
+        ParameterEvent e{sampleIndex, ParameterEventType::Frequency, {}};
+        e.value.f = hz;
+        return e;
+    }
+
+    static ParameterEvent amplitude(uint64_t sampleIndex, float amplitude) {
+        ParameterEvent e{sampleIndex, ParameterEventType::Amplitude, {}};
+        e.value.f = amplitude;
+        return e;
+    }
+
+    static ParameterEvent phase(uint64_t sampleIndex, uint32_t phase) {
+        ParameterEvent e{sampleIndex, ParameterEventType::Phase, {}};
+        e.value.u = phase;
+        return e;
+    }
+
+    static ParameterEvent shape(uint64_t sampleIndex, uint32_t shape) {
+        ParameterEvent e{sampleIndex, ParameterEventType::Shape, {}};
+        e.value.u = shape;
+        return e;
+    }
+
+    static ParameterEvent offset(uint64_t sampleIndex, float offset) {
+        ParameterEvent e{sampleIndex, ParameterEventType::Offset, {}};
+        e.value.f = offset;
+        return e;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<ParameterEvent>, "ParameterEvent must be trivially copyable");
+
+} // namespace tinyalg::waveu
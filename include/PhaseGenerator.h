@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include "Profiler.h"
 
 namespace tinyalg::waveu {
 
@@ -43,7 +45,54 @@ public:
      * This method advances the phase accumulator by the phase
      * increment, ensuring it wraps around correctly for periodic waveforms.
      */
-    void updatePhase();
+    inline void updatePhase() {
+        phase_ += phaseIncrement_;
+    }
+
+    /**
+     * @brief Advances the phase accumulator by one sample and returns the new phase.
+     * 
+     * Equivalent to `updatePhase()` followed by `getPhase()`.
+     * 
+     * @return The new phase.
+     */
+    inline uint32_t nextPhase() {
+        phase_ += phaseIncrement_;
+        return phase_;
+    }
+
+    /**
+     * @brief Writes the phases of the next `n` samples and advances past them.
+     * 
+     * Equivalent to calling `updatePhase()` and `getPhase()` `n` times. Each phase is
+     * computed from the current one independently, so the loop can be unrolled and
+     * vectorized.
+     * 
+     * @param out Receives `n` phases.
+     * @param n The number of samples.
+     */
+    inline void fillPhases(uint32_t* out, size_t n) {
+        WAVEU_PROFILE_SCOPE(ProfileStage::PhaseStep);
+        const uint32_t phase = phase_;
+        const uint32_t increment = phaseIncrement_;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = phase + (uint32_t)(i + 1) * increment;
+        }
+        phase_ = phase + (uint32_t)n * increment;
+    }
+
+    /**
+     * @brief Advances the phase accumulator by `samples` samples in constant time.
+     * 
+     * The phase wraps modulo 2^N_BITS, so the jump is a single multiplication of the
+     * phase increment modulo 2^N_BITS. Use it to skip ahead or to seek instead of
+     * stepping through the samples.
+     * 
+     * @param samples The number of samples to skip.
+     */
+    inline void advance(uint64_t samples) {
+        phase_ += (uint32_t)samples * phaseIncrement_;
+    }
 
     /**
      * @brief Retrieves the current phase value.
@@ -53,7 +102,14 @@ public:
      * 
      * @return The current phase as a 32-bit unsigned integer.
      */
-    uint32_t getPhase() const;
+    inline uint32_t getPhase() const { return phase_; }
+
+    /**
+     * @brief Sets the phase accumulator to the given value.
+     * 
+     * @param phase The new phase, where the full 32-bit range represents one period.
+     */
+    inline void setPhase(uint32_t phase) { phase_ = phase; }
 
     /**
      * @brief Resets the phase accumulator to the expected phase using the current elapsed time.
@@ -71,7 +127,23 @@ public:
      */
     void reset();
 
-    float getFrequency();
+    float getFrequency() const;
+
+    /**
+     * @brief Retrieves the phase increment per sample for the current frequency.
+     * 
+     * @return The phase increment, where the full 32-bit range represents one period.
+     */
+    inline uint32_t getPhaseIncrement() const { return phaseIncrement_; }
+
+    /**
+     * @brief Sets the phase increment per sample directly, e.g. while gliding to a new frequency.
+     * 
+     * `getFrequency()` keeps returning the frequency last set with `setFrequency()`.
+     * 
+     * @param phaseIncrement The phase increment, where the full 32-bit range represents one period.
+     */
+    inline void setPhaseIncrement(uint32_t phaseIncrement) { phaseIncrement_ = phaseIncrement; }
 
 private:
     uint32_t sampleRate_;       // Sampling rate in Hz
@@ -0,0 +1,663 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sdkconfig.h"
+#include "DataTypes.h"
+#include "LUTHelper.h"
+#include "LUTRegistry.h"
+#include "ParameterEvent.h"
+#include "PhaseGenerator.h"
+#include "Profiler.h"
+#include "SmoothedValue.h"
+#include "WaveConfigArgs.h"
+#include "WaveConfigInterface.h"
+#include "WaveConfigTraits.h"
+
+#define WAVEU_ALWAYS_INLINE __attribute__((always_inline)) inline
+
+namespace tinyalg::waveu {
+
+/*
+ * Building blocks for composing a WaveConfig from stages.
+ *
+ * Stages exchange samples as `int32_t` in bipolar Q15 format, i.e. [-32768, 32767]
+ * represents [-1.0, 1.0). A stage is any class providing
+ *
+ *     int32_t process(int32_t in);       // required, called once per sample
+ *     void initialize(uint32_t rate);    // optional
+ *     void configure(const WaveConfigArgs& args); // optional
+ *     void beginBlock(size_t n);         // optional, called before every sub-block
+ *     void applyEvent(const ParameterEvent& event); // optional, see Waveu::postEvent()
+ *     void advance(uint64_t samples);    // optional, see has_advance
+ *     void reset();                      // optional
+ *
+ * The last stage must be a quantizer (e.g. `Quantize8`) that maps Q15 to DAC codes
+ * and defines the sample type of the pipeline.
+ */
+
+/// @brief Sine wave shape for `LUT`.
+struct Sine {
+    static float value(float phase) { return std::sin(2.0f * (float)M_PI * phase); }
+};
+
+/// @brief Triangular wave shape for `LUT`.
+struct Triangle {
+    static float value(float phase) {
+        return (phase < 0.5f) ? (4.0f * phase - 1.0f) : (3.0f - 4.0f * phase);
+    }
+};
+
+/// @brief Rising sawtooth wave shape for `LUT`.
+struct Sawtooth {
+    static float value(float phase) { return 2.0f * phase - 1.0f; }
+};
+
+/// @brief Square wave shape for `LUT`.
+struct Square {
+    static float value(float phase) { return (phase < 0.5f) ? 1.0f : -1.0f; }
+};
+
+/**
+ * @brief A Q15 lookup table of one waveform period.
+ *
+ * The table is taken from the `LUTRegistry`, so all `LUT`s of the same shape and size,
+ * e.g. in several pipelines or in an oscillator and a modulator, share one copy that
+ * is built once. Lookups read it directly without locking.
+ *
+ * Sizes that are not a power of two are indexed with a multiply-high instead of a
+ * shift (see `LUTIndex`), e.g. `LUT<Sine, LUTSize(1000)>` holds exactly one period of
+ * 1 kHz at 1 MSa/s.
+ *
+ * @tparam Shape A type with `static float value(float phase)` returning [-1, 1] for phase in [0, 1).
+ * @tparam Size One of the predefined `LUTSize` values, or any other length of at least 2.
+ */
+template <typename Shape, LUTSize Size>
+class LUT {
+public:
+    static constexpr size_t SIZE = static_cast<size_t>(Size);
+    static_assert(SIZE >= 2, "LUT size must be at least 2");
+
+    /**
+     * @brief Acquires the table of `Shape` from the `LUTRegistry`, building it on first use.
+     */
+    void initialize() {
+        if (!shared_) {
+            shared_ = LUTRegistry::instance().acquire(LUTKey::of<int16_t>(&Shape::value, (uint32_t)SIZE, 32767.0f));
+            table_ = shared_.data<int16_t>();
+        }
+    }
+
+    /**
+     * @brief Fetches the value at the given phase. Requires `initialize()`.
+     *
+     * @param phase A phase from `PhaseGenerator` (full scale is one period).
+     * @return The table value in Q15.
+     */
+    WAVEU_ALWAYS_INLINE int32_t lookup(uint32_t phase) const {
+        uint32_t index;
+        {
+            WAVEU_PROFILE_SAMPLED_SCOPE(ProfileStage::IndexCompute);
+            index = LUTIndex<SIZE>::index(phase);
+        }
+        WAVEU_PROFILE_SAMPLED_SCOPE(ProfileStage::LutFetch);
+        return table_[index];
+    }
+
+private:
+    SharedLUT shared_;
+    const int16_t* table_ = nullptr;
+};
+
+/**
+ * @brief Arguments accepted by `Oscillator::configure()`.
+ */
+class OscillatorArgs : public TypedWaveConfigArgs<OscillatorArgs> {
+public:
+    float frequency;
+
+    explicit OscillatorArgs(float frequency) : frequency(frequency) {}
+};
+
+/**
+ * @brief Source stage: a `PhaseGenerator` driving a `LUT`.
+ *
+ * The input sample is ignored; the output is the table value at the current phase.
+ *
+ * @tparam Table A `LUT` instantiation.
+ */
+template <typename Table>
+class Oscillator {
+public:
+    void initialize(uint32_t sampleRate) {
+        sampleRate_ = sampleRate;
+        phaseGenerator_ = PhaseGenerator(sampleRate);
+        table_.initialize();
+    }
+
+    /**
+     * @brief Takes the frequency from `OscillatorArgs`, without gliding.
+     */
+    void configure(const WaveConfigArgs& args) {
+        if (const auto* oscArgs = args.as<OscillatorArgs>()) {
+            phaseGenerator_.setFrequency(oscArgs->frequency);
+            glide_.setValue(phaseGenerator_.getPhaseIncrement());
+        }
+    }
+
+    /**
+     * @brief Sets the time over which later frequency changes glide.
+     *
+     * The phase increment is ramped per sample, so the frequency sweeps without a
+     * discontinuity in pitch. Zero, the default, changes the frequency immediately.
+     *
+     * @param seconds The glide time.
+     * @param type Linear in frequency, or an exponential approach.
+     */
+    void setGlideTime(float seconds, SmoothingType type = SmoothingType::Linear) {
+        glide_.setRampTime(seconds, sampleRate_, type);
+    }
+
+    /**
+     * @brief Changes the frequency, gliding if `setGlideTime()` was set.
+     */
+    void setFrequency(float frequency) {
+        if (!glide_.isSmoothing()) {
+            // Glide from the current increment, even if it was set through phaseGenerator().
+            glide_.setValue(phaseGenerator_.getPhaseIncrement());
+        }
+        phaseGenerator_.setFrequency(frequency);
+        glide_.setTarget(phaseGenerator_.getPhaseIncrement());
+        phaseGenerator_.setPhaseIncrement((uint32_t)glide_.getValue());
+    }
+
+    /**
+     * @brief Retrieves the frequency last set, i.e. the target of a glide in progress.
+     */
+    float getFrequency() const { return phaseGenerator_.getFrequency(); }
+
+    void reset() { phaseGenerator_.reset(); }
+
+    /**
+     * @brief Jumps ahead by `samples` samples. Exact unless a glide is in progress.
+     */
+    void advance(uint64_t samples) {
+        phaseGenerator_.advance(samples);
+        if (glide_.isSmoothing()) {
+            glide_.skip(samples);
+            phaseGenerator_.setPhaseIncrement((uint32_t)glide_.getValue());
+        }
+    }
+
+    void applyEvent(const ParameterEvent& event) {
+        if (event.type == ParameterEventType::Frequency) {
+            setFrequency(event.value.f);
+        } else if (event.type == ParameterEventType::Phase) {
+            phaseGenerator_.setPhase(event.value.u);
+        }
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t) {
+        if (glide_.isSmoothing()) {
+            phaseGenerator_.setPhaseIncrement((uint32_t)glide_.next());
+        }
+        return table_.lookup(phaseGenerator_.nextPhase());
+    }
+
+    PhaseGenerator& phaseGenerator() { return phaseGenerator_; }
+
+private:
+    PhaseGenerator phaseGenerator_{0};
+    Table table_;
+    uint32_t sampleRate_ = 0;
+    SmoothedValue glide_;   // Phase increment
+};
+
+/**
+ * @brief Amplitude modulator (tremolo) with its own low-frequency oscillator.
+ *
+ * The LFO is evaluated once per sub-block, so the modulation depth changes at
+ * control rate (`SAMPLE_RATE / Pipeline::BLOCK_SIZE`) at no per-sample cost.
+ *
+ * @tparam Table A `LUT` instantiation for the LFO shape.
+ * @tparam DepthQ15 Modulation depth in Q15 (32767 means full depth).
+ */
+template <typename Table, int32_t DepthQ15>
+class Modulator {
+public:
+    static_assert(DepthQ15 >= 0 && DepthQ15 <= 32767, "DepthQ15 must be in [0, 32767]");
+
+    void initialize(uint32_t sampleRate) {
+        lfo_ = PhaseGenerator(sampleRate);
+        table_.initialize();
+    }
+
+    void setFrequency(float frequency) { lfo_.setFrequency(frequency); }
+
+    void reset() { lfo_.reset(); }
+
+    void advance(uint64_t samples) { lfo_.advance(samples); }
+
+    void beginBlock(size_t n) {
+        int32_t lfo = table_.lookup(lfo_.getPhase());
+        // Gain swings between (1 - depth) and 1.
+        gain_ = 32767 - ((DepthQ15 * (32767 - lfo)) >> 16);
+        lfo_.advance(n);
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t in) { return (in * gain_) >> 15; }
+
+private:
+    PhaseGenerator lfo_{0};
+    Table table_;
+    int32_t gain_ = 32767;
+};
+
+/**
+ * @brief Linear attack/release envelope.
+ *
+ * The envelope starts closed and opens over `AttackSamples` after `reset()` or
+ * `gate(true)`, and closes over `ReleaseSamples` after `gate(false)`.
+ */
+template <uint32_t AttackSamples, uint32_t ReleaseSamples>
+class Envelope {
+public:
+    static_assert(AttackSamples > 0 && ReleaseSamples > 0, "Envelope times must be non-zero");
+
+    void reset() { level_ = 0; gate(true); }
+
+    void gate(bool open) {
+        step_ = open ? ATTACK_STEP : -RELEASE_STEP;
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t in) {
+        // Compare before adding: with AttackSamples == 1 the sum would overflow.
+        if (step_ > FULL_SCALE - level_) {
+            level_ = FULL_SCALE;
+        } else {
+            level_ += step_;
+            if (level_ < 0) {
+                level_ = 0;
+            }
+        }
+        return (int32_t)(((int64_t)in * level_) >> 30);
+    }
+
+private:
+    static constexpr int32_t FULL_SCALE = 1 << 30;
+    static constexpr int32_t ATTACK_STEP = FULL_SCALE / (int32_t)AttackSamples;
+    static constexpr int32_t RELEASE_STEP = FULL_SCALE / (int32_t)ReleaseSamples;
+
+    int32_t level_ = 0;
+    int32_t step_ = ATTACK_STEP;
+};
+
+/**
+ * @brief Scales the signal by a runtime gain.
+ *
+ * Handles `ParameterEventType::Amplitude` events, where 1.0 is unity gain. After
+ * `setRampTime()`, changes ramp per sample instead of jumping, which avoids clicks.
+ */
+class Gain {
+public:
+    void initialize(uint32_t sampleRate) { sampleRate_ = sampleRate; }
+
+    /**
+     * @brief Sets the time over which later amplitude changes ramp. Zero, the default, jumps.
+     */
+    void setRampTime(float seconds, SmoothingType type = SmoothingType::Linear) {
+        ramp_.setRampTime(seconds, sampleRate_, type);
+    }
+
+    void setAmplitude(float amplitude) {
+        if (amplitude < 0.0f) {
+            amplitude = 0.0f;
+        } else if (amplitude > 1.0f) {
+            amplitude = 1.0f;
+        }
+        ramp_.setTarget((int32_t)(amplitude * 32768.0f));
+        gain_ = (int32_t)ramp_.getValue();
+    }
+
+    void applyEvent(const ParameterEvent& event) {
+        if (event.type == ParameterEventType::Amplitude) {
+            setAmplitude(event.value.f);
+        }
+    }
+
+    void advance(uint64_t samples) {
+        ramp_.skip(samples);
+        gain_ = (int32_t)ramp_.getValue();
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t in) {
+        if (ramp_.isSmoothing()) {
+            gain_ = (int32_t)ramp_.next();
+        }
+        return (in * gain_) >> 15;
+    }
+
+private:
+    uint32_t sampleRate_ = 0;
+    SmoothedValue ramp_{32768};
+    int32_t gain_ = 32768;
+};
+
+/**
+ * @brief Adds a runtime DC offset to the signal.
+ *
+ * Handles `ParameterEventType::Offset` events, where 1.0 is full scale. After
+ * `setRampTime()`, changes ramp per sample instead of jumping. The quantizer
+ * saturates the sum.
+ */
+class Offset {
+public:
+    void initialize(uint32_t sampleRate) { sampleRate_ = sampleRate; }
+
+    /**
+     * @brief Sets the time over which later offset changes ramp. Zero, the default, jumps.
+     */
+    void setRampTime(float seconds, SmoothingType type = SmoothingType::Linear) {
+        ramp_.setRampTime(seconds, sampleRate_, type);
+    }
+
+    void setOffset(float offset) {
+        if (offset < -1.0f) {
+            offset = -1.0f;
+        } else if (offset > 1.0f) {
+            offset = 1.0f;
+        }
+        ramp_.setTarget((int32_t)(offset * 32768.0f));
+        offset_ = (int32_t)ramp_.getValue();
+    }
+
+    void applyEvent(const ParameterEvent& event) {
+        if (event.type == ParameterEventType::Offset) {
+            setOffset(event.value.f);
+        }
+    }
+
+    void advance(uint64_t samples) {
+        ramp_.skip(samples);
+        offset_ = (int32_t)ramp_.getValue();
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t in) {
+        if (ramp_.isSmoothing()) {
+            offset_ = (int32_t)ramp_.next();
+        }
+        return in + offset_;
+    }
+
+private:
+    uint32_t sampleRate_ = 0;
+    SmoothedValue ramp_;
+    int32_t offset_ = 0;
+};
+
+/**
+ * @brief Final stage: maps Q15 to an unsigned DAC code of `Bits` bits.
+ *
+ * The code is right-aligned in `Sample`, i.e. [0, 2^Bits - 1].
+ *
+ * @tparam Sample The sample type of the board.
+ * @tparam Bits The resolution of the DAC, at most 16.
+ */
+template <typename Sample, int Bits>
+class QuantizeUnsigned {
+public:
+    static_assert(Bits > 0 && Bits <= 16 && Bits <= (int)(8 * sizeof(Sample)),
+                  "Bits must fit into Sample and must not exceed 16");
+
+    static constexpr bool IS_QUANTIZER = true;
+    using sample_type = Sample;
+    static constexpr Sample MIDSCALE = (Sample)(1U << (Bits - 1));
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t in) {
+        if (in > 32767) {
+            in = 32767;
+        } else if (in < -32768) {
+            in = -32768;
+        }
+        return (in + 32768) >> (16 - Bits);
+    }
+};
+
+/// Maps Q15 to the 8-bit DAC of the ESP32.
+using Quantize8 = QuantizeUnsigned<uint8_t, 8>;
+/// Maps Q15 to a 12-bit DAC.
+using Quantize12 = QuantizeUnsigned<uint16_t, 12>;
+/// Maps Q15 to a 16-bit DAC.
+using Quantize16 = QuantizeUnsigned<uint16_t, 16>;
+
+/**
+ * @brief The sample type produced by the quantizer at the end of a stage list.
+ */
+template <typename... Stages>
+using pipeline_sample_t = typename std::tuple_element_t<sizeof...(Stages) - 1, std::tuple<Stages...>>::sample_type;
+
+/**
+ * @brief A WaveConfig composed from a compile-time list of stages.
+ *
+ * The stages are stored by value and invoked through a fold expression, so the
+ * compiler fuses them into a single loop without virtual calls or intermediate
+ * buffers. Example:
+ * @code
+ * using Wave = Pipeline<Oscillator<LUT<Sine, LUT_256>>,
+ *                       Modulator<LUT<Triangle, LUT_64>, 16384>,
+ *                       Envelope<1000, 1000>,
+ *                       Quantize8>;
+ * tinyalg::waveu::ESP32Waveu<Wave> waveu;
+ * @endcode
+ *
+ * The sample type is the `sample_type` of the quantizer, so ending with `Quantize16`
+ * makes a pipeline for a 16-bit board such as `HostConfig<uint16_t>`.
+ *
+ * @tparam Stages The processing stages, source first and quantizer last.
+ */
+template <typename... Stages>
+class Pipeline : public BasicWaveConfigInterface<pipeline_sample_t<Stages...>> {
+public:
+    using sample_type = pipeline_sample_t<Stages...>;
+
+    /// The DAC code of zero output, taken from the quantizer.
+    static constexpr sample_type MIDSCALE =
+        midscale_of_v<std::tuple_element_t<sizeof...(Stages) - 1, std::tuple<Stages...>>>;
+
+    static_assert(sizeof...(Stages) > 0, "Pipeline needs at least one stage");
+    static_assert(std::tuple_element_t<sizeof...(Stages) - 1, std::tuple<Stages...>>::IS_QUANTIZER,
+                  "The last stage of a Pipeline must be a quantizer such as Quantize8");
+
+    /**
+     * @brief Number of samples between two `beginBlock()` calls.
+     */
+    static constexpr size_t BLOCK_SIZE = 32;
+
+    void initialize(uint32_t sampleRate) override {
+        forEachStage([sampleRate](auto& stage) {
+            if constexpr (has_initialize<decltype(stage)>::value) {
+                stage.initialize(sampleRate);
+            }
+        });
+    }
+
+    void configure(const WaveConfigArgs& args) override {
+        forEachStage([this, &args](auto& stage) {
+            if constexpr (has_try_configure_v<std::remove_reference_t<decltype(stage)>>) {
+                Result result = stage.tryConfigure(args);
+                if (configureResult_ && !result) {
+                    configureResult_ = result;
+                }
+            } else if constexpr (has_configure<decltype(stage)>::value) {
+                stage.configure(args);
+            }
+        });
+    }
+
+    /**
+     * @brief Calls `configure()` and returns the first error a stage reported.
+     *
+     * Goes through `configure()`, so a subclass overriding it is still called.
+     */
+    Result tryConfigure(const WaveConfigArgs& args) override {
+        configureResult_ = ErrorCode::Ok;
+        configure(args);
+        return configureResult_;
+    }
+
+    void prepareCycle(double elapsedTime) override {}
+
+    /**
+     * @brief Forwards a parameter event to every stage that handles events.
+     */
+    void applyEvent(const ParameterEvent& event) {
+        forEachStage([&event](auto& stage) {
+            if constexpr (has_apply_event<decltype(stage)>::value) {
+                stage.applyEvent(event);
+            }
+        });
+    }
+
+    /**
+     * @brief Retrieves the frequency of the first stage that reports one.
+     */
+    template <bool Enable = (has_get_frequency_v<Stages> || ...), std::enable_if_t<Enable, int> = 0>
+    float getFrequency() {
+        float frequency = 0.0f;
+        bool found = false;
+        forEachStage([&frequency, &found](auto& stage) {
+            if constexpr (has_get_frequency_v<std::remove_reference_t<decltype(stage)>>) {
+                if (!found) {
+                    frequency = stage.getFrequency();
+                    found = true;
+                }
+            }
+        });
+        return frequency;
+    }
+
+    /**
+     * @brief Renders one sample, calling `beginBlock()` every `BLOCK_SIZE` samples.
+     */
+    sample_type nextSample() override {
+        if (blockRemaining_ == 0) {
+            beginBlock(BLOCK_SIZE);
+            blockRemaining_ = BLOCK_SIZE;
+        }
+        blockRemaining_--;
+        last_ = static_cast<sample_type>(processSample(std::index_sequence_for<Stages...>{}));
+        return last_;
+    }
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    sample_type nextSampleB() override {
+        return last_;
+    }
+#endif
+
+    void reset() override {
+        forEachStage([](auto& stage) {
+            if constexpr (has_reset<decltype(stage)>::value) {
+                stage.reset();
+            }
+        });
+        blockRemaining_ = 0;
+    }
+
+    /**
+     * @brief Jumps every stage that implements `advance()` ahead by `samples` samples.
+     *
+     * Stages without `advance()`, such as `Envelope`, keep their state.
+     */
+    void advance(uint64_t samples) {
+        forEachStage([samples](auto& stage) {
+            if constexpr (has_advance_v<std::remove_reference_t<decltype(stage)>>) {
+                stage.advance(samples);
+            }
+        });
+    }
+
+    /**
+     * @brief Renders `n` samples in sub-blocks of `BLOCK_SIZE`.
+     *
+     * @param out Destination buffer.
+     * @param n Number of samples to render.
+     */
+    void renderBlock(sample_type* out, size_t n) {
+        while (n > 0) {
+            size_t len = (n < BLOCK_SIZE) ? n : BLOCK_SIZE;
+            beginBlock(len);
+            for (size_t i = 0; i < len; ++i) {
+                out[i] = static_cast<sample_type>(processSample(std::index_sequence_for<Stages...>{}));
+            }
+            out += len;
+            n -= len;
+        }
+        // The next nextSample() begins a new block.
+        blockRemaining_ = 0;
+    }
+
+    /**
+     * @brief Accesses a stage, e.g. to change its parameters.
+     */
+    template <size_t I>
+    auto& stage() { return std::get<I>(stages_); }
+
+private:
+    template <typename T, typename = void>
+    struct has_initialize : std::false_type {};
+    template <typename T>
+    struct has_initialize<T, std::void_t<decltype(std::declval<T>().initialize(uint32_t{}))>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct has_configure : std::false_type {};
+    template <typename T>
+    struct has_configure<T, std::void_t<decltype(std::declval<T>().configure(std::declval<const WaveConfigArgs&>()))>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct has_begin_block : std::false_type {};
+    template <typename T>
+    struct has_begin_block<T, std::void_t<decltype(std::declval<T>().beginBlock(size_t{}))>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct has_apply_event : std::false_type {};
+    template <typename T>
+    struct has_apply_event<T, std::void_t<decltype(std::declval<T>().applyEvent(std::declval<const ParameterEvent&>()))>> : std::true_type {};
+
+    template <typename T, typename = void>
+    struct has_reset : std::false_type {};
+    template <typename T>
+    struct has_reset<T, std::void_t<decltype(std::declval<T>().reset())>> : std::true_type {};
+
+    template <typename F>
+    void forEachStage(F&& f) {
+        std::apply([&f](auto&... stage) { (f(stage), ...); }, stages_);
+    }
+
+    void beginBlock(size_t n) {
+        forEachStage([n](auto& stage) {
+            if constexpr (has_begin_block<decltype(stage)>::value) {
+                stage.beginBlock(n);
+            }
+        });
+    }
+
+    template <size_t... Is>
+    WAVEU_ALWAYS_INLINE int32_t processSample(std::index_sequence<Is...>) {
+        int32_t x = 0;
+        ((x = std::get<Is>(stages_).process(x)), ...);
+        return x;
+    }
+
+    std::tuple<Stages...> stages_;
+    sample_type last_ = 0;
+    size_t blockRemaining_ = 0;     // Samples left in the block begun by nextSample()
+    Result configureResult_;        // First error of a stage in the last configure()
+};
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstdint>
+#include "sdkconfig.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Pipeline stages that can be bracketed by the profiler.
+ */
+enum class ProfileStage : uint8_t {
+    PrepareCycle,   ///< `WaveConfig::prepareCycle()` once per buffer
+    Render,         ///< Filling one complete ping/pong buffer
+    PhaseStep,      ///< Advancing a phase accumulator over a block with `PhaseGenerator::fillPhases()`
+    IndexCompute,   ///< Mapping a phase to a table index in `LUT::lookup()`, sampled
+    LutFetch,       ///< Reading a value from the table in `LUT::lookup()`, sampled
+    BufferWrite,    ///< Storing a sample into the ping/pong buffer, sampled
+    ProducerWait,   ///< Producer waiting for a buffer semaphore
+    ConsumerWait,   ///< Consumer waiting for a buffer semaphore
+    QueueLatency,   ///< Timer callback to producer wake-up, in microseconds
+    DacWrite,       ///< `dac_continuous_write()` of one buffer
+    StartOutput,    ///< `BoardConfig::startTimer()`, the latency of `Waveu::start()` after the command is picked up
+    StopOutput,     ///< `BoardConfig::stopTimer()`, the latency of `Waveu::stop()` after the command is picked up
+    Count
+};
+
+#ifdef CONFIG_WAVEU_PROFILER
+
+/**
+ * @brief Cycle-accurate per-stage profiler.
+ *
+ * Every stage keeps a sample count, the total and maximum number of cycles and a
+ * log2 histogram. Statistics are kept in one slot per core and per stage. A slot is
+ * only written by the core it belongs to, so no locks or atomic read-modify-write
+ * operations are needed as long as a stage is bracketed from a single task per core.
+ *
+ * Stages executed once per sample are bracketed with `WAVEU_PROFILE_SAMPLED_SCOPE`,
+ * which only measures every `CONFIG_WAVEU_PROFILER_SAMPLE_INTERVAL`th call. Reading
+ * the cycle counter around every sample would take longer than the stage itself.
+ *
+ * Use the `WAVEU_PROFILE_*` macros rather than calling this class directly so that
+ * the instrumentation compiles to nothing when `CONFIG_WAVEU_PROFILER` is disabled.
+ */
+class Profiler {
+public:
+    static const char* TAG;
+
+    /**
+     * @brief Number of log2 histogram bins.
+     *
+     * Bin `n` counts durations in [2^n, 2^(n+1)) cycles. The last bin also collects
+     * everything above its lower bound. Bins saturate instead of wrapping around.
+     */
+    static constexpr int NUM_HISTOGRAM_BINS = 24;
+
+    /// Calls of a sampled stage per measurement.
+    static constexpr uint32_t SAMPLE_INTERVAL = CONFIG_WAVEU_PROFILER_SAMPLE_INTERVAL;
+
+    /**
+     * @brief Accumulated statistics of one stage on one core.
+     *
+     * Durations are in cycles, except for `QueueLatency`, which is measured in
+     * microseconds (see `markQueueSend()`).
+     */
+    struct StageStats {
+        uint64_t count;
+        uint64_t totalCycles;
+        uint32_t maxCycles;
+        uint32_t histogram[NUM_HISTOGRAM_BINS];
+    };
+
+    /**
+     * @brief Adds one measurement to the slot of the calling core.
+     *
+     * @param stage The stage the measurement belongs to.
+     * @param cycles The duration of the stage in cycles.
+     */
+    static void record(ProfileStage stage, uint32_t cycles);
+
+    /**
+     * @brief Stamps the moment the timer callback hands a message to the producer.
+     *
+     * The timer task and the producer may run on different cores, so the stamp is
+     * taken with a microsecond clock that is consistent across cores.
+     */
+    static void markQueueSend();
+
+    /**
+     * @brief Records the latency since the last `markQueueSend()` as `QueueLatency`,
+     *        in microseconds.
+     */
+    static void recordQueueReceive();
+
+    /**
+     * @brief Copies the statistics of a stage on the given core.
+     *
+     * @param stage The stage to read.
+     * @param core The core to read.
+     * @return A snapshot of the statistics. Values may be torn if the stage is updated concurrently.
+     */
+    static StageStats snapshot(ProfileStage stage, int core);
+
+    /**
+     * @brief Logs the statistics of all stages that have been measured at least once.
+     */
+    static void dump();
+
+    /**
+     * @brief Clears all statistics.
+     *
+     * Call this only while the waveform generator is stopped.
+     */
+    static void clear();
+
+    /**
+     * @brief Returns a printable name of a stage.
+     */
+    static const char* toString(ProfileStage stage);
+
+    /**
+     * @brief Returns the unit of the durations of a stage, "cyc" or "us".
+     */
+    static const char* unitOf(ProfileStage stage);
+};
+
+/**
+ * @brief RAII helper that records the cycles spent in its scope.
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileStage stage_;
+    uint32_t start_;
+};
+
+/**
+ * @brief RAII helper that records the cycles spent in its scope on every
+ *        `Profiler::SAMPLE_INTERVAL`th call.
+ */
+class SampledProfileScope {
+public:
+    SampledProfileScope(ProfileStage stage, uint32_t& calls);
+    ~SampledProfileScope();
+
+    SampledProfileScope(const SampledProfileScope&) = delete;
+    SampledProfileScope& operator=(const SampledProfileScope&) = delete;
+
+private:
+    ProfileStage stage_;
+    bool active_;
+    uint32_t start_ = 0;
+};
+
+#define WAVEU_PROFILE_CONCAT_(a, b) a##b
+#define WAVEU_PROFILE_CONCAT(a, b) WAVEU_PROFILE_CONCAT_(a, b)
+#define WAVEU_PROFILE_SCOPE(stage) \
+    tinyalg::waveu::ProfileScope WAVEU_PROFILE_CONCAT(_waveu_profile_scope_, __LINE__)(stage)
+// The call counter is shared by all callers of the enclosing function, which is fine
+// for code that only runs in the producer task.
+#define WAVEU_PROFILE_SAMPLED_SCOPE(stage) \
+    static uint32_t WAVEU_PROFILE_CONCAT(_waveu_profile_calls_, __LINE__) = 0; \
+    tinyalg::waveu::SampledProfileScope WAVEU_PROFILE_CONCAT(_waveu_profile_scope_, __LINE__)( \
+        stage, WAVEU_PROFILE_CONCAT(_waveu_profile_calls_, __LINE__))
+#define WAVEU_PROFILE_QUEUE_SEND() tinyalg::waveu::Profiler::markQueueSend()
+#define WAVEU_PROFILE_QUEUE_RECEIVE() tinyalg::waveu::Profiler::recordQueueReceive()
+#define WAVEU_PROFILE_DUMP() tinyalg::waveu::Profiler::dump()
+
+#else
+
+#define WAVEU_PROFILE_SCOPE(stage) ((void)0) // No-op
+#define WAVEU_PROFILE_SAMPLED_SCOPE(stage) ((void)0) // No-op
+#define WAVEU_PROFILE_QUEUE_SEND() ((void)0) // No-op
+#define WAVEU_PROFILE_QUEUE_RECEIVE() ((void)0) // No-op
+#define WAVEU_PROFILE_DUMP() ((void)0) // No-op
+
+#endif // CONFIG_WAVEU_PROFILER
+
+} // namespace tinyalg::waveu
+
+#ifdef CONFIG_WAVEU_PROFILER
+#include "CycleCounter.h"
+
+namespace tinyalg::waveu {
+
+inline ProfileScope::ProfileScope(ProfileStage stage)
+    : stage_(stage), start_(CycleCounter::now()) {}
+
+inline ProfileScope::~ProfileScope() {
+    Profiler::record(stage_, CycleCounter::now() - start_);
+}
+
+inline SampledProfileScope::SampledProfileScope(ProfileStage stage, uint32_t& calls)
+    : stage_(stage), active_(++calls >= Profiler::SAMPLE_INTERVAL) {
+    if (active_) {
+        calls = 0;
+        start_ = CycleCounter::now();
+    }
+}
+
+inline SampledProfileScope::~SampledProfileScope() {
+    if (active_) {
+        Profiler::record(stage_, CycleCounter::now() - start_);
+    }
+}
+
+} // namespace tinyalg::waveu
+#endif // CONFIG_WAVEU_PROFILER
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief A 64-bit counter written by one task and read by any task or ISR.
+ *
+ * `std::atomic<uint64_t>` is not lock-free on Xtensa, so the value is kept in two
+ * slots of 32-bit halves. The writer fills the slot not in use and then flips the
+ * slot counter; a reader retries only if the counter moved while it was reading.
+ * A reader that interrupts the writer reads the previous value, which stays intact,
+ * so reads never spin on a writer that cannot run.
+ */
+class PublishedIndex {
+public:
+    /**
+     * @brief Publishes a new value. Call this from the owning task only.
+     */
+    void store(uint64_t value) {
+        const uint32_t next = version_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[next & 1];
+        slot.low.store((uint32_t)value, std::memory_order_relaxed);
+        slot.high.store((uint32_t)(value >> 32), std::memory_order_relaxed);
+        version_.store(next, std::memory_order_release);
+    }
+
+    /**
+     * @brief Reads the value last published. Safe to call from any task or ISR.
+     */
+    uint64_t load() const {
+        for (;;) {
+            const uint32_t version = version_.load(std::memory_order_acquire);
+            const Slot& slot = slots_[version & 1];
+            const uint32_t low = slot.low.load(std::memory_order_relaxed);
+            const uint32_t high = slot.high.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The writer only overwrites this slot after publishing the other one.
+            if (version_.load(std::memory_order_relaxed) == version) {
+                return ((uint64_t)high << 32) | low;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> low{0};
+        std::atomic<uint32_t> high{0};
+    };
+
+    Slot slots_[2];
+    std::atomic<uint32_t> version_{0};
+};
+
+} // namespace tinyalg::waveu
@@ -4,4 +4,5 @@
 namespace tinyalg::waveu {
     extern QueueHandle_t dataGenerationQueue;
     extern QueueHandle_t dataOutputQueue;
+    extern QueueSetHandle_t producerQueueSet;   // dataGenerationQueue and commandSemaphore
 } // namespace tinyalg::waveu
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "DataTypes.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief File formats written by the recorder.
+ */
+enum class RecorderFormat : uint8_t {
+    /**
+     * 8-bit unsigned PCM WAV, one channel in simultaneous mode and two interleaved
+     * channels in alternate mode. Dropped buffers leave gaps that are not visible in
+     * the file; they are logged with their sample index.
+     */
+    Wav,
+    /**
+     * A sequence of records, each a `RecorderTap::RecordHeader` followed by
+     * `length` bytes exactly as sent to the DAC. Gaps from dropped buffers can be
+     * found by comparing `sampleIndex` with the end of the previous record.
+     */
+    Raw,
+};
+
+/**
+ * @brief Recorder statistics.
+ */
+struct RecorderStats {
+    /// Buffers copied into the ring.
+    uint32_t capturedBuffers;
+    /// Buffers dropped because the ring was full. Buffers output while the recorder is
+    /// not running are neither captured nor counted.
+    uint32_t droppedBuffers;
+    /// Samples (frames in alternate mode) in the dropped buffers.
+    uint64_t droppedSamples;
+    /// Bytes written to the output file, headers included.
+    uint64_t writtenBytes;
+};
+
+#ifdef CONFIG_WAVEU_RECORDER
+
+/**
+ * @brief Captures the buffers handed to the DAC for post-mortem analysis.
+ *
+ * The consumer task copies every buffer it has written to the DAC into a
+ * single-producer, single-consumer byte ring with `capture()`. A low-priority drain
+ * task moves the ring contents into a `FILE*`, which can be a file on a SPIFFS/FAT
+ * partition or SD card on the target, or a regular file on the host.
+ *
+ * `capture()` never blocks: when a whole buffer does not fit into the ring, it is
+ * dropped and counted. Its cost is bounded by one `memcpy()` of a buffer plus a task
+ * notification.
+ *
+ * Use the `WAVEU_RECORDER_*` macros in the pipeline so that the hooks compile to
+ * nothing when `CONFIG_WAVEU_RECORDER` is disabled.
+ */
+class RecorderTap {
+public:
+    static const char* TAG;
+
+    /// Size of the capture ring in bytes.
+    static constexpr size_t RING_SIZE = CONFIG_WAVEU_RECORDER_RING_SIZE;
+
+    /**
+     * @brief Header preceding every buffer in the ring and in `RecorderFormat::Raw` files.
+     */
+    struct RecordHeader {
+        /// Index of the first sample (frame in alternate mode) of the buffer, counted from the last `Waveu::reset()`.
+        uint64_t sampleIndex;
+        /// Number of bytes following the header.
+        uint32_t length;
+        /// Number of interleaved channels, 1 or 2.
+        uint32_t channels;
+    };
+
+    /**
+     * @brief Starts the drain task and begins recording.
+     *
+     * @param out An open, writable file. It stays owned by the caller but must not be
+     *            closed before `stop()` returns.
+     * @param format The file format to write.
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already recording,
+     *         ESP_ERR_INVALID_ARG if `out` is null, ESP_ERR_INVALID_SIZE if `RING_SIZE`
+     *         cannot hold one buffer and its header, ESP_ERR_NO_MEM if the task could
+     *         not be created.
+     */
+    static esp_err_t start(FILE* out, RecorderFormat format);
+
+    /**
+     * @brief Stops recording, drains the ring and finalizes the file.
+     *
+     * Waits for a `capture()` in progress to finish, then blocks until the drain task
+     * has written everything that was captured and deletes it. For WAV files the
+     * header is patched with the final length if the file is seekable.
+     *
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not recording.
+     */
+    static esp_err_t stop();
+
+    /**
+     * @brief Copies a buffer into the ring. Called by the consumer task.
+     *
+     * Never blocks. Buffers that do not fit are dropped and counted.
+     *
+     * @param data The buffer as written to the DAC.
+     * @param len The length of the buffer in bytes.
+     */
+    static void capture(const data_buf_type_t* data, size_t len);
+
+    /**
+     * @brief Restarts the sample index of captured buffers at zero.
+     */
+    static void resetSampleIndex();
+
+    /**
+     * @brief Writes everything currently in the ring to the output file.
+     *
+     * Called by the drain task. May be called directly while recording to drain
+     * synchronously, e.g. on a host without a scheduler, but never concurrently with
+     * the drain task.
+     *
+     * @return The number of bytes written.
+     */
+    static size_t drain();
+
+    /**
+     * @brief Retrieves the recorder statistics.
+     */
+    static RecorderStats stats();
+
+    /**
+     * @brief Checks whether the recorder is running.
+     */
+    static bool isRecording();
+};
+
+#define WAVEU_RECORDER_CAPTURE(data, len) tinyalg::waveu::RecorderTap::capture((data), (len))
+#define WAVEU_RECORDER_RESET() tinyalg::waveu::RecorderTap::resetSampleIndex()
+
+#else
+
+#define WAVEU_RECORDER_CAPTURE(data, len) ((void)0) // No-op
+#define WAVEU_RECORDER_RESET() ((void)0) // No-op
+
+#endif // CONFIG_WAVEU_RECORDER
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Error codes returned by the exception-free API.
+ */
+enum class ErrorCode : uint8_t {
+    Ok,
+    InvalidState,       ///< Not allowed in the current state of the generator.
+    QueueFull,          ///< The command queue was full.
+    InvalidArgument,    ///< An argument is out of range or unsupported.
+    NoPeriod,           ///< No buffer length holds the requested frequency exactly enough.
+    Pending,            ///< The command has not been executed yet.
+    NoMemory,           ///< A memory allocation failed.
+};
+
+/**
+ * @brief Outcome of an operation of the exception-free API.
+ *
+ * A single byte that can be returned and copied freely. Converts to `true` on success.
+ */
+class Result {
+public:
+    constexpr Result() = default;
+    constexpr Result(ErrorCode error) : error_(error) {}
+
+    constexpr bool ok() const { return error_ == ErrorCode::Ok; }
+    constexpr explicit operator bool() const { return ok(); }
+    constexpr ErrorCode error() const { return error_; }
+
+    constexpr bool operator==(ErrorCode error) const { return error_ == error; }
+    constexpr bool operator!=(ErrorCode error) const { return error_ != error; }
+
+    /**
+     * @brief A constant string naming the error code.
+     */
+    const char* toString() const { return toString(error_); }
+
+    static const char* toString(ErrorCode error) {
+        switch (error) {
+            case ErrorCode::Ok: return "Ok";
+            case ErrorCode::InvalidState: return "InvalidState";
+            case ErrorCode::QueueFull: return "QueueFull";
+            case ErrorCode::InvalidArgument: return "InvalidArgument";
+            case ErrorCode::NoPeriod: return "NoPeriod";
+            case ErrorCode::Pending: return "Pending";
+            case ErrorCode::NoMemory: return "NoMemory";
+            default: return "Unknown";
+        }
+    }
+
+private:
+    ErrorCode error_ = ErrorCode::Ok;
+};
+
+} // namespace tinyalg::waveu
+
+/**
+ * @brief Throws an exception, or aborts when built with `-fno-exceptions`.
+ *
+ * Used by the throwing API, which stays available in both build modes. With exceptions
+ * disabled a failure is fatal, like `ESP_ERROR_CHECK()`; use the `try...()` variants
+ * returning a `Result` to handle it.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define WAVEU_EXCEPTIONS 1
+#define WAVEU_THROW(exception) throw exception
+#else
+#define WAVEU_EXCEPTIONS 0
+#define WAVEU_THROW(exception) std::abort()
+#endif
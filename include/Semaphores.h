@@ -9,4 +9,6 @@ extern SemaphoreHandle_t pingBufferSemaphore;
 
 extern SemaphoreHandle_t pongBufferSemaphore;
 
+extern SemaphoreHandle_t commandSemaphore;
+
 }
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief How a `SmoothedValue` approaches its target.
+ */
+enum class SmoothingType : uint8_t {
+    Linear,     ///< A straight line that reaches the target after the ramp time.
+    OnePole,    ///< An exponential approach that is within 1% of the target after the ramp time.
+};
+
+/**
+ * @brief A parameter that moves to a new target over a ramp time instead of jumping.
+ *
+ * Stages use it to ramp gains, offsets and phase increments per sample, which avoids the
+ * clicks and zipper noise of parameter changes at buffer boundaries. Values are integers
+ * in the unit of the parameter, e.g. Q15 for a gain or a phase increment, and are kept
+ * with 16 fractional bits in 64-bit fixed point, so no floating point is used per sample.
+ *
+ * Once the target is reached, `isSmoothing()` turns false and a stage does not call
+ * `next()` anymore, so a steady parameter costs one predictable branch per sample:
+ * @code
+ * WAVEU_ALWAYS_INLINE int32_t process(int32_t in) {
+ *     if (gain_.isSmoothing()) {
+ *         value_ = (int32_t)gain_.next();
+ *     }
+ *     return (in * value_) >> 15;
+ * }
+ * @endcode
+ *
+ * With a ramp time of zero, which is the default, `setTarget()` jumps immediately.
+ */
+class SmoothedValue {
+public:
+    /**
+     * @brief Starts at `value` without a ramp.
+     */
+    explicit SmoothedValue(int64_t value = 0) { setValue(value); }
+
+    /**
+     * @brief Sets the ramp length in samples and the shape of later ramps.
+     *
+     * A ramp in progress keeps its course.
+     *
+     * @param samples The ramp length; 0 makes `setTarget()` jump.
+     * @param type The shape of the ramp.
+     */
+    void setRamp(uint32_t samples, SmoothingType type = SmoothingType::Linear) {
+        rampSamples_ = samples;
+        type_ = type;
+        if (type == SmoothingType::OnePole && samples > 0) {
+            // Time constant of ramp / ln(100), so that 99% of the step is done after the ramp.
+            const double k = 1.0 - std::exp(-std::log(100.0) / (double)samples);
+            coefficient_ = (int64_t)std::lround(k * ONE);
+            if (coefficient_ < 1) {
+                coefficient_ = 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Sets the ramp length from a time and a sample rate.
+     */
+    void setRampTime(float seconds, uint32_t sampleRate, SmoothingType type = SmoothingType::Linear) {
+        setRamp((seconds > 0.0f) ? (uint32_t)std::lround((double)seconds * sampleRate) : 0, type);
+    }
+
+    uint32_t getRampSamples() const { return rampSamples_; }
+
+    /**
+     * @brief Starts a ramp from the current value to `target`.
+     */
+    void setTarget(int64_t target) {
+        target_ = target * ONE;
+        if (rampSamples_ == 0 || target_ == value_) {
+            setValue(target);
+            return;
+        }
+        if (type_ == SmoothingType::Linear) {
+            step_ = (target_ - value_) / (int64_t)rampSamples_;
+            remaining_ = rampSamples_;
+        } else {
+            remaining_ = 1;
+        }
+    }
+
+    /**
+     * @brief Jumps to `value`, ending any ramp.
+     */
+    void setValue(int64_t value) {
+        value_ = value * ONE;
+        target_ = value_;
+        remaining_ = 0;
+    }
+
+    int64_t getValue() const { return value_ >> FRAC_BITS; }
+
+    int64_t getTarget() const { return target_ >> FRAC_BITS; }
+
+    /**
+     * @brief Whether the value is still moving towards the target.
+     */
+    bool isSmoothing() const { return remaining_ != 0; }
+
+    /**
+     * @brief Moves the value by one sample and returns it.
+     */
+    int64_t next() {
+        if (type_ == SmoothingType::Linear) {
+            value_ += step_;
+            if (--remaining_ == 0) {
+                value_ = target_;
+            }
+        } else {
+            const int64_t diff = target_ - value_;
+            if (diff < ONE && diff > -ONE) {
+                // Closer than one unit: done.
+                value_ = target_;
+                remaining_ = 0;
+            } else {
+                value_ += (diff >> FRAC_BITS) * coefficient_;
+            }
+        }
+        return value_ >> FRAC_BITS;
+    }
+
+    /**
+     * @brief Moves the value by `samples` samples at once, e.g. for `advance()`.
+     *
+     * Linear ramps end up exactly where `samples` calls of `next()` would. One-pole ramps
+     * use the closed form, which differs from the integer steps of `next()` by a few units.
+     */
+    void skip(uint64_t samples) {
+        if (remaining_ == 0 || samples == 0) {
+            return;
+        }
+        if (type_ == SmoothingType::Linear) {
+            if (samples >= remaining_) {
+                value_ = target_;
+                remaining_ = 0;
+            } else {
+                value_ += step_ * (int64_t)samples;
+                remaining_ -= (uint32_t)samples;
+            }
+        } else {
+            const double left = std::pow(1.0 - (double)coefficient_ / ONE, (double)samples);
+            value_ = target_ - (int64_t)((double)(target_ - value_) * left);
+            // The same completion check as next(), without moving another sample.
+            const int64_t diff = target_ - value_;
+            if (diff < ONE && diff > -ONE) {
+                value_ = target_;
+                remaining_ = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr int FRAC_BITS = 16;
+    static constexpr int64_t ONE = (int64_t)1 << FRAC_BITS;
+
+    int64_t value_ = 0;         // Current value with FRAC_BITS fractional bits
+    int64_t target_ = 0;
+    int64_t step_ = 0;          // Linear: change per sample
+    int64_t coefficient_ = ONE; // One-pole: fraction of the distance covered per sample
+    uint32_t remaining_ = 0;    // Linear: samples left; one-pole: non-zero while moving
+    uint32_t rampSamples_ = 0;
+    SmoothingType type_ = SmoothingType::Linear;
+};
+
+} // namespace tinyalg::waveu
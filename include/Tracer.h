@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Events recorded by the tracer.
+ *
+ * Every event belongs to the track of the task that records it: the timer, the
+ * producer or the consumer. Spans are recorded as a begin and an end event, the
+ * others as instants.
+ */
+enum class TraceEvent : uint8_t {
+    TimerTick,              ///< Instant: a timer period begins. The argument is the period number.
+    OutputQueueSend,        ///< Instant: a buffer is handed to the consumer. The argument is 1 for ping.
+    OutputDropped,          ///< Instant: `dataOutputQueue` was full.
+    GenerationQueueSend,    ///< Instant: a buffer is requested from the producer. The argument is 1 for ping.
+    RequestDropped,         ///< Instant: `dataGenerationQueue` was full.
+    GenerationQueueReceive, ///< Instant: the producer picks up a request. The argument is 1 for ping.
+    ProducerWait,           ///< Span: the producer waits for a buffer semaphore. The argument is 1 for ping.
+    PrepareCycle,           ///< Span: `WaveConfig::prepareCycle()`.
+    Render,                 ///< Span: a buffer is rendered. The argument is 1 for ping.
+    Substitute,             ///< Instant: an overdue buffer is replaced by the overload policy. The argument is 1 for ping.
+    OutputQueueReceive,     ///< Instant: the consumer picks up a buffer. The argument is 1 for ping.
+    ConsumerWait,           ///< Span: the consumer waits for a buffer semaphore. The argument is 1 for ping.
+    DacWrite,               ///< Span: a buffer is written to the DAC or the sink. The argument is 1 for ping.
+    StartOutput,            ///< Span: `BoardConfig::startTimer()`.
+    StopOutput,             ///< Span: `BoardConfig::stopTimer()`.
+    Count
+};
+
+/**
+ * @brief Whether a record begins or ends a span, or is an instant.
+ */
+enum class TracePhase : uint8_t {
+    Begin,
+    End,
+    Instant,
+};
+
+/**
+ * @brief Tracer statistics.
+ */
+struct TraceStats {
+    /// Events recorded on all cores since the last `Tracer::clear()`.
+    uint32_t recordedEvents;
+    /// Events overwritten by newer ones before they were exported.
+    uint32_t overwrittenEvents;
+};
+
+#ifdef CONFIG_WAVEU_TRACE
+
+/**
+ * @brief Software event tracer with Chrome trace export.
+ *
+ * A timeline of timer ticks, queue hand-overs, semaphore waits, renders and DAC writes
+ * that needs neither a free GPIO nor a scope. Every event is stamped with the cycle
+ * counter of the calling core and stored into the ring of that core. A writer reserves
+ * its slot with a single atomic increment, so tasks preempting each other on a core
+ * never block or lock. When a ring is full the oldest events are overwritten, so the
+ * rings always hold the most recent history.
+ *
+ * Every `ANCHOR_INTERVAL` events a ring also stores the microsecond clock next to the
+ * cycle count. The cycle counters of the cores are not synchronized and wrap around
+ * within seconds; the anchors put the events of all cores on one time base on export.
+ *
+ * `exportChromeTrace()` writes the Trace Event Format read by Perfetto
+ * (https://ui.perfetto.dev) and `chrome://tracing`.
+ * @code
+ * Tracer::clear();
+ * Tracer::start();
+ * waveu.start();
+ * vTaskDelay(pdMS_TO_TICKS(500));
+ * Tracer::stop();
+ * FILE* f = fopen("/spiffs/trace.json", "w");
+ * Tracer::exportChromeTrace(f);
+ * fclose(f);
+ * @endcode
+ *
+ * Use the `WAVEU_TRACE_*` macros rather than calling this class directly so that the
+ * instrumentation compiles to nothing when `CONFIG_WAVEU_TRACE` is disabled.
+ */
+class Tracer {
+public:
+    static const char* TAG;
+
+    /// Events held per core.
+    static constexpr uint32_t RING_EVENTS = CONFIG_WAVEU_TRACE_RING_EVENTS;
+
+    /// Events between two anchors of the microsecond clock.
+    static constexpr uint32_t ANCHOR_INTERVAL = 256;
+
+    /**
+     * @brief Records one event on the calling core if tracing is running.
+     *
+     * @param event The event.
+     * @param phase Whether the event begins or ends a span, or is an instant.
+     * @param arg The argument of the event, see `TraceEvent`.
+     */
+    static void record(TraceEvent event, TracePhase phase, uint16_t arg);
+
+    /**
+     * @brief Starts recording. Events already in the rings are kept.
+     */
+    static void start();
+
+    /**
+     * @brief Stops recording and waits until the events being recorded meanwhile are written.
+     *
+     * Once it returns, the rings no longer change, so they can be exported or cleared.
+     * Call it from a task, not from an ISR.
+     */
+    static void stop();
+
+    /**
+     * @brief Checks whether the tracer is recording.
+     */
+    static bool isTracing();
+
+    /**
+     * @brief Discards all events. Call this only while the tracer is stopped.
+     */
+    static void clear();
+
+    /**
+     * @brief Retrieves the tracer statistics.
+     */
+    static TraceStats stats();
+
+    /**
+     * @brief The memory taken by the rings of all cores in bytes.
+     */
+    static size_t memoryBytes();
+
+    /**
+     * @brief Writes the events of all cores as a Chrome trace JSON document.
+     *
+     * The timer, the producer and the consumer appear as threads of one process; the
+     * core of every event is in its arguments. Timestamps start at 0 with the oldest
+     * event. Call this while the tracer is stopped, otherwise the events being written
+     * meanwhile may be torn.
+     *
+     * @param out The file to write to, e.g. `stdout` or a file on a SPIFFS/FAT partition.
+     * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `out` is null, or ESP_FAIL if
+     *         writing failed.
+     */
+    static esp_err_t exportChromeTrace(FILE* out);
+
+    /**
+     * @brief Returns a printable name of an event.
+     */
+    static const char* toString(TraceEvent event);
+};
+
+/**
+ * @brief RAII helper that records a span over its scope.
+ */
+class TraceScope {
+public:
+    TraceScope(TraceEvent event, uint16_t arg) : event_(event), arg_(arg) {
+        Tracer::record(event_, TracePhase::Begin, arg_);
+    }
+
+    ~TraceScope() {
+        Tracer::record(event_, TracePhase::End, arg_);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceEvent event_;
+    uint16_t arg_;
+};
+
+#define WAVEU_TRACE_CONCAT_(a, b) a##b
+#define WAVEU_TRACE_CONCAT(a, b) WAVEU_TRACE_CONCAT_(a, b)
+#define WAVEU_TRACE_SCOPE(event, arg) \
+    tinyalg::waveu::TraceScope WAVEU_TRACE_CONCAT(_waveu_trace_scope_, __LINE__)((event), (uint16_t)(arg))
+#define WAVEU_TRACE_INSTANT(event, arg) \
+    tinyalg::waveu::Tracer::record((event), tinyalg::waveu::TracePhase::Instant, (uint16_t)(arg))
+
+#else
+
+#define WAVEU_TRACE_SCOPE(event, arg) ((void)0) // No-op
+#define WAVEU_TRACE_INSTANT(event, arg) ((void)0) // No-op
+
+#endif // CONFIG_WAVEU_TRACE
+
+} // namespace tinyalg::waveu
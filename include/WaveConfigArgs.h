@@ -2,10 +2,63 @@
 
 namespace tinyalg::waveu {
 
+/**
+ * @brief Identifies a `WaveConfigArgs` type without RTTI.
+ */
+using WaveConfigArgsTypeId = const void*;
+
+/**
+ * @brief Returns the unique type id of `T`: the address of a variable instantiated once per type.
+ */
+template <typename T>
+WaveConfigArgsTypeId waveConfigArgsTypeId() {
+    static const char id = 0;
+    return &id;
+}
+
 // Base class for WaveConfig setter arguments
 class WaveConfigArgs {
 public:
     virtual ~WaveConfigArgs() = default;
+
+    /**
+     * @brief The type id of the most derived class, or nullptr for untyped arguments.
+     *
+     * Derive from `TypedWaveConfigArgs` to provide it.
+     */
+    virtual WaveConfigArgsTypeId typeId() const { return nullptr; }
+
+    /**
+     * @brief Checks whether the arguments are exactly of type `T`.
+     */
+    template <typename T>
+    bool is() const { return typeId() == waveConfigArgsTypeId<T>(); }
+
+    /**
+     * @brief Downcasts to `T` without RTTI.
+     *
+     * A replacement for `dynamic_cast<const T*>(&args)` that builds with `-fno-rtti`.
+     * Unlike `dynamic_cast`, it only matches the exact type, not classes derived from `T`.
+     *
+     * @return The arguments as `T`, or nullptr if they are of another type.
+     */
+    template <typename T>
+    const T* as() const { return is<T>() ? static_cast<const T*>(this) : nullptr; }
+};
+
+/**
+ * @brief Base class for arguments that can be recognized with `WaveConfigArgs::as()`.
+ *
+ * @code
+ * class UserWaveArgs : public TypedWaveConfigArgs<UserWaveArgs> { ... };
+ * @endcode
+ *
+ * @tparam Derived The class deriving from it.
+ */
+template <typename Derived>
+class TypedWaveConfigArgs : public WaveConfigArgs {
+public:
+    WaveConfigArgsTypeId typeId() const override { return waveConfigArgsTypeId<Derived>(); }
 };
 
 }
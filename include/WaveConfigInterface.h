@@ -1,26 +1,37 @@
 #pragma once
 
+#include <cstdint>
+#include "Result.h"
 #include "WaveConfigArgs.h"
 
 namespace tinyalg::waveu {
 
 /**
- * @class WaveConfigInterface
+ * @class BasicWaveConfigInterface
  * @brief Interface for configuring and managing waveform generation.
  * 
  * This interface defines the required methods for configuring waveform
  * parameters, initializing resources, generating samples, and managing
  * the waveform's lifecycle.
+ * 
+ * @tparam Sample The sample type of the board, `BoardConfig::sample_type`.
+ *                Use `WaveConfigInterface` for the 8-bit DAC of the ESP32.
  */
-class WaveConfigInterface {
+template <typename Sample>
+class BasicWaveConfigInterface {
 public:
+    /**
+     * @brief The type of the samples returned by `nextSample()`.
+     */
+    using sample_type = Sample;
+
     /**
      * @brief Virtual destructor.
      * 
      * Ensures proper cleanup of derived class objects when deleted through
-     * a `WaveConfigInterface` pointer.
+     * a `BasicWaveConfigInterface` pointer.
      */
-    virtual ~WaveConfigInterface() = default;
+    virtual ~BasicWaveConfigInterface() = default;
 
     /**
      * @brief Configures waveform parameters.
@@ -33,6 +44,21 @@ public:
      */
     virtual void configure(const tinyalg::waveu::WaveConfigArgs& args) = 0;
 
+    /**
+     * @brief Configures waveform parameters and reports whether they were accepted.
+     * 
+     * `Waveu` calls this method instead of `configure()`. The default calls `configure()`
+     * and reports success. Override it to reject arguments without exceptions.
+     * 
+     * @param args The configuration arguments for the waveform.
+     * @return `ErrorCode::Ok`, or the error that `Waveu::tryConfigure()` returns,
+     *         e.g. `ErrorCode::InvalidArgument` or `ErrorCode::NoMemory`.
+     */
+    virtual Result tryConfigure(const tinyalg::waveu::WaveConfigArgs& args) {
+        configure(args);
+        return ErrorCode::Ok;
+    }
+
     /**
      * @brief Initializes the waveform generator.
      * 
@@ -48,24 +74,24 @@ public:
      * @brief Retrieves the next sample of the waveform.
      * 
      * This method is called to generate and return the next sample value
-     * of the waveform. The value is typically normalized to fit within
-     * 8 bits.
+     * of the waveform. The value is normalized to the code range of the DAC,
+     * e.g. 8 bits for the ESP32.
      * 
-     * @return The next waveform sample as an 8-bit unsigned integer.
+     * @return The next waveform sample as a DAC code.
      */
-    virtual uint8_t nextSample() = 0;
+    virtual Sample nextSample() = 0;
 
 #ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
     /**
      * @brief Retrieves the next sample of the waveform.
      * 
      * This method is called to generate and return the next sample value
-     * of the waveform. The value is typically normalized to fit within
-     * 8 bits.
+     * of the waveform. The value is normalized to the code range of the DAC,
+     * e.g. 8 bits for the ESP32.
      * 
-     * @return The next waveform sample as an 8-bit unsigned integer.
+     * @return The next waveform sample as a DAC code.
      */
-    virtual uint8_t nextSampleB() = 0;
+    virtual Sample nextSampleB() = 0;
 #endif
 
     /**
@@ -87,4 +113,9 @@ public:
     virtual void reset() = 0;
 };
 
+/**
+ * @brief The interface of waveforms for 8-bit DACs such as the one of the ESP32.
+ */
+using WaveConfigInterface = BasicWaveConfigInterface<uint8_t>;
+
 }
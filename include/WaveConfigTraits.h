@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "DataTypes.h"
+#include "ParameterEvent.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief The sample type of a WaveConfig, or `data_buf_type_t` if it does not declare one.
+ */
+template <typename T, typename = void>
+struct sample_type_of {
+    using type = data_buf_type_t;
+};
+
+template <typename T>
+struct sample_type_of<T, std::void_t<typename T::sample_type>> {
+    using type = typename T::sample_type;
+};
+
+template <typename T>
+using sample_type_of_t = typename sample_type_of<T>::type;
+
+/**
+ * @brief Detects whether a WaveConfig provides a block renderer.
+ *
+ * A WaveConfig may optionally implement
+ * @code
+ * void renderBlock(sample_type* out, size_t n);
+ * @endcode
+ * in addition to `nextSample()`. When present, `Waveu` fills a whole buffer with a
+ * single call instead of calling `nextSample()` once per sample.
+ */
+template <typename T, typename = void>
+struct has_render_block : std::false_type {};
+
+template <typename T>
+struct has_render_block<T, std::void_t<decltype(std::declval<T&>().renderBlock(
+                               std::declval<sample_type_of_t<T>*>(), std::declval<size_t>()))>>
+    : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_render_block_v = has_render_block<T>::value;
+
+/**
+ * @brief Detects whether a WaveConfig accepts sample-accurate parameter events.
+ *
+ * A WaveConfig may optionally implement
+ * @code
+ * void applyEvent(const ParameterEvent& event);
+ * @endcode
+ * to receive the events posted with `Waveu::postEvent()`.
+ */
+template <typename T, typename = void>
+struct has_apply_event : std::false_type {};
+
+template <typename T>
+struct has_apply_event<T, std::void_t<decltype(std::declval<T&>().applyEvent(
+                              std::declval<const ParameterEvent&>()))>>
+    : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_apply_event_v = has_apply_event<T>::value;
+
+/**
+ * @brief Detects whether a stage reports configuration errors.
+ *
+ * A `Pipeline` stage may optionally implement
+ * @code
+ * Result tryConfigure(const WaveConfigArgs& args);
+ * @endcode
+ * instead of `configure()`. `Pipeline::tryConfigure()` returns the first error.
+ */
+template <typename T, typename = void>
+struct has_try_configure : std::false_type {};
+
+template <typename T>
+struct has_try_configure<T, std::void_t<decltype(std::declval<T&>().tryConfigure(
+                                std::declval<const WaveConfigArgs&>()))>>
+    : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_try_configure_v = has_try_configure<T>::value;
+
+/**
+ * @brief Detects whether a WaveConfig can jump ahead in constant time.
+ *
+ * A WaveConfig may optionally implement
+ * @code
+ * void advance(uint64_t samples);
+ * @endcode
+ * to change its state as if `samples` samples had been rendered. `Waveu` uses it for
+ * `RestartPolicy::PhaseContinuous` and only ever jumps forward.
+ */
+template <typename T, typename = void>
+struct has_advance : std::false_type {};
+
+template <typename T>
+struct has_advance<T, std::void_t<decltype(std::declval<T&>().advance(std::declval<uint64_t>()))>>
+    : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_advance_v = has_advance<T>::value;
+
+/**
+ * @brief Detects whether a WaveConfig reports its frequency.
+ *
+ * A WaveConfig may optionally implement
+ * @code
+ * float getFrequency();
+ * @endcode
+ * returning the frequency last set by `configure()` or a `Frequency` event. `Waveu`
+ * uses it to restore that frequency when leaving cyclic output.
+ */
+template <typename T, typename = void>
+struct has_get_frequency : std::false_type {};
+
+template <typename T>
+struct has_get_frequency<T, std::void_t<decltype(std::declval<T&>().getFrequency())>>
+    : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_get_frequency_v = has_get_frequency<T>::value;
+
+/**
+ * @brief The DAC code of zero output of a WaveConfig or quantizer.
+ *
+ * Taken from `static constexpr sample_type MIDSCALE` if declared, otherwise half the
+ * range of the sample type. `Waveu` fades to it with `OverloadPolicy::FadeToMidscale`.
+ */
+template <typename T, typename = void>
+struct midscale_of {
+    static constexpr sample_type_of_t<T> value = (sample_type_of_t<T>)(1U << (8 * sizeof(sample_type_of_t<T>) - 1));
+};
+
+template <typename T>
+struct midscale_of<T, std::void_t<decltype(T::MIDSCALE)>> {
+    static constexpr sample_type_of_t<T> value = T::MIDSCALE;
+};
+
+template <typename T>
+inline constexpr sample_type_of_t<T> midscale_of_v = midscale_of<T>::value;
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "DataTypes.h"
+#include "ParameterEvent.h"
+#include "PhaseGenerator.h"
+#include "Pipeline.h"
+#include "WaveConfigArgs.h"
+
+namespace tinyalg::waveu {
+
+/**
+ * @brief Source stage: a bank of same-size Q15 tables with a morph position between them.
+ *
+ * The morph position runs from 0 (the first table) to `NUM_TABLES - 1` (the last table);
+ * in between, the two adjacent tables are read with linear interpolation and crossfaded.
+ * For example, `WavetableOscillator<LUT_256, Sine, Triangle, Square>` morphs from a sine
+ * through a triangle to a square as the position goes from 0 to 2.
+ *
+ * The position is latched at the start of every sub-block, so it can be modulated per
+ * block, by `setMorph()` or by `Shape` events, while the per-sample cost stays constant:
+ * two interpolated reads and a blend. The tables are stored contiguously, each followed by
+ * a copy of its first value so that the interpolation never wraps the index.
+ *
+ * @tparam Size One of the predefined `LUTSize` values.
+ * @tparam Shapes The initial contents of the tables, types with
+ *                `static float value(float phase)` like those for `LUT`.
+ */
+template <LUTSize Size, typename... Shapes>
+class WavetableOscillator {
+public:
+    static constexpr size_t SIZE = static_cast<size_t>(Size);
+    static constexpr size_t NUM_TABLES = sizeof...(Shapes);
+    static_assert((SIZE & (SIZE - 1)) == 0, "Table size must be a power of two");
+    static_assert(NUM_TABLES > 0, "WavetableOscillator needs at least one table");
+
+    /// Morph position of the last table in Q16.16.
+    static constexpr uint32_t MAX_MORPH = (uint32_t)(NUM_TABLES - 1) << 16;
+
+    void initialize(uint32_t sampleRate) {
+        phaseGenerator_ = PhaseGenerator(sampleRate);
+        size_t index = 0;
+        (fill<Shapes>(index++), ...);
+        latchMorph();
+    }
+
+    void configure(const WaveConfigArgs& args) {
+        if (const auto* oscArgs = args.as<OscillatorArgs>()) {
+            setFrequency(oscArgs->frequency);
+        }
+    }
+
+    void setFrequency(float frequency) { phaseGenerator_.setFrequency(frequency); }
+
+    float getFrequency() const { return phaseGenerator_.getFrequency(); }
+
+    /**
+     * @brief Sets the morph position, taking effect at the next sub-block.
+     *
+     * Can be called from any task while running; the producer reads the position
+     * atomically when it latches it.
+     *
+     * @param position The position in [0, NUM_TABLES - 1]; fractions crossfade between tables.
+     */
+    void setMorph(float position) {
+        setMorphQ16((position <= 0.0f) ? 0 : (uint32_t)std::lround((double)position * 65536.0));
+    }
+
+    /**
+     * @brief Sets the morph position in Q16.16, taking effect at the next sub-block.
+     */
+    void setMorphQ16(uint32_t position) {
+        morph_.store((position > MAX_MORPH) ? MAX_MORPH : position, std::memory_order_relaxed);
+    }
+
+    uint32_t getMorphQ16() const { return morph_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Replaces the contents of a table.
+     *
+     * Call it before `Waveu::start()` or from the waveform generation task, e.g. in a stage
+     * that precedes this one.
+     *
+     * @param table The index of the table.
+     * @param values `SIZE` values in Q15.
+     */
+    void loadTable(size_t table, const int16_t* values) {
+        if (table >= NUM_TABLES) {
+            return;
+        }
+        int16_t* t = tables_[table];
+        for (size_t i = 0; i < SIZE; ++i) {
+            t[i] = values[i];
+        }
+        t[SIZE] = t[0];
+    }
+
+    void reset() { phaseGenerator_.reset(); }
+
+    void advance(uint64_t samples) { phaseGenerator_.advance(samples); }
+
+    /**
+     * @brief Handles `Frequency`, `Phase`, and `Shape` events, the latter with the morph
+     *        position in Q16.16 in `value.u`.
+     */
+    void applyEvent(const ParameterEvent& event) {
+        if (event.type == ParameterEventType::Frequency) {
+            setFrequency(event.value.f);
+        } else if (event.type == ParameterEventType::Phase) {
+            phaseGenerator_.setPhase(event.value.u);
+        } else if (event.type == ParameterEventType::Shape) {
+            setMorphQ16(event.value.u);
+            latchMorph();
+        }
+    }
+
+    void beginBlock(size_t) { latchMorph(); }
+
+    WAVEU_ALWAYS_INLINE int32_t process(int32_t) {
+        return sample(phaseGenerator_.nextPhase());
+    }
+
+    /**
+     * @brief Renders `n` samples in Q15 into `out` at the current morph position.
+     *
+     * The phases of the whole block are written into `out` first and then replaced by
+     * the samples.
+     */
+    void render(int32_t* out, size_t n) {
+        latchMorph();
+        uint32_t* phases = reinterpret_cast<uint32_t*>(out);
+        phaseGenerator_.fillPhases(phases, n);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = sample(phases[i]);
+        }
+    }
+
+    PhaseGenerator& phaseGenerator() { return phaseGenerator_; }
+
+private:
+    static constexpr int log2(size_t n) { return (n <= 1) ? 0 : 1 + log2(n >> 1); }
+    static constexpr int INDEX_BITS = log2(SIZE);
+    static_assert(INDEX_BITS + 15 <= PhaseGenerator::N_BITS, "Table size too large for interpolation");
+
+    template <typename Shape>
+    void fill(size_t table) {
+        int16_t* t = tables_[table];
+        for (size_t i = 0; i < SIZE; ++i) {
+            t[i] = static_cast<int16_t>(std::lround(Shape::value(static_cast<float>(i) / SIZE) * 32767.0f));
+        }
+        t[SIZE] = t[0];
+    }
+
+    WAVEU_ALWAYS_INLINE int32_t sample(uint32_t phase) const {
+        const uint32_t index = phase >> (PhaseGenerator::N_BITS - INDEX_BITS);
+        const int32_t frac = (int32_t)((phase >> (PhaseGenerator::N_BITS - INDEX_BITS - 15)) & 0x7FFF);
+        const int32_t a = interpolate(tables_[lower_], index, frac);
+        const int32_t b = interpolate(tables_[upper_], index, frac);
+        return a + (((b - a) * blend_) >> 15);
+    }
+
+    static WAVEU_ALWAYS_INLINE int32_t interpolate(const int16_t* table, uint32_t index, int32_t frac) {
+        const int32_t v0 = table[index];
+        const int32_t v1 = table[index + 1];
+        return v0 + (((v1 - v0) * frac) >> 15);
+    }
+
+    void latchMorph() {
+        // Read once, so that the table and the blend belong to the same position.
+        const uint32_t morph = morph_.load(std::memory_order_relaxed);
+        const uint32_t table = morph >> 16;
+        lower_ = table;
+        upper_ = (table + 1 < NUM_TABLES) ? table + 1 : table;
+        blend_ = (int32_t)((morph & 0xFFFF) >> 1);
+    }
+
+    PhaseGenerator phaseGenerator_{0};
+    std::atomic<uint32_t> morph_{0};    // Written by setMorph() from any task
+    uint32_t lower_ = 0;    // Index of the table at the integer morph position
+    uint32_t upper_ = 0;
+    int32_t blend_ = 0;     // Weight of the upper table in Q15
+    int16_t tables_[NUM_TABLES][SIZE + 1];
+};
+
+} // namespace tinyalg::waveu
@@ -1,8 +1,20 @@
 #pragma once
 
+#include <atomic>
 #include <type_traits>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
 #include "BoardConfig.h"
+#include "BufferScheduler.h"
+#include "Command.h"
+#include "DataTypes.h"
+#include "LockFreeQueue.h"
+#include "ParameterEvent.h"
+#include "PublishedIndex.h"
+#include "Result.h"
 #include "WaveConfig.h"
 #include "Wave2Config.h"
 #include "WaveConfigArgs.h"
@@ -15,12 +27,62 @@ struct DummyWaveConfig {
     void initialize() {}
 };
 
+/**
+ * @brief Memory used by a `Waveu` instance, see `Waveu::memoryFootprint()`.
+ */
+struct MemoryFootprint {
+    /// The ping and pong buffers.
+    size_t bufferBytes;
+    /// Whether the ping and pong buffers are on the heap rather than in `.bss`.
+    bool buffersOnHeap;
+    /// The DMA buffers of the DAC driver.
+    size_t dmaBytes;
+    /// The stack of the waveform generation task.
+    size_t producerStackBytes;
+    /// The stack of the DAC transfer task.
+    size_t consumerStackBytes;
+    /// The storage of the render and output request queues.
+    size_t queueBytes;
+    /// The `Waveu` object itself, including the WaveConfig, the board and the event and command queues.
+    size_t objectBytes;
+    /// The WaveConfigs, a part of `objectBytes`.
+    size_t waveConfigBytes;
+    /// The copy of the buffer the board keeps for cyclic output, if any.
+    size_t cyclicBufferBytes;
+    /// The ring of the `RecorderTap`, 0 unless `CONFIG_WAVEU_RECORDER` is enabled. Shared by all instances.
+    size_t recorderBytes;
+    /// The rings of the `Tracer`, 0 unless `CONFIG_WAVEU_TRACE` is enabled. Shared by all instances.
+    size_t traceBytes;
+    /// The tables currently held by the `LUTRegistry`. Shared by all instances.
+    size_t lutBytes;
+
+    /**
+     * @brief The sum of all parts, not counting `waveConfigBytes` twice.
+     */
+    size_t total() const {
+        return bufferBytes + dmaBytes + producerStackBytes + consumerStackBytes + queueBytes + objectBytes
+               + cyclicBufferBytes + recorderBytes + traceBytes + lutBytes;
+    }
+};
+
 /**
  * @brief A waveform generator template class for generating and managing waveforms.
  * 
  * This class handles configuration, starting, stopping, and resetting waveform generation
  * in a structured and state-managed manner. It uses board and waveform configurations
  * provided as template parameters.
+ * 
+ * Control operations can be called from any number of tasks. Each one is queued as a
+ * `Command` in a lock-free queue and executed by the waveform generation task at the
+ * next buffer boundary, so it never races with rendering. The `...Async()` variants
+ * return a `CommandHandle` right away; the plain variants wait for completion and
+ * throw on failure. The state can be read atomically from any task with `getState()`.
+ * 
+ * The `try...()` variants wait like the plain ones but return a `Result` instead of
+ * throwing. Together with `WaveConfigArgs::as()` they allow building the library and
+ * the application with `-fno-exceptions -fno-rtti`. In that build mode the throwing
+ * variants log the error and abort. The pipeline and burst examples are
+ * built that way (`CONFIG_COMPILER_CXX_EXCEPTIONS` and `CONFIG_COMPILER_CXX_RTTI` off).
  */
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config = void>
 class Waveu {
@@ -28,12 +90,18 @@ public:
     /**
      * @brief Ensures the provided configurations are valid at compile time.
      */
-    static_assert(std::is_base_of<BoardConfigInterface, BoardConfig>::value,
+    static_assert(std::is_base_of<BasicBoardConfigInterface<typename BoardConfig::sample_type>, BoardConfig>::value,
                   "TargetConfig must derive from TargetConfigInterface");
-    static_assert(std::is_base_of<WaveConfigInterface, WaveConfig>::value,
-                  "WaveConfig must derive from WaveConfigInterface");
-    static_assert(std::is_same_v<Wave2Config, void> || std::is_base_of_v<WaveConfigInterface, Wave2Config>,
-                  "Wave2Config must derive from WaveConfigInterface or be void");
+    static_assert(std::is_base_of<BasicWaveConfigInterface<typename BoardConfig::sample_type>, WaveConfig>::value,
+                  "WaveConfig must derive from BasicWaveConfigInterface<BoardConfig::sample_type>");
+    static_assert(std::is_same_v<Wave2Config, void>
+                  || std::is_base_of_v<BasicWaveConfigInterface<typename BoardConfig::sample_type>, Wave2Config>,
+                  "Wave2Config must derive from BasicWaveConfigInterface<BoardConfig::sample_type> or be void");
+
+    /**
+     * @brief The sample type of the board, used for the ping/pong buffers and `nextSample()`.
+     */
+    using sample_type = typename BoardConfig::sample_type;
     
     BoardConfig brd;
     WaveConfig chan;
@@ -47,7 +115,7 @@ public:
      * It helps track the current status of the object and determines which operations
      * are allowed (e.g., starting, stopping, configuring).
      */
-    enum class State
+    enum class State : uint8_t
     { 
     
         /**
@@ -74,9 +142,19 @@ public:
          */
         Running,
 
-        Stopped
+        Stopped,
+
+        /**
+         * @brief The DAC repeats a pre-rendered buffer by DMA.
+         * 
+         * Entered with `startCyclic()`. The producer and consumer tasks and the timer
+         * are idle. Left with `stop()`, or by `postEvent()`, which returns to **Running**.
+         */
+        Cyclic
     };
 
+    using CyclicPeriod = tinyalg::waveu::CyclicPeriod;
+
     /**
      * @brief Default constructor for the Waveu class.
      * 
@@ -89,58 +167,334 @@ public:
      * @brief Destructor for the Waveu class.
      * 
      * Cleans up any allocated resources and ensures safe shutdown of the generator.
+     * The waveform generation task is stopped and joined before the queues and
+     * semaphores it waits on are deleted.
      */
     ~Waveu();
 
     /**
      * @brief Retrieves the current state of the waveform generator.
      * 
+     * The state changes when the waveform generation task executes a command, so it
+     * can be read from any task.
+     * 
      * @return The current state of the object as a `Waveu::State` value.
      */
-    State getState() const { return currentState; }
+    State getState() const { return currentState.load(std::memory_order_acquire); }
 
     /**
      * @brief Configure the waveform generator with the specified parameters.
      * 
      * Prepares the generator for waveform generation by setting up the necessary configurations.
      * This method can be called when the object is in the **Idle** or **Configured** state.
+     * The first buffer is rendered by the waveform generation task before the call
+     * returns, so it takes one buffer's render time. Called again in the **Configured**
+     * state, it resets the WaveConfig and renders the first buffer again from sample 0.
      * 
      * @param args Configuration arguments for the waveform generator.
      * 
+     * `WaveConfig::tryConfigure()`, which calls `WaveConfig::configure()` unless overridden,
+     * runs in the waveform generation task. If it fails or throws, the exception is caught
+     * there and the generator returns to the **Idle** state.
+     * 
      * @throws InvalidStateTransitionException If called in the **Running** or **Stopped** states.
+     * @throws std::runtime_error If the command queue is full.
+     * @throws std::invalid_argument If `WaveConfig::tryConfigure()` rejected the arguments
+     *         or `WaveConfig::configure()` threw.
+     * @throws std::bad_alloc If `WaveConfig::tryConfigure()` ran out of memory.
      */
     void configure(const WaveConfigArgs& args);
 
+    /**
+     * @brief Queues `configure()` without waiting for it.
+     * 
+     * @param args Configuration arguments. They must stay valid until the command is done.
+     * @return A handle to check or wait for the outcome.
+     */
+    CommandHandle configureAsync(const WaveConfigArgs& args);
+
+    /**
+     * @brief `configure()` returning a `Result` instead of throwing.
+     * 
+     * @return `ErrorCode::Ok`, `ErrorCode::InvalidState`, `ErrorCode::QueueFull`, or the
+     *         error of `WaveConfig::tryConfigure()`, e.g. `ErrorCode::InvalidArgument`.
+     *         `ErrorCode::InvalidArgument` is also returned if `WaveConfig::configure()` threw.
+     */
+    Result tryConfigure(const WaveConfigArgs& args);
+
     /**
      * @brief Start the waveform generator.
      * 
      * Transitions the object from the **Configured** state to the **Running** state
-     * and begins waveform generation.
+     * and begins waveform generation. The pre-rendered buffer is output immediately;
+     * the call does not sleep (see `ESP32Config::startTimer()` for the latency bounds)
+     * apart from waiting for the waveform generation task to reach a buffer boundary.
      * 
-     * @throws InvalidStateTransitionException If called in a state other than **Configured**.
+     * From the **Stopped** state the waveform continues according to `setRestartPolicy()`.
+     * 
+     * @throws InvalidStateTransitionException If called in a state other than **Configured** or **Stopped**.
+     * @throws std::runtime_error If the command queue is full.
      */
     void start();
 
+    /**
+     * @brief Queues `start()` without waiting for it.
+     * 
+     * @return A handle to check or wait for the outcome.
+     */
+    CommandHandle startAsync();
+
+    /**
+     * @brief `start()` returning a `Result` instead of throwing.
+     * 
+     * @return `ErrorCode::Ok`, `ErrorCode::InvalidState` or `ErrorCode::QueueFull`.
+     */
+    Result tryStart();
+
     /**
      * @brief Stop the waveform generator.
      * 
      * Transitions the object from the **Running** state to the **Stopped** state,
-     * halting waveform generation while retaining the configuration.
+     * halting waveform generation while retaining the configuration. The call does not
+     * sleep; output ends at the end of the last buffer handed to the DAC
+     * (see `ESP32Config::stopTimer()` for the latency bounds).
      * 
-     * @throws InvalidStateTransitionException If called in a state other than **Running**.
+     * @throws InvalidStateTransitionException If called in a state other than **Running** or **Cyclic**.
+     * @throws std::runtime_error If the command queue is full.
      */
     void stop();
 
+    /**
+     * @brief Queues `stop()` without waiting for it.
+     * 
+     * @return A handle to check or wait for the outcome.
+     */
+    CommandHandle stopAsync();
+
+    /**
+     * @brief `stop()` returning a `Result` instead of throwing.
+     * 
+     * @return `ErrorCode::Ok`, `ErrorCode::InvalidState` or `ErrorCode::QueueFull`.
+     */
+    Result tryStop();
+
+    /**
+     * @brief Selects how `start()` continues the waveform after `stop()`.
+     * 
+     * - `RestartPolicy::Resume` (default): the output continues with the samples rendered
+     *   before `stop()`, so the waveform is delayed by the time it was stopped.
+     * - `RestartPolicy::PhaseContinuous`: the time since the output started is converted to
+     *   an integer sample count with `BoardConfig::getTimeUs()`, the WaveConfig jumps to that
+     *   sample with `advance()`, and the first buffer is rendered again. The waveform keeps its
+     *   phase relative to the first `start()` after `configure()` or `reset()`, as if it had
+     *   never been stopped, so the output can be gated without losing the phase reference of
+     *   a downstream lock-in measurement. Pending events keep their sample indices on this
+     *   continuous timeline. A stop shorter than the two buffers rendered ahead cannot be
+     *   caught up with; the output then runs ahead of the timeline by up to two buffers.
+     * - `RestartPolicy::Restart`: the WaveConfig is reset and the output starts at sample 0,
+     *   like `reset()` followed by `start()`.
+     * 
+     * Takes effect at the next `start()` from the **Stopped** state. After `startCyclic()`
+     * the waveform resumes once, since sample indices stand still in cyclic mode.
+     * 
+     * @param policy The policy.
+     * @return `ErrorCode::InvalidArgument` for `RestartPolicy::PhaseContinuous` if `WaveConfig`
+     *         does not implement `advance(uint64_t)` (see `has_advance`), `ErrorCode::Ok` otherwise.
+     */
+    Result setRestartPolicy(RestartPolicy policy);
+
+    /**
+     * @brief Retrieves the policy set with `setRestartPolicy()`.
+     */
+    RestartPolicy getRestartPolicy() const { return restartPolicy.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Selects what is output when the waveform generation task falls behind.
+     * 
+     * Every render request carries the timer period it was issued in. When the waveform
+     * generation task picks up a request whose buffer the consumer is already waiting for,
+     * it does not render it late but produces a substitute at a fraction of the cost:
+     * 
+     * - `OverloadPolicy::RepeatLast` (default): the previous buffer is copied. The waveform
+     *   is delayed by one buffer.
+     * - `OverloadPolicy::FadeToMidscale`: the output ramps from the last sample to midscale
+     *   (see `midscale_of`) and holds it; the next rendered buffer ramps back in. The
+     *   waveform is delayed by one buffer.
+     * - `OverloadPolicy::SkipAhead`: the previous buffer is copied and the WaveConfig jumps
+     *   over the missed samples with `advance()`, applying the events that fall into them,
+     *   so the waveform stays on its timeline.
+     * - `OverloadPolicy::Fallback`: the overdue buffer and the next few ones are rendered at
+     *   a quarter of the sample rate, holding each sample and jumping over the rest with
+     *   `advance()`, so the producer can catch up without losing the waveform's timeline.
+     *   The samples are rendered with `nextSample()`, on which a `Pipeline` still begins a
+     *   block every `BLOCK_SIZE` samples, so block-rate stages such as a `Modulator` keep
+     *   running.
+     * 
+     * Either way the consumer waits at most for the substitute, the timer never blocks on
+     * a full queue, and every event is counted in `getOverloadStats()`.
+     * 
+     * @param policy The policy, applied from the next overdue buffer on.
+     * @return `ErrorCode::InvalidArgument` for `OverloadPolicy::SkipAhead` and
+     *         `OverloadPolicy::Fallback` if `WaveConfig` does not implement `advance(uint64_t)`,
+     *         `ErrorCode::Ok` otherwise.
+     */
+    Result setOverloadPolicy(OverloadPolicy policy);
+
+    /**
+     * @brief Retrieves the policy set with `setOverloadPolicy()`.
+     */
+    OverloadPolicy getOverloadPolicy() const { return overloadPolicy.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Retrieves the counters of missed deadlines since construction.
+     * 
+     * Can be called from any task.
+     */
+    OverloadStats getOverloadStats() const;
+
+    /**
+     * @brief Reports where the memory of this instance goes.
+     * 
+     * Sizes of FreeRTOS objects exclude their control blocks. The recorder ring, the
+     * tracer rings and the shared LUT tables belong to the process rather than to this
+     * instance; they are reported so the total matches what the component takes from the
+     * heap and `.bss`. Log it at startup to check a `CONFIG_WAVEU_LEAN_MEMORY` budget:
+     * @code
+     * MemoryFootprint m = waveu.memoryFootprint();
+     * printf("buffers %u, DMA %u, stacks %u + %u, total %u bytes\n", m.bufferBytes, m.dmaBytes,
+     *        m.producerStackBytes, m.consumerStackBytes, m.total());
+     * @endcode
+     */
+    MemoryFootprint memoryFootprint() const;
+
+    /**
+     * @brief Outputs a fixed-frequency waveform by cyclic DMA without CPU load.
+     * 
+     * Finds the buffer length of at most `LEN_DATA_BUFFER` frames that holds an integer
+     * number of periods at the frequency closest to `frequency` (see `findCyclicPeriod()`),
+     * sets that frequency with a `ParameterEventType::Frequency` event, renders the buffer
+     * once from phase zero and hands it to `BoardConfig::startCyclic()`. The producer and
+     * consumer tasks, the timer and the queues stay idle until the mode is left.
+     * 
+     * The mode is left by `stop()`, or by `postEvent()`, which switches back to streaming
+     * at the phase the cyclic buffer started with. An event posted while the mode is being
+     * entered leaves it right away. In both cases the next buffer is rendered right away,
+     * continuing the waveform seamlessly from the end of the cyclic buffer. Sample indices
+     * do not advance while in this mode.
+     * 
+     * If `WaveConfig` implements `float getFrequency()`, the frequency it reported before
+     * is restored when the mode is left, so the cyclic frequency does not outlast the mode.
+     * Events posted meanwhile are applied after that and take precedence.
+     * 
+     * Transitions from the **Configured** or **Stopped** state to the **Cyclic** state.
+     * Buffers still queued for output from before `stop()` are discarded.
+     * 
+     * @param frequency The desired frequency in Hz.
+     * @param maxErrorHz The largest acceptable deviation from `frequency` in Hz.
+     *                   0 accepts only exactly periodic frequencies.
+     * @return true if cyclic output started, false if no buffer length is within
+     *         `maxErrorHz`; the state is unchanged in that case and `start()` can be used instead.
+     * 
+     * @throws InvalidStateTransitionException If called in a state other than **Configured** or **Stopped**.
+     * @throws std::runtime_error If the command queue is full.
+     * 
+     * @note Requires `WaveConfig` to implement `void applyEvent(const ParameterEvent&)`.
+     */
+    bool startCyclic(float frequency, float maxErrorHz = 0.0f);
+
+    /**
+     * @brief Queues `startCyclic()` for a period found with `findCyclicPeriod()`.
+     * 
+     * @param period The buffer length and frequency to output.
+     * @return A handle to check or wait for the outcome.
+     */
+    CommandHandle startCyclicAsync(const CyclicPeriod& period);
+
+    /**
+     * @brief `startCyclic()` returning a `Result` instead of throwing.
+     * 
+     * @return `ErrorCode::Ok`, `ErrorCode::NoPeriod` if no buffer length is within
+     *         `maxErrorHz`, `ErrorCode::InvalidState` or `ErrorCode::QueueFull`.
+     */
+    Result tryStartCyclic(float frequency, float maxErrorHz = 0.0f);
+
+    /**
+     * @brief Retrieves the period used by the last successful `startCyclic()`.
+     */
+    CyclicPeriod getCyclicPeriod() const { return cyclicPeriod; }
+
+    /**
+     * @brief Finds the buffer length holding an integer number of periods closest to a frequency.
+     * 
+     * Searches all lengths up to `LEN_DATA_BUFFER` frames for `cycles / frames` closest to
+     * `frequency / SAMPLE_RATE`. Among equally close candidates the longest buffer wins.
+     * The waveform repeats exactly up to the resolution of the 32-bit phase accumulator.
+     * 
+     * @param frequency The desired frequency in Hz.
+     * @param maxErrorHz The largest acceptable deviation from `frequency` in Hz.
+     * @param period Receives the result.
+     * @return true if a buffer length within `maxErrorHz` exists.
+     */
+    static bool findCyclicPeriod(float frequency, float maxErrorHz, CyclicPeriod& period);
+
     /**
      * @brief Reset the waveform generator to prepare it for reconfiguration or restarting.
      * 
      * Transitions the object from the **Stopped** state to the **Configured** state
-     * while retaining the existing configuration.
+     * while retaining the existing configuration. The first buffer is pre-rendered again.
      * 
      * @throws InvalidStateTransitionException If called in a state other than **Stopped**.
+     * @throws std::runtime_error If the command queue is full.
      */
     void reset();
 
+    /**
+     * @brief Queues `reset()` without waiting for it.
+     * 
+     * @return A handle to check or wait for the outcome.
+     */
+    CommandHandle resetAsync();
+
+    /**
+     * @brief `reset()` returning a `Result` instead of throwing.
+     * 
+     * @return `ErrorCode::Ok`, `ErrorCode::InvalidState` or `ErrorCode::QueueFull`.
+     */
+    Result tryReset();
+
+    /**
+     * @brief Schedules a parameter change at an absolute sample index.
+     * 
+     * The producer splits the buffer containing `event.sampleIndex` and calls
+     * `WaveConfig::applyEvent()` exactly before that sample is rendered.
+     * This method never blocks and can be called from any task or ISR.
+     * When no events are pending, rendering is not affected.
+     * 
+     * In the **Cyclic** state the event makes the generator return to streaming output
+     * (**Running**) at the next opportunity of the waveform generation task.
+     * 
+     * Up to `CONFIG_WAVEU_EVENT_QUEUE_LENGTH` events are held in sample order. If more are
+     * pending, the one with the latest sample index is dropped and counted in
+     * `OverloadStats::droppedEvents`, so a full set of far-future events never holds back
+     * an earlier one.
+     * 
+     * @param event The parameter change. See `ParameterEvent` for the sample index origin.
+     * @return true if the event was queued, false if the event queue is full.
+     * 
+     * @note Requires `WaveConfig` to implement `void applyEvent(const ParameterEvent&)`.
+     */
+    bool postEvent(const ParameterEvent& event);
+
+    /**
+     * @brief Retrieves the index of the next sample the producer will render.
+     * 
+     * Use it as a base for the sample index of `postEvent()`. Rendered samples reach the
+     * DAC up to two buffers (`2 * LEN_DATA_BUFFER` samples) later.
+     * 
+     * @return The number of samples rendered since the last `configure()` or `reset()`.
+     */
+    uint64_t getSampleIndex() const { return publishedSampleIndex.load(); }
+
     /**
      * @brief FreeRTOS-compatible task function for waveform data generation.
      * 
@@ -164,12 +518,190 @@ public:
     static const char* toString(State state);
 
 private:
+    /**
+     * @brief Prepares the next cycle and renders it into the ping or pong buffer.
+     * 
+     * Takes the buffer semaphore before `prepareCycle()` and releases it after rendering,
+     * so the consumer task waits for the new contents instead of outputting the old ones.
+     * Called by the producer task for every timer period, and by `configure()` and
+     * `reset()` to pre-render the first buffer output by `start()`.
+     * 
+     * @param ping `true` to render into the ping buffer, `false` for the pong buffer.
+     * @param fallback `true` to render with `renderFallbackSamples()`.
+     */
+    void produceBuffer(bool ping, bool fallback = false);
+
+    /**
+     * @brief Fills one ping/pong buffer with samples from the waveform configuration.
+     * 
+     * Renders `LEN_DATA_BUFFER` samples, applying the events that fall into the buffer.
+     * The caller holds the semaphore guarding `buffer`.
+     * 
+     * @param buffer The ping or pong buffer to fill.
+     * @param fallback `true` to render with `renderFallbackSamples()`.
+     */
+    void renderBuffer(sample_type *buffer, bool fallback);
+
+    /**
+     * @brief Renders samples of all channels into a part of a buffer.
+     * 
+     * @param buffer The first frame to fill.
+     * @param nSamples The number of samples per channel to render.
+     */
+    void renderSamples(sample_type *buffer, size_t nSamples);
+
+    /**
+     * @brief Ends cyclic output and pre-renders the ping buffer for streaming.
+     */
+    void leaveCyclic();
+
+    /**
+     * @brief Resets the WaveConfig and the sample index and pre-renders the ping buffer.
+     * 
+     * Used by `reset()` and by `start()` with `RestartPolicy::Restart`.
+     */
+    void restartStream();
+
+    /**
+     * @brief Moves the WaveConfig to the sample due now and pre-renders the ping buffer.
+     * 
+     * Used by `start()` with `RestartPolicy::PhaseContinuous`.
+     */
+    void catchUpStream();
+
+    /**
+     * @brief Records that the pre-rendered ping buffer is output from now on.
+     */
+    void anchorTimeline();
+
+    /**
+     * @brief Serves a render request, substituting the buffer if it is overdue.
+     * 
+     * @param request The request taken from `dataGenerationQueue`.
+     */
+    void serveRequest(const data_generation_msg_type_t& request);
+
+    /**
+     * @brief Produces a substitute for an overdue buffer according to the overload policy.
+     * 
+     * @param ping true to fill the ping buffer, false for the pong buffer.
+     */
+    void substituteBuffer(bool ping);
+
+    /**
+     * @brief Fills `target` with a ramp from the last frame of `source` to midscale.
+     */
+    void fadeOut(const sample_type* source, sample_type* target);
+
+    /**
+     * @brief Ramps the first frames of a rendered buffer in from midscale.
+     */
+    void fadeIn(sample_type* buffer);
+
+    /**
+     * @brief Moves the WaveConfig over the samples of one buffer without rendering them.
+     * 
+     * Events that fall into the skipped samples are applied at their positions.
+     */
+    void skipBuffer();
+
+    /**
+     * @brief Renders samples at a quarter of the sample rate with sample-and-hold.
+     */
+    void renderFallbackSamples(sample_type* buffer, size_t nSamples);
+
+    /**
+     * @brief Queues a command and wakes the waveform generation task. Safe from ISRs.
+     */
+    CommandHandle submit(const Command& command);
+
+    /**
+     * @brief Executes all queued commands. Called by the waveform generation task only.
+     * 
+     * @return true if a command invalidated the render request being processed.
+     */
+    bool processCommands();
+
+    /**
+     * @brief Executes one command in the waveform generation task.
+     * 
+     * @param command The command.
+     * @param discardRender Set to true if the command invalidated the pending render request.
+     * @return The outcome.
+     */
+    CommandStatus execute(const Command& command, bool& discardRender);
+
+    /**
+     * @brief Waits for a command, executing it inline when called from the generation task.
+     * 
+     * @param handle The handle returned by `submit()`.
+     * @return The outcome.
+     */
+    Result await(const CommandHandle& handle);
+
+    /**
+     * @brief Waits for a command and turns its failure into an exception.
+     * 
+     * @param handle The handle returned by `submit()`.
+     * @param requirement The allowed transitions, used in the exception message.
+     */
+    void waitFor(const CommandHandle& handle, const char* requirement);
+
+    /**
+     * @brief Checks whether the caller is the waveform generation task.
+     */
+    bool isProducerTask() const;
+
+    /**
+     * @brief Moves posted events into the sorted pending list.
+     */
+    void collectEvents();
+
+    /**
+     * @brief Removes the earliest event from the pending list.
+     */
+    void popPendingEvent();
+
+    /**
+     * @brief Discards all posted and pending events.
+     */
+    void clearEvents();
+
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+    static constexpr size_t SAMPLES_PER_FRAME = 2;
+#else
+    static constexpr size_t SAMPLES_PER_FRAME = 1;
+#endif
+
+    /// @brief Maximum number of events held in sample order by the producer.
+    static constexpr size_t MAX_PENDING_EVENTS = CONFIG_WAVEU_EVENT_QUEUE_LENGTH;
+
     /**
      * @brief The current state of the waveform generator.
      * 
      * This variable tracks the lifecycle state of the object and controls transitions.
      */
-    State currentState = State::Idle;
+    std::atomic<State> currentState{State::Idle};
+
+    /**
+     * @brief The waveform generation task.
+     */
+    TaskHandle_t producerTask = nullptr;
+
+    /**
+     * @brief Given by the waveform generation task when it has stopped, see `~Waveu()`.
+     */
+    SemaphoreHandle_t producerExitSemaphore = nullptr;
+
+    /**
+     * @brief Control operations waiting for the waveform generation task.
+     */
+    LockFreeQueue<Command, CONFIG_WAVEU_COMMAND_QUEUE_LENGTH> commandQueue;
+
+    /**
+     * @brief Outcomes of executed commands.
+     */
+    CommandTracker commandTracker;
 
     /**
      * @brief Internal buffer for received data.
@@ -184,6 +716,78 @@ private:
      * This value is used for timing-related calculations during waveform generation.
      */
     uint64_t elapsedTime = 0;
+
+    /**
+     * @brief Index of the next sample to render (producer only).
+     */
+    uint64_t sampleIndex = 0;
+
+    /**
+     * @brief Copy of `sampleIndex` published to other tasks after each buffer.
+     */
+    PublishedIndex publishedSampleIndex;
+
+    /**
+     * @brief Events posted by other tasks, drained by the producer once per buffer.
+     */
+    LockFreeQueue<ParameterEvent, CONFIG_WAVEU_EVENT_QUEUE_LENGTH> eventQueue;
+
+    /**
+     * @brief Events taken from `eventQueue`, sorted by sample index.
+     */
+    ParameterEvent pendingEvents[MAX_PENDING_EVENTS];
+    size_t pendingEventCount = 0;
+
+    /**
+     * @brief The period used by the last successful `startCyclic()`.
+     */
+    CyclicPeriod cyclicPeriod = {};
+
+    /**
+     * @brief The frequency before the last `startCyclic()`, restored when leaving the mode.
+     */
+    float frequencyBeforeCyclic = 0.0f;
+
+    /**
+     * @brief The policy applied by `start()` after `stop()`.
+     */
+    std::atomic<RestartPolicy> restartPolicy{RestartPolicy::Resume};
+
+    /**
+     * @brief `BoardConfig::getTimeUs()` when the sample `timelineOriginIndex` was output.
+     */
+    int64_t timelineOriginUs = 0;
+    uint64_t timelineOriginIndex = 0;
+    bool timelineAnchored = false;
+
+    /// @brief Frames over which `OverloadPolicy::FadeToMidscale` ramps out and back in.
+    static constexpr size_t OVERLOAD_FADE_FRAMES = 64;
+    /// @brief Samples held per rendered sample in `OverloadPolicy::Fallback`.
+    static constexpr size_t OVERLOAD_FALLBACK_FACTOR = 4;
+    /// @brief Buffers rendered in `OverloadPolicy::Fallback` after each overdue one.
+    static constexpr uint32_t OVERLOAD_FALLBACK_BUFFERS = 8;
+
+    /**
+     * @brief The policy applied to overdue buffers.
+     */
+    std::atomic<OverloadPolicy> overloadPolicy{OverloadPolicy::RepeatLast};
+
+    /**
+     * @brief Counters of `OverloadStats`, written by the producer only.
+     */
+    std::atomic<uint32_t> lateBuffers{0};
+    std::atomic<uint32_t> repeatedBuffers{0};
+    std::atomic<uint32_t> fadedBuffers{0};
+    std::atomic<uint32_t> skippedBuffers{0};
+    std::atomic<uint32_t> fallbackBuffers{0};
+    std::atomic<uint32_t> droppedEvents{0};
+
+    /// @brief Whether the ping buffer holds the most recently produced samples (producer only).
+    bool lastProducedPing = true;
+    /// @brief Whether the next rendered buffer ramps in from midscale (producer only).
+    bool fadeInPending = false;
+    /// @brief Buffers still to be rendered in the fallback mode (producer only).
+    uint32_t fallbackBuffersLeft = 0;
 };
 
 // Initialize the static member outside the class definition
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <cstddef>
+
 namespace tinyalg::waveu {
 
 class WaveuHelper {
 public:
     static const char* TAG;
 
+    /// @brief Length of `dataGenerationQueue`.
+    static constexpr size_t GENERATION_QUEUE_LENGTH = 1;
+    /// @brief Length of `dataOutputQueue`.
+    static constexpr size_t OUTPUT_QUEUE_LENGTH = 10;
+
     /**
      * @brief Initialize the queues.
      * 
@@ -19,6 +26,20 @@ public:
      * 
      */
     static void initSemaphore();
+
+    /**
+     * @brief Initialize the queue set the waveform generation task waits on.
+     * 
+     * Call this after `initQueues()` and `initSemaphore()`.
+     * 
+     * @return true if the queue set is successfully created.
+     */
+    static bool initQueueSet();
+
+    /**
+     * @brief Delete the queue set and the command semaphore.
+     */
+    static void deleteQueueSet();
 };
 
 } // namespace tinyalg::waveu
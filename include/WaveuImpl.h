@@ -1,19 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <new>
 #include <stdexcept>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "freertos/semphr.h"
-#include "driver/gpio.h"
 #include "esp_log.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_WAVEU_DEBUG_PRODUCER_GPIO
+#include "driver/gpio.h"
+#endif
 
+#include "BufferScheduler.h"
+#include "LUTRegistry.h"
+#include "RecorderTap.h"
 #include "Semaphores.h"
 #include "TaskDelete.h"
 #include "DataTypes.h"
 #include "Debug.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "WaveConfigTraits.h"
 #include "InvalidStateTransitionException.h"
+#include "Result.h"
 #include "DataTypes.h"
 #include "Queues.h"
 #include "WaveuHelper.h"
@@ -30,6 +43,8 @@ Waveu<BoardConfig, WaveConfig, Wave2Config>::Waveu() {
         
         WaveuHelper::initQueues();
         WaveuHelper::initSemaphore();
+        WaveuHelper::initQueueSet();
+        producerExitSemaphore = xSemaphoreCreateBinary();
 
         // Initialize board-specific components (e.g., DAC, GPIO)
         brd.initializeDac();
@@ -48,7 +63,7 @@ Waveu<BoardConfig, WaveConfig, Wave2Config>::Waveu() {
         xCoreID = 0;
 #endif
 
-        xTaskCreatePinnedToCore(Waveu::waveformDataGenerationTask, "waveformDataGenerationTask", 4096, (void *)this, uxPriority, NULL, xCoreID);
+        xTaskCreatePinnedToCore(Waveu::waveformDataGenerationTask, "waveformDataGenerationTask", CONFIG_WAVEU_PRODUCER_TASK_STACK_SIZE, (void *)this, uxPriority, &producerTask, xCoreID);
         ESP_LOGI(TAG, "Started waveformDataGenerationTask on core %d at priority %d.",
                                                                          xCoreID, uxPriority);
     }
@@ -57,59 +72,505 @@ template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
 Waveu<BoardConfig, WaveConfig, Wave2Config>::~Waveu() {
     ESP_LOGD(TAG, "Running the destructor ~Waveu()...");
     brd.cleanupTimer();
+
+    // Join the producer before deleting the queue set and semaphores it blocks on.
     waveformDataGenerationTaskDelete();
+    if (xSemaphoreTake(producerExitSemaphore, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        // Leak the objects the task may still use rather than delete them under it.
+        ESP_LOGE(TAG, "waveformDataGenerationTask did not stop; its queues are not deleted.");
+        waveformDataOutputTaskDelete();
+        return;
+    }
+    vTaskDelete(producerTask);
+    producerTask = nullptr;
+    vSemaphoreDelete(producerExitSemaphore);
     waveformDataOutputTaskDelete();
 
     // Clean up the queues.
+    WaveuHelper::deleteQueueSet();
     vQueueDelete(dataGenerationQueue);
     vQueueDelete(dataOutputQueue);
 }
 
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
 void Waveu<BoardConfig, WaveConfig, Wave2Config>::configure(const WaveConfigArgs& args) {
-    if (currentState != State::Idle && currentState != State::Configured) {
-        throw InvalidStateTransitionException(std::string("configure() after reset(): currentState=") + toString(currentState));
-    }
+    waitFor(configureAsync(args), "configure() after reset()");
+}
 
-    chan.configure(args);
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandHandle Waveu<BoardConfig, WaveConfig, Wave2Config>::configureAsync(const WaveConfigArgs& args) {
+    return submit({CommandType::Configure, &args, {}});
+}
 
-    currentState = State::Configured;
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::tryConfigure(const WaveConfigArgs& args) {
+    return await(configureAsync(args));
 }
 
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
 void Waveu<BoardConfig, WaveConfig, Wave2Config>::start()
 {
-    if (currentState != State::Configured && currentState != State::Stopped) {
-        throw InvalidStateTransitionException(std::string("start() after configure(), stop() or reset(): currentState=") + toString(currentState));
-    }
+    waitFor(startAsync(), "start() after configure(), stop() or reset()");
+}
 
-    brd.startTimer();
-    currentState = State::Running;
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandHandle Waveu<BoardConfig, WaveConfig, Wave2Config>::startAsync() {
+    return submit({CommandType::Start, nullptr, {}});
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::tryStart() {
+    return await(startAsync());
 }
 
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
 void Waveu<BoardConfig, WaveConfig, Wave2Config>::stop()
 {
-    if (currentState != State::Running) {
-        throw InvalidStateTransitionException(std::string("stop() after start(): currentState=") + toString(currentState));
-    }
-    
-    brd.stopTimer();
+    waitFor(stopAsync(), "stop() after start() or startCyclic()");
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandHandle Waveu<BoardConfig, WaveConfig, Wave2Config>::stopAsync() {
+    return submit({CommandType::Stop, nullptr, {}});
+}
 
-    currentState = State::Stopped;
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::tryStop() {
+    return await(stopAsync());
 }
 
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
 void Waveu<BoardConfig, WaveConfig, Wave2Config>::reset() {
-    if (currentState != State::Stopped) {
-        throw InvalidStateTransitionException(std::string("reset() after stop(): currentState=") + toString(currentState));
+    waitFor(resetAsync(), "reset() after stop()");
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandHandle Waveu<BoardConfig, WaveConfig, Wave2Config>::resetAsync() {
+    return submit({CommandType::Reset, nullptr, {}});
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::tryReset() {
+    return await(resetAsync());
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+bool Waveu<BoardConfig, WaveConfig, Wave2Config>::startCyclic(float frequency, float maxErrorHz) {
+    static_assert(has_apply_event_v<WaveConfig>,
+                  "startCyclic() requires WaveConfig::applyEvent(const ParameterEvent&)");
+
+    CyclicPeriod period;
+    if (!findCyclicPeriod(frequency, maxErrorHz, period)) {
+        ESP_LOGW(TAG, "No periodic buffer within %.3fHz of %.3fHz", maxErrorHz, frequency);
+        return false;
     }
 
+    waitFor(startCyclicAsync(period), "startCyclic() after configure(), stop() or reset()");
+    return true;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandHandle Waveu<BoardConfig, WaveConfig, Wave2Config>::startCyclicAsync(const CyclicPeriod& period) {
+    static_assert(has_apply_event_v<WaveConfig>,
+                  "startCyclicAsync() requires WaveConfig::applyEvent(const ParameterEvent&)");
+    return submit({CommandType::StartCyclic, nullptr, period});
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::tryStartCyclic(float frequency, float maxErrorHz) {
+    static_assert(has_apply_event_v<WaveConfig>,
+                  "tryStartCyclic() requires WaveConfig::applyEvent(const ParameterEvent&)");
+
+    CyclicPeriod period;
+    if (!findCyclicPeriod(frequency, maxErrorHz, period)) {
+        return ErrorCode::NoPeriod;
+    }
+    return await(startCyclicAsync(period));
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+bool Waveu<BoardConfig, WaveConfig, Wave2Config>::findCyclicPeriod(float frequency, float maxErrorHz, CyclicPeriod& period) {
+    constexpr size_t maxFrames = BoardConfig::LEN_DATA_BUFFER / SAMPLES_PER_FRAME;
+    constexpr double sampleRate = (double)BoardConfig::SAMPLE_RATE;
+
+    bool found = false;
+    double bestError = (double)maxErrorHz;
+    for (size_t frames = maxFrames; frames > 0; frames--) {
+        double cycles = std::round((double)frequency * (double)frames / sampleRate);
+        if (cycles < 1.0 || cycles * 2.0 > (double)frames) {
+            continue; // No full period, or above the Nyquist frequency
+        }
+        double candidate = cycles * sampleRate / (double)frames;
+        double error = std::fabs(candidate - (double)frequency);
+        if (error <= bestError && (!found || error < bestError)) {
+            period = { frames, (uint32_t)cycles, candidate };
+            bestError = error;
+            found = true;
+            if (error == 0.0) {
+                break; // The longest exact match
+            }
+        }
+    }
+    return found;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::setRestartPolicy(RestartPolicy policy) {
+    if (policy == RestartPolicy::PhaseContinuous && !has_advance_v<WaveConfig>) {
+        return ErrorCode::InvalidArgument;
+    }
+    restartPolicy.store(policy, std::memory_order_relaxed);
+    return ErrorCode::Ok;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::setOverloadPolicy(OverloadPolicy policy) {
+    if ((policy == OverloadPolicy::SkipAhead || policy == OverloadPolicy::Fallback) && !has_advance_v<WaveConfig>) {
+        return ErrorCode::InvalidArgument;
+    }
+    overloadPolicy.store(policy, std::memory_order_relaxed);
+    return ErrorCode::Ok;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+OverloadStats Waveu<BoardConfig, WaveConfig, Wave2Config>::getOverloadStats() const {
+    return OverloadStats{
+        .lateBuffers = lateBuffers.load(std::memory_order_relaxed),
+        .repeatedBuffers = repeatedBuffers.load(std::memory_order_relaxed),
+        .fadedBuffers = fadedBuffers.load(std::memory_order_relaxed),
+        .skippedBuffers = skippedBuffers.load(std::memory_order_relaxed),
+        .fallbackBuffers = fallbackBuffers.load(std::memory_order_relaxed),
+        .droppedRequests = BufferScheduler::droppedRequests(),
+        .droppedOutputs = BufferScheduler::droppedOutputs(),
+        .droppedEvents = droppedEvents.load(std::memory_order_relaxed),
+    };
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+MemoryFootprint Waveu<BoardConfig, WaveConfig, Wave2Config>::memoryFootprint() const {
+    return MemoryFootprint{
+        .bufferBytes = 2 * BoardConfig::LEN_DATA_BUFFER * sizeof(sample_type),
+        .buffersOnHeap = !std::is_array_v<decltype(BoardConfig::pingDataBuffer)>,
+        .dmaBytes = brd.dmaBufferBytes(),
+        .producerStackBytes = CONFIG_WAVEU_PRODUCER_TASK_STACK_SIZE,
+        .consumerStackBytes = CONFIG_WAVEU_CONSUMER_TASK_STACK_SIZE,
+        .queueBytes = WaveuHelper::GENERATION_QUEUE_LENGTH * sizeof(data_generation_msg_type_t)
+                      + WaveuHelper::OUTPUT_QUEUE_LENGTH * sizeof(data_output_msg_type_t),
+        .objectBytes = sizeof(*this),
+        .waveConfigBytes = sizeof(chan) + (std::is_same_v<Wave2Config, void> ? 0 : sizeof(chan2)),
+        .cyclicBufferBytes = brd.cyclicBufferBytes(),
+#ifdef CONFIG_WAVEU_RECORDER
+        .recorderBytes = RecorderTap::RING_SIZE,
+#else
+        .recorderBytes = 0,
+#endif
+#ifdef CONFIG_WAVEU_TRACE
+        .traceBytes = Tracer::memoryBytes(),
+#else
+        .traceBytes = 0,
+#endif
+        .lutBytes = LUTRegistry::instance().totalBytes(),
+    };
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::restartStream() {
+    // Drop a render request still pending from before stop().
+    xQueueReset(dataGenerationQueue);
+
     chan.reset();
     brd.reset();
     elapsedTime = 0;
+    sampleIndex = 0;
+    publishedSampleIndex.store(0);
+    clearEvents();
+    // The next start() begins a new timeline.
+    timelineAnchored = false;
+
+    // Pre-render the first buffer so that start() can output it immediately.
+    produceBuffer(true);
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::catchUpStream() {
+    constexpr uint64_t US_PER_SECOND = 1000000;
+    constexpr uint64_t sampleRate = BoardConfig::SAMPLE_RATE;
+
+    // The sample due now on the timeline of the first start(), in whole samples.
+    const uint64_t elapsedUs = (uint64_t)(brd.getTimeUs() - timelineOriginUs);
+    const uint64_t target = timelineOriginIndex + (elapsedUs / US_PER_SECOND) * sampleRate
+                            + (elapsedUs % US_PER_SECOND) * sampleRate / US_PER_SECOND;
+
+    // Drop a render request still pending from before stop().
+    xQueueReset(dataGenerationQueue);
+
+    // After a stop shorter than the buffers rendered ahead, the target lies behind the
+    // rendered samples. The WaveConfig cannot step back, so the output then continues
+    // where it is, slightly ahead of the timeline.
+    const uint64_t jump = (target > sampleIndex) ? target - sampleIndex : 0;
+    if constexpr (has_advance_v<WaveConfig>) {
+        chan.advance(jump);
+    }
+    elapsedTime += jump * US_PER_SECOND / sampleRate;
+    sampleIndex += jump;
+    brd.reset();
+
+    // Pre-render the first buffer so that it is output immediately.
+    produceBuffer(true);
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::anchorTimeline() {
+    constexpr size_t nSamples = BoardConfig::LEN_DATA_BUFFER / SAMPLES_PER_FRAME;
+    // The buffer rendered last is output first by startTimer().
+    timelineOriginIndex = sampleIndex - nSamples;
+    timelineOriginUs = brd.getTimeUs();
+    timelineAnchored = true;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::leaveCyclic() {
+    brd.stopCyclic();
+
+    if constexpr (has_get_frequency_v<WaveConfig>) {
+        // The cyclic frequency only holds for the mode; events posted meanwhile apply on top.
+        chan.applyEvent(ParameterEvent::frequency(sampleIndex, frequencyBeforeCyclic));
+    }
+
+    // The cyclic buffer ended at the phase it started with, so the waveform simply continues.
+    produceBuffer(true);
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandHandle Waveu<BoardConfig, WaveConfig, Wave2Config>::submit(const Command& command) {
+    uint32_t position;
+    if (!commandQueue.push(command, &position)) {
+        return CommandHandle(CommandStatus::QueueFull);
+    }
+
+    // Wake the generation task. The semaphore stays given until the task has run, so
+    // giving it again fails harmlessly and any number of commands cost a single wake-up.
+    if (xPortInIsrContext()) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(commandSemaphore, &higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    } else {
+        xSemaphoreGive(commandSemaphore);
+    }
+
+    return CommandHandle(&commandTracker, position);
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+Result Waveu<BoardConfig, WaveConfig, Wave2Config>::await(const CommandHandle& handle) {
+    if (isProducerTask()) {
+        // Called from the generation task itself, e.g. by a WaveConfig; nobody else would execute it.
+        processCommands();
+    }
+    return toResult(handle.wait());
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::waitFor(const CommandHandle& handle, const char* requirement) {
+    switch (await(handle).error()) {
+        case ErrorCode::InvalidState:
+#if !WAVEU_EXCEPTIONS
+            ESP_LOGE(TAG, "%s: currentState=%s", requirement,
+                     toString(static_cast<State>(handle.observedState())));
+#endif
+            WAVEU_THROW(InvalidStateTransitionException(std::string(requirement) + ": currentState="
+                                                        + toString(static_cast<State>(handle.observedState()))));
+        case ErrorCode::QueueFull:
+#if !WAVEU_EXCEPTIONS
+            ESP_LOGE(TAG, "%s: command queue is full", requirement);
+#endif
+            WAVEU_THROW(std::runtime_error(std::string(requirement) + ": command queue is full"));
+        case ErrorCode::InvalidArgument:
+#if !WAVEU_EXCEPTIONS
+            ESP_LOGE(TAG, "WaveConfig::configure() rejected the arguments");
+#endif
+            WAVEU_THROW(std::invalid_argument("WaveConfig::configure() rejected the arguments"));
+        case ErrorCode::NoMemory:
+#if !WAVEU_EXCEPTIONS
+            ESP_LOGE(TAG, "WaveConfig::configure() ran out of memory");
+#endif
+            WAVEU_THROW(std::bad_alloc());
+        default:
+            break;
+    }
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+bool Waveu<BoardConfig, WaveConfig, Wave2Config>::isProducerTask() const {
+    return producerTask == nullptr || xTaskGetCurrentTaskHandle() == producerTask;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+bool Waveu<BoardConfig, WaveConfig, Wave2Config>::processCommands() {
+    bool discardRender = false;
+    Command command;
+    uint32_t position;
+    while (commandQueue.pop(command, &position)) {
+        State observed = currentState.load(std::memory_order_relaxed);
+        CommandStatus status = execute(command, discardRender);
+        commandTracker.complete(position, status, static_cast<uint8_t>(observed));
+    }
+
+    if constexpr (has_apply_event_v<WaveConfig>) {
+        // Pairs with the fence in postEvent(): either it sees the Cyclic state and submits
+        // ResumeStreaming, or its event is seen here. This also leaves the mode if that
+        // command did not fit into the full command queue.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (currentState.load(std::memory_order_relaxed) == State::Cyclic && !eventQueue.empty()) {
+            leaveCyclic();
+            brd.startTimer();
+            currentState.store(State::Running, std::memory_order_release);
+            discardRender = true;
+        }
+    }
+    return discardRender;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+CommandStatus Waveu<BoardConfig, WaveConfig, Wave2Config>::execute(const Command& command, bool& discardRender) {
+    const State state = currentState.load(std::memory_order_relaxed);
+    State next;
+
+    switch (command.type) {
+        case CommandType::Configure:
+            if (state != State::Idle && state != State::Configured) {
+                return CommandStatus::InvalidState;
+            }
+            if (state == State::Configured) {
+                // The first buffer has been rendered before; start over at sample 0
+                // instead of rendering on from it.
+                chan.reset();
+                brd.reset();
+                elapsedTime = 0;
+                sampleIndex = 0;
+                publishedSampleIndex.store(0);
+            }
+        {
+            Result result;
+#if WAVEU_EXCEPTIONS
+            // An exception must not escape the waveform generation task.
+            try {
+                result = chan.tryConfigure(*command.args);
+            } catch (const std::exception& e) {
+                ESP_LOGE(TAG, "WaveConfig::configure() failed: %s", e.what());
+                result = ErrorCode::InvalidArgument;
+            }
+#else
+            result = chan.tryConfigure(*command.args);
+#endif
+            if (!result) {
+                // The WaveConfig may be half configured; it must be configured again.
+                currentState.store(State::Idle, std::memory_order_release);
+                return (result.error() == ErrorCode::NoMemory) ? CommandStatus::NoMemory
+                                                               : CommandStatus::InvalidArgument;
+            }
+        }
+
+            // Pre-render the first buffer so that start() can output it immediately.
+            produceBuffer(true);
+            discardRender = true;
+            next = State::Configured;
+            break;
+
+        case CommandType::Start: {
+            if (state != State::Configured && state != State::Stopped) {
+                return CommandStatus::InvalidState;
+            }
+            const RestartPolicy policy = restartPolicy.load(std::memory_order_relaxed);
+            if (state == State::Stopped && policy == RestartPolicy::PhaseContinuous && timelineAnchored) {
+                catchUpStream();
+                discardRender = true;
+            } else {
+                if (state == State::Stopped && policy == RestartPolicy::Restart) {
+                    restartStream();
+                    discardRender = true;
+                }
+                // Keep the timeline of the first start() across resumed starts.
+                if (!timelineAnchored) {
+                    anchorTimeline();
+                }
+            }
+            brd.startTimer();
+            next = State::Running;
+            break;
+        }
 
-    currentState = State::Configured;
+        case CommandType::Stop:
+            if (state == State::Running) {
+                brd.stopTimer();
+            } else if (state == State::Cyclic) {
+                leaveCyclic();
+            } else {
+                return CommandStatus::InvalidState;
+            }
+            next = State::Stopped;
+            break;
+
+        case CommandType::Reset:
+            if (state != State::Stopped) {
+                return CommandStatus::InvalidState;
+            }
+            restartStream();
+            discardRender = true;
+            next = State::Configured;
+            break;
+
+        case CommandType::StartCyclic:
+            if constexpr (has_apply_event_v<WaveConfig>) {
+                if (state != State::Configured && state != State::Stopped) {
+                    return CommandStatus::InvalidState;
+                }
+                const CyclicPeriod& period = command.period;
+
+                // Discard pending requests and wait until the consumer has released both buffers.
+                xQueueReset(dataGenerationQueue);
+                xQueueReset(dataOutputQueue);
+                discardRender = true;
+                xSemaphoreTake(tinyalg::waveu::pingBufferSemaphore, portMAX_DELAY);
+                xSemaphoreTake(tinyalg::waveu::pongBufferSemaphore, portMAX_DELAY);
+
+                if constexpr (has_get_frequency_v<WaveConfig>) {
+                    frequencyBeforeCyclic = chan.getFrequency();
+                }
+                chan.applyEvent(ParameterEvent::frequency(sampleIndex, (float)period.frequency));
+                chan.reset();
+                renderSamples(BoardConfig::pingDataBuffer, period.frames);
+                brd.startCyclic(BoardConfig::pingDataBuffer, period.frames * SAMPLES_PER_FRAME);
+
+                xSemaphoreGive(tinyalg::waveu::pongBufferSemaphore);
+                xSemaphoreGive(tinyalg::waveu::pingBufferSemaphore);
+
+                cyclicPeriod = period;
+                // Sample indices stand still in cyclic mode; the next start() anchors anew.
+                timelineAnchored = false;
+                ESP_LOGI(TAG, "Cyclic output at %.3fHz (%u cycles in %u frames)",
+                         period.frequency, (unsigned)period.cycles, (unsigned)period.frames);
+                next = State::Cyclic;
+                break;
+            } else {
+                return CommandStatus::InvalidState;
+            }
+
+        case CommandType::ResumeStreaming:
+            if (state != State::Cyclic) {
+                return CommandStatus::Done; // Already streaming or stopped
+            }
+            leaveCyclic();
+            brd.startTimer();
+            next = State::Running;
+            break;
+
+        default:
+            return CommandStatus::InvalidState;
+    }
+
+    currentState.store(next, std::memory_order_release);
+    return CommandStatus::Done;
 }
 
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
@@ -118,72 +579,351 @@ void Waveu<BoardConfig, WaveConfig, Wave2Config>::waveformDataGenerationTask(voi
 
     data_generation_msg_type_t receivedData;
     while (1) {
-        // Wait for notification, then calculate the next buffer.
-        xQueueReceive(dataGenerationQueue, &receivedData, portMAX_DELAY);
+        // Wait for a render request or a command.
+        QueueSetMemberHandle_t member = xQueueSelectFromSet(producerQueueSet, portMAX_DELAY);
+
+        if (member == commandSemaphore) {
+            xSemaphoreTake(commandSemaphore, 0);
+            instance->processCommands();
+            continue;
+        }
+
+        if (xQueueReceive(dataGenerationQueue, &receivedData, 0) != pdTRUE) {
+            continue; // The request was dropped by xQueueReset().
+        }
 
-        // When triggered, delete this task itself.
+        // When triggered, report to ~Waveu(), which deletes this task.
         if (receivedData.terminationTrigger) {
             ESP_LOGI(TAG, "Stopping waveformDataGenerationTask...");
-            vTaskDelete(NULL);
+            xSemaphoreGive(instance->producerExitSemaphore);
+            vTaskSuspend(NULL);
         }
 
-        constexpr double MICROSECONDS_TO_SECONDS = 1e-6;
-        instance->chan.prepareCycle((double)instance->elapsedTime * MICROSECONDS_TO_SECONDS);
+        // Control operations are executed at buffer boundaries only.
+        if (instance->processCommands()) {
+            continue;
+        }
 
-#ifdef CONFIG_WAVEU_CHANNEL_MODE_SIMUL
-        int nSamples = BoardConfig::LEN_DATA_BUFFER; // Number of samples per milisecond
-#endif
-#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
-        int nSamples = BoardConfig::LEN_DATA_BUFFER / 2; // Number of samples per milisecond
-#endif
+        WAVEU_PROFILE_QUEUE_RECEIVE();
+        WAVEU_TRACE_INSTANT(TraceEvent::GenerationQueueReceive, receivedData.data);
 
-        if (receivedData.data) {
-            uint8_t *ptr = BoardConfig::pingDataBuffer;
-            // Wait for semaphore to ensure the buffer is ready
-            if (xSemaphoreTake(tinyalg::waveu::pingBufferSemaphore, portMAX_DELAY) == pdTRUE) {
+        instance->serveRequest(receivedData);
+    } // while (1)
+}
 
-                DEBUG_PRODUCER_GPIO_SET_LEVEL(1);
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::serveRequest(const data_generation_msg_type_t& request) {
+    if (BufferScheduler::isOverdue(request.period)) {
+        // The consumer is already waiting for this buffer; rendering it now would only
+        // make the following ones late as well.
+        substituteBuffer(request.data);
+        return;
+    }
 
-                for (int i = 0; i < nSamples; i++) {
-                    data_buf_type_t outputValue = instance->chan.nextSample();
-                    *ptr++ = outputValue;  // Channel 0 data
-#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
-                    outputValue = instance->chan.nextSampleB();
-                    *ptr++ = outputValue;  // Channel 1 data
-#endif
-                }
+    const bool fallback = (fallbackBuffersLeft > 0);
+    if (fallback) {
+        fallbackBuffersLeft--;
+        fallbackBuffers.fetch_add(1, std::memory_order_relaxed);
+    }
+    produceBuffer(request.data, fallback);
 
-                DEBUG_PRODUCER_GPIO_SET_LEVEL(0);
-                
-                // Notify the consumer task that the new buffer is ready
-                xSemaphoreGive(tinyalg::waveu::pingBufferSemaphore);
-            }
+    if (BufferScheduler::isOverdue(request.period)) {
+        lateBuffers.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::substituteBuffer(bool ping) {
+    const OverloadPolicy policy = overloadPolicy.load(std::memory_order_relaxed);
+    if (policy == OverloadPolicy::Fallback) {
+        fallbackBuffersLeft = OVERLOAD_FALLBACK_BUFFERS;
+        fallbackBuffers.fetch_add(1, std::memory_order_relaxed);
+        produceBuffer(ping, true);
+        return;
+    }
+
+    sample_type* target = ping ? BoardConfig::pingDataBuffer : BoardConfig::pongDataBuffer;
+    const sample_type* source = lastProducedPing ? BoardConfig::pingDataBuffer : BoardConfig::pongDataBuffer;
+    SemaphoreHandle_t semaphore = ping ? tinyalg::waveu::pingBufferSemaphore : tinyalg::waveu::pongBufferSemaphore;
+
+    WAVEU_TRACE_INSTANT(TraceEvent::Substitute, ping);
+    BaseType_t taken;
+    {
+        WAVEU_PROFILE_SCOPE(ProfileStage::ProducerWait);
+        WAVEU_TRACE_SCOPE(TraceEvent::ProducerWait, ping);
+        taken = xSemaphoreTake(semaphore, portMAX_DELAY);
+    }
+    if (taken != pdTRUE) {
+        return;
+    }
+
+    if (policy == OverloadPolicy::FadeToMidscale) {
+        fadeOut(source, target);
+        fadeInPending = true;
+        fadedBuffers.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        if (source != target) {
+            // The source buffer is only read, so the consumer may be transferring it meanwhile.
+            std::copy_n(source, BoardConfig::LEN_DATA_BUFFER, target);
+        }
+        if (policy == OverloadPolicy::SkipAhead) {
+            skipBuffer();
+            skippedBuffers.fetch_add(1, std::memory_order_relaxed);
         } else {
-            uint8_t *ptr = BoardConfig::pongDataBuffer;
+            repeatedBuffers.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    lastProducedPing = ping;
+
+    xSemaphoreGive(semaphore);
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::fadeOut(const sample_type* source, sample_type* target) {
+    constexpr size_t nSamples = BoardConfig::LEN_DATA_BUFFER / SAMPLES_PER_FRAME;
+    constexpr size_t fade = (OVERLOAD_FADE_FRAMES < nSamples) ? OVERLOAD_FADE_FRAMES : nSamples;
+    constexpr int32_t midscale = midscale_of_v<WaveConfig>;
+
+    // Read the last frame first; source and target may be the same buffer.
+    int32_t from[SAMPLES_PER_FRAME];
+    for (size_t c = 0; c < SAMPLES_PER_FRAME; c++) {
+        from[c] = source[(nSamples - 1) * SAMPLES_PER_FRAME + c];
+    }
+
+    sample_type* ptr = target;
+    for (size_t i = 0; i < fade; i++) {
+        for (size_t c = 0; c < SAMPLES_PER_FRAME; c++) {
+            *ptr++ = (sample_type)(from[c] + (midscale - from[c]) * (int32_t)(i + 1) / (int32_t)fade);
+        }
+    }
+    std::fill(ptr, target + BoardConfig::LEN_DATA_BUFFER, (sample_type)midscale);
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::fadeIn(sample_type* buffer) {
+    constexpr size_t nSamples = BoardConfig::LEN_DATA_BUFFER / SAMPLES_PER_FRAME;
+    constexpr size_t fade = (OVERLOAD_FADE_FRAMES < nSamples) ? OVERLOAD_FADE_FRAMES : nSamples;
+    constexpr int32_t midscale = midscale_of_v<WaveConfig>;
+
+    sample_type* ptr = buffer;
+    for (size_t i = 0; i < fade; i++) {
+        for (size_t c = 0; c < SAMPLES_PER_FRAME; c++, ptr++) {
+            *ptr = (sample_type)(midscale + ((int32_t)*ptr - midscale) * (int32_t)(i + 1) / (int32_t)fade);
+        }
+    }
+}
 
-            // Wait for semaphore to ensure the buffer is ready
-            if (xSemaphoreTake(tinyalg::waveu::pongBufferSemaphore, portMAX_DELAY) == pdTRUE) {
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::skipBuffer() {
+    constexpr size_t nSamples = BoardConfig::LEN_DATA_BUFFER / SAMPLES_PER_FRAME;
+    if constexpr (has_advance_v<WaveConfig>) {
+        size_t done = 0;
+        if constexpr (has_apply_event_v<WaveConfig>) {
+            collectEvents();
+            while (pendingEventCount > 0 && pendingEvents[0].sampleIndex < sampleIndex + nSamples) {
+                uint64_t at = pendingEvents[0].sampleIndex;
+                size_t upTo = (at > sampleIndex + done) ? (size_t)(at - sampleIndex) : done;
+                chan.advance(upTo - done);
+                done = upTo;
+                chan.applyEvent(pendingEvents[0]);
+                popPendingEvent();
+            }
+        }
+        chan.advance(nSamples - done);
+    }
+    sampleIndex += nSamples;
+    publishedSampleIndex.store(sampleIndex);
+    elapsedTime += BoardConfig::TIMER_PERIOD;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::produceBuffer(bool ping, bool fallback) {
+    constexpr double MICROSECONDS_TO_SECONDS = 1e-6;
+    SemaphoreHandle_t semaphore = ping ? tinyalg::waveu::pingBufferSemaphore : tinyalg::waveu::pongBufferSemaphore;
+
+    BaseType_t taken;
+    {
+        // Lock the buffer before preparing the cycle, so the consumer cannot output its
+        // previous contents while a slow prepareCycle() runs.
+        WAVEU_PROFILE_SCOPE(ProfileStage::ProducerWait);
+        WAVEU_TRACE_SCOPE(TraceEvent::ProducerWait, ping);
+        taken = xSemaphoreTake(semaphore, portMAX_DELAY);
+    }
+    if (taken != pdTRUE) {
+        return;
+    }
+
+    {
+        WAVEU_PROFILE_SCOPE(ProfileStage::PrepareCycle);
+        WAVEU_TRACE_SCOPE(TraceEvent::PrepareCycle, 0);
+        chan.prepareCycle((double)elapsedTime * MICROSECONDS_TO_SECONDS);
+    }
+
+    renderBuffer(ping ? BoardConfig::pingDataBuffer : BoardConfig::pongDataBuffer, fallback);
+    lastProducedPing = ping;
+
+    // Notify the consumer task that the new buffer is ready
+    xSemaphoreGive(semaphore);
+
+    elapsedTime += BoardConfig::TIMER_PERIOD;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::renderBuffer(sample_type *buffer, bool fallback) {
+    constexpr size_t nSamples = BoardConfig::LEN_DATA_BUFFER / SAMPLES_PER_FRAME; // Number of samples per channel
+    [[maybe_unused]] const bool ping = (buffer == BoardConfig::pingDataBuffer);
+
+    {
+        DEBUG_PRODUCER_GPIO_SET_LEVEL(1);
+        {
+            WAVEU_PROFILE_SCOPE(ProfileStage::Render);
+            WAVEU_TRACE_SCOPE(TraceEvent::Render, ping);
+            size_t done = 0;
+            if constexpr (has_apply_event_v<WaveConfig>) {
+                collectEvents();
+                // Split the buffer at every event that falls into it.
+                while (pendingEventCount > 0 && pendingEvents[0].sampleIndex < sampleIndex + nSamples) {
+                    uint64_t at = pendingEvents[0].sampleIndex;
+                    size_t upTo = (at > sampleIndex + done) ? (size_t)(at - sampleIndex) : done;
+                    if (fallback) {
+                        renderFallbackSamples(buffer + done * SAMPLES_PER_FRAME, upTo - done);
+                    } else {
+                        renderSamples(buffer + done * SAMPLES_PER_FRAME, upTo - done);
+                    }
+                    done = upTo;
+                    chan.applyEvent(pendingEvents[0]);
+                    popPendingEvent();
+                }
+            }
+            if (fallback) {
+                renderFallbackSamples(buffer + done * SAMPLES_PER_FRAME, nSamples - done);
+            } else {
+                renderSamples(buffer + done * SAMPLES_PER_FRAME, nSamples - done);
+            }
+            if (fadeInPending) {
+                fadeIn(buffer);
+                fadeInPending = false;
+            }
+        }
+        DEBUG_PRODUCER_GPIO_SET_LEVEL(0);
 
-                DEBUG_PRODUCER_GPIO_SET_LEVEL(1);
+        sampleIndex += nSamples;
+        publishedSampleIndex.store(sampleIndex);
+    }
+}
 
-                for (int i = 0; i < nSamples; i++) {
-                    data_buf_type_t outputValue = instance->chan.nextSample();
-                    *ptr++ = outputValue;  // Channel 0 data
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::renderSamples(sample_type *buffer, size_t nSamples) {
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_SIMUL
+    if constexpr (has_render_block_v<WaveConfig>) {
+        // Let the WaveConfig fill the whole range in one go.
+        chan.renderBlock(buffer, nSamples);
+        return;
+    }
+#endif
+    sample_type *ptr = buffer;
+    for (size_t i = 0; i < nSamples; i++) {
+        sample_type outputValue = chan.nextSample();
+        {
+            WAVEU_PROFILE_SAMPLED_SCOPE(ProfileStage::BufferWrite);
+            *ptr++ = outputValue;  // Channel 0 data
+        }
 #ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
-                    outputValue = instance->chan.nextSampleB();
-                    *ptr++ = outputValue;  // Channel 1 data
+        outputValue = chan.nextSampleB();
+        *ptr++ = outputValue;  // Channel 1 data
 #endif
-                }
+    }
+}
 
-                DEBUG_PRODUCER_GPIO_SET_LEVEL(0);
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::renderFallbackSamples(sample_type *buffer, size_t nSamples) {
+    if constexpr (has_advance_v<WaveConfig>) {
+        sample_type *ptr = buffer;
+        while (nSamples > 0) {
+            const size_t hold = (nSamples < OVERLOAD_FALLBACK_FACTOR) ? nSamples : OVERLOAD_FALLBACK_FACTOR;
+            const sample_type a = chan.nextSample();
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+            const sample_type b = chan.nextSampleB();
+#endif
+            for (size_t i = 0; i < hold; i++) {
+                *ptr++ = a;
+#ifdef CONFIG_WAVEU_CHANNEL_MODE_ALTER
+                *ptr++ = b;
+#endif
+            }
+            // Keep the timeline: the held samples are skipped, not rendered.
+            chan.advance(hold - 1);
+            nSamples -= hold;
+        }
+    } else {
+        renderSamples(buffer, nSamples);
+    }
+}
 
-                // Notify the consumer task that the new buffer is ready
-                xSemaphoreGive(tinyalg::waveu::pongBufferSemaphore);
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+bool Waveu<BoardConfig, WaveConfig, Wave2Config>::postEvent(const ParameterEvent& event) {
+    static_assert(has_apply_event_v<WaveConfig>,
+                  "postEvent() requires WaveConfig::applyEvent(const ParameterEvent&)");
+    if (!eventQueue.push(event)) {
+        return false;
+    }
+
+    // Pairs with the fence in processCommands(), so that the event cannot be queued
+    // unseen while the producer enters the mode.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (currentState.load(std::memory_order_relaxed) == State::Cyclic) {
+        // The cyclic buffer cannot change; return to streaming, which picks up the event.
+        if (submit({CommandType::ResumeStreaming, nullptr, {}}).status() == CommandStatus::QueueFull) {
+            // The producer has yet to run the queued commands, after which it finds this
+            // event and leaves the mode in processCommands() all the same.
+            if (!xPortInIsrContext()) {
+                ESP_LOGW(TAG, "postEvent(): command queue is full; cyclic output ends after the queued commands");
             }
         }
+    }
+    return true;
+}
 
-        instance->elapsedTime += BoardConfig::TIMER_PERIOD;
-    } // while (1)
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::collectEvents() {
+    if (eventQueue.empty()) {
+        return;
+    }
+
+    // Move events into the pending list, keeping it sorted by sample index. When it is
+    // full, the latest event is dropped, so far-future events never hold back nearer ones.
+    ParameterEvent event;
+    while (eventQueue.pop(event)) {
+        if (pendingEventCount == MAX_PENDING_EVENTS) {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            if (event.sampleIndex >= pendingEvents[MAX_PENDING_EVENTS - 1].sampleIndex) {
+                continue;
+            }
+            pendingEventCount--;
+        }
+        size_t i = pendingEventCount++;
+        while (i > 0 && pendingEvents[i - 1].sampleIndex > event.sampleIndex) {
+            pendingEvents[i] = pendingEvents[i - 1];
+            i--;
+        }
+        pendingEvents[i] = event;
+    }
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::popPendingEvent() {
+    for (size_t i = 1; i < pendingEventCount; i++) {
+        pendingEvents[i - 1] = pendingEvents[i];
+    }
+    pendingEventCount--;
+}
+
+template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
+void Waveu<BoardConfig, WaveConfig, Wave2Config>::clearEvents() {
+    ParameterEvent event;
+    while (eventQueue.pop(event)) {
+    }
+    pendingEventCount = 0;
 }
 
 template <typename BoardConfig, typename WaveConfig, typename Wave2Config>
@@ -193,6 +933,7 @@ const char* Waveu<BoardConfig, WaveConfig, Wave2Config>::toString(State state) {
         case State::Configured: return "Configured";
         case State::Running:    return "Running";
         case State::Stopped:    return "Stopped";
+        case State::Cyclic:     return "Cyclic";
         default:                return "Unknown";
     }
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+// Minimal assertions for the host tests. A failed check is reported and counted;
+// main() returns CHECK_RESULT() so that ctest sees the failure.
+#include <cstdio>
+
+namespace waveu_test {
+inline int failures = 0;
+} // namespace waveu_test
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);      \
+            ++waveu_test::failures;                                                         \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                          \
+    do {                                                                                    \
+        const auto actual_ = (actual);                                                      \
+        const auto expected_ = (expected);                                                  \
+        if (!(actual_ == expected_)) {                                                      \
+            std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                        #actual, #expected, (long long)actual_, (long long)expected_);      \
+            ++waveu_test::failures;                                                         \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_RESULT() (waveu_test::failures == 0 ? 0 : 1)
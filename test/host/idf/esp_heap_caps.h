@@ -0,0 +1,13 @@
+#pragma once
+
+// Stand-in for the ESP-IDF header; the capabilities are ignored on a host.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline void* heap_caps_malloc(size_t size, uint32_t) { return std::malloc(size); }
+inline void heap_caps_free(void* ptr) { std::free(ptr); }
@@ -0,0 +1,12 @@
+#pragma once
+
+// Stand-in for the ESP-IDF header, printing to stdout.
+#include <cstdio>
+#include "esp_err.h"
+
+#define WAVEU_HOST_LOG(level, tag, format, ...) std::printf(level " (%s): " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGE(tag, format, ...) WAVEU_HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) WAVEU_HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) WAVEU_HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
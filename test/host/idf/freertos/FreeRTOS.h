@@ -0,0 +1,12 @@
+#pragma once
+
+// Stand-in for the FreeRTOS header; only the types used by the host-buildable sources.
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xffffffffu
@@ -0,0 +1,20 @@
+#pragma once
+
+// Stand-in for the FreeRTOS header; a static mutex is a std::mutex on a host.
+#include <mutex>
+#include "freertos/FreeRTOS.h"
+
+struct StaticSemaphore_t {
+    std::mutex mutex;
+};
+typedef StaticSemaphore_t* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer) { return buffer; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t) {
+    semaphore->mutex.lock();
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Stand-in for the header generated by ESP-IDF when the tests are built on a host.
+// The default choices of the Waveu Kconfig menu, on the linux target.
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_WAVEU_DAC_CHANNEL_BOTH 1
+#define CONFIG_WAVEU_CHANNEL_MODE_SIMUL 1
+#define CONFIG_WAVEU_LUT_TYPE_INT16 1
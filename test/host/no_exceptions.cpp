@@ -0,0 +1,32 @@
+// Instantiates the header-only WaveConfigs so they are compiled with -fno-exceptions -fno-rtti.
+#include "BandLimited.h"
+#include "Burst.h"
+#include "ChannelOffset.h"
+#include "Decimated.h"
+#include "Expression.h"
+#include "LockFreeQueue.h"
+#include "ModulationEngine.h"
+#include "Pipeline.h"
+#include "SmoothedValue.h"
+#include "Wavetable.h"
+
+namespace tinyalg::waveu {
+
+using Sine8 = Pipeline<Oscillator<LUT<Sine, LUT_256>>, Quantize8>;
+
+template class Pipeline<Oscillator<LUT<Sine, LUT_256>>,
+                        Modulator<LUT<Triangle, LUT_64>, 16384>,
+                        Envelope<1000, 1000>,
+                        Gain,
+                        Offset,
+                        Quantize12>;
+template class Pipeline<ModulationEngine<Operator<LUT<Sine, LUT_256>>, Operator<LUT<Sine, LUT_1024>>>,
+                        Quantize8>;
+template class Pipeline<BandLimitedSawtooth, Quantize8>;
+template class Pipeline<WavetableOscillator<LUT_256, Sine, Triangle, Square>, Quantize8>;
+template class Pipeline<ExpressionOscillator<>, Quantize8>;
+template class Burst<Sine8>;
+template class Decimated<Sine8, 4>;
+template class ChannelOffset<Sine8, 64>;
+
+} // namespace tinyalg::waveu
@@ -0,0 +1,99 @@
+// advance(n) must leave a WaveConfig in the state that rendering n samples leaves it in.
+#include <cstdint>
+#include <vector>
+#include "Burst.h"
+#include "Decimated.h"
+#include "ModulationEngine.h"
+#include "Pipeline.h"
+#include "Check.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 1000000;
+
+using Sine8 = Pipeline<Oscillator<LUT<Sine, LUT_256>>, Quantize8>;
+using BurstSine = Burst<Sine8>;
+using DecimatedSine = Decimated<Sine8, 8>;
+// Operator::advance() is exact for phase modulation only.
+using Pm = Pipeline<ModulationEngine<Operator<LUT<Sine, LUT_256>>,
+                                     Operator<LUT<Sine, LUT_1024>, ModulationType::Phase>>,
+                    Quantize8>;
+
+template <typename Wave>
+void render(Wave& wave, std::vector<typename Wave::sample_type>& out, size_t n) {
+    out.resize(n);
+    wave.renderBlock(out.data(), n);
+}
+
+/**
+ * Renders `before` samples on two instances, then advances one by `jump` while the other
+ * renders the same number of samples, and compares the next `after` samples.
+ */
+template <typename Wave, typename Setup>
+void checkAdvance(const char* name, Setup setup, size_t before, uint64_t jump, size_t after) {
+    Wave advanced;
+    Wave rendered;
+    setup(advanced);
+    setup(rendered);
+
+    std::vector<typename Wave::sample_type> a;
+    std::vector<typename Wave::sample_type> r;
+    render(advanced, a, before);
+    render(rendered, r, before);
+
+    advanced.advance(jump);
+    render(rendered, r, (size_t)jump);
+
+    render(advanced, a, after);
+    render(rendered, r, after);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < after; ++i) {
+        mismatches += (a[i] != r[i]);
+    }
+    if (mismatches != 0) {
+        std::printf("%s: before=%zu jump=%llu\n", name, before, (unsigned long long)jump);
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+void setupBurst(BurstSine& wave) {
+    wave.initialize(SAMPLE_RATE);
+    BurstSine::settings_type settings;
+    settings.cycles = 3;
+    settings.frequency = 10000.0f;
+    settings.repeatIntervalSamples = 1000;
+    wave.configureBurst(settings);
+    wave.configure(OscillatorArgs(settings.frequency));
+    wave.reset();
+    wave.scheduleTrigger(150);
+}
+
+void setupDecimated(DecimatedSine& wave) {
+    wave.initialize(SAMPLE_RATE);
+    wave.configure(OscillatorArgs(1234.0f));
+}
+
+void setupPm(Pm& wave) {
+    wave.initialize(SAMPLE_RATE);
+    wave.stage<0>().setFrequency(0, 1000.0f);
+    wave.stage<0>().setIndex(1, MODULATION_INDEX_ONE * 5 / 2);
+    wave.configure(OscillatorArgs(10000.0f));
+}
+
+} // namespace
+
+int main() {
+    const size_t befores[] = {0, 1, 7, 100, 333};
+    const uint64_t jumps[] = {0, 1, 5, 8, 13, 149, 150, 299, 300, 1000, 4321, 25003};
+
+    for (size_t before : befores) {
+        for (uint64_t jump : jumps) {
+            checkAdvance<BurstSine>("Burst", setupBurst, before, jump, 3000);
+            checkAdvance<DecimatedSine>("Decimated", setupDecimated, before, jump, 500);
+            checkAdvance<Pm>("ModulationEngine", setupPm, before, jump, 500);
+        }
+    }
+    return CHECK_RESULT();
+}
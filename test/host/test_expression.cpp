@@ -0,0 +1,161 @@
+// Expression: parsing, constant folding and evaluation.
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "Expression.h"
+#include "Check.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+bool near(float a, float b, float tolerance = 1e-5f) {
+    return std::fabs(a - b) <= tolerance;
+}
+
+float evaluate(const char* source, float phase = 0.0f, float time = 0.0f) {
+    Expression e;
+    if (!Expression::compile(source, e)) {
+        std::printf("Cannot compile \"%s\"\n", source);
+        ++waveu_test::failures;
+        return NAN;
+    }
+    return e.evaluate(phase, time);
+}
+
+void checkParse() {
+    struct Invalid {
+        const char* source;
+        size_t offset;
+    };
+    const Invalid invalid[] = {
+        {"", 0},
+        {"sin(p", 5},
+        {"1 +", 3},
+        {"2 * * 3", 4},
+        {"foo(p)", 0},
+        {"p q", 2},
+        {"sin(p, 2)", 5},
+        {"pulse(p)", 7},
+    };
+    for (const Invalid& c : invalid) {
+        Expression e;
+        size_t offset = SIZE_MAX;
+        Result result = Expression::compile(c.source, e, &offset);
+        if (result != ErrorCode::InvalidArgument || offset != c.offset) {
+            std::printf("\"%s\": %s at %zu\n", c.source, result.toString(), offset);
+        }
+        CHECK(result == ErrorCode::InvalidArgument);
+        CHECK_EQ(offset, c.offset);
+        CHECK(e.empty());
+    }
+
+    // Deeper than the evaluation stack.
+    Expression e;
+    CHECK(Expression::compile("p+(p+(p+(p+(p+(p+(p+(p+(p+p))))))))", e) == ErrorCode::InvalidArgument);
+    CHECK(Expression::compile("p+(p+(p+(p+(p+(p+(p+p))))))", e));
+
+    // A failed compile leaves the previous expression in place.
+    Expression kept;
+    CHECK(Expression::compile("2 * p", kept));
+    CHECK(!Expression::compile("2 *", kept));
+    CHECK(near(kept.evaluate(0.25f, 0.0f), 0.5f));
+}
+
+void checkFolding() {
+    Expression e;
+    CHECK(Expression::compile("2 * 3 + 1", e));
+    CHECK_EQ(e.size(), 1u);
+    CHECK(e.code()[0].op == ExpressionOp::Constant);
+    CHECK(near(e.code()[0].value, 7.0f));
+
+    CHECK(Expression::compile("sin(p) * (1 / 3)", e));
+    CHECK_EQ(e.size(), 4u);
+    CHECK(e.code()[0].op == ExpressionOp::Phase);
+    CHECK(e.code()[1].op == ExpressionOp::Sin);
+    CHECK(e.code()[2].op == ExpressionOp::Constant);
+    CHECK(near(e.code()[2].value, 1.0f / 3.0f));
+    CHECK(e.code()[3].op == ExpressionOp::Mul);
+
+    CHECK(Expression::compile("-(2 * pi) + abs(-1)", e));
+    CHECK_EQ(e.size(), 1u);
+    CHECK(near(e.code()[0].value, 1.0f - 2.0f * PI));
+
+    CHECK(Expression::compile("sin(0.25)", e));
+    CHECK_EQ(e.size(), 1u);
+    CHECK(near(e.code()[0].value, 1.0f));
+
+    CHECK(Expression::compile("sin(p)", e));
+    CHECK(!e.usesTime());
+    CHECK(Expression::compile("sin(p) * tri(2 * t)", e));
+    CHECK(e.usesTime());
+}
+
+void checkEvaluate() {
+    CHECK(near(evaluate("1 + 2 * 3"), 7.0f));
+    CHECK(near(evaluate("(1 + 2) * 3"), 9.0f));
+    CHECK(near(evaluate("2 - 3 - 4"), -5.0f));
+    CHECK(near(evaluate("8 / 4 / 2"), 1.0f));
+    CHECK(near(evaluate("-2 * 3"), -6.0f));
+    CHECK(near(evaluate("--2"), 2.0f));
+    CHECK(near(evaluate("clamp(5, 0, 1)"), 1.0f));
+    CHECK(near(evaluate("clamp(-5, 0, 1)"), 0.0f));
+    CHECK(near(evaluate("min(2, 3) + max(2, 3)"), 5.0f));
+    CHECK(near(evaluate("1.5e1"), 15.0f));
+
+    for (float phase = 0.0f; phase < 1.0f; phase += 1.0f / 64) {
+        CHECK(near(evaluate("sin(p)", phase), std::sin(2.0f * PI * phase)));
+        CHECK(near(evaluate("tri(p)", phase), (phase < 0.5f) ? 4.0f * phase - 1.0f : 3.0f - 4.0f * phase));
+        CHECK(near(evaluate("saw(p)", phase), 2.0f * phase - 1.0f));
+        CHECK(near(evaluate("pulse(p, 0.25)", phase), (phase < 0.25f) ? 1.0f : -1.0f));
+        // Periodic with a period of 1, also for negative arguments.
+        CHECK(near(evaluate("saw(p - 3)", phase), 2.0f * phase - 1.0f));
+        CHECK(near(evaluate("p * t", phase, 2.0f), 2.0f * phase));
+    }
+}
+
+void checkEvaluateBlock() {
+    const char* sources[] = {
+        "0.8 * sin(p) + 0.2 * pulse(4 * p, 0.25)",
+        "sin(p) * (0.6 + 0.4 * tri(2 * t))",
+        "clamp(3 * saw(p + t), -0.5, 0.5) / (1 + abs(p))",
+    };
+    Expression::Scratch scratch;
+    float phase[Expression::MAX_BLOCK];
+    float time[Expression::MAX_BLOCK];
+    float out[Expression::MAX_BLOCK];
+    for (size_t i = 0; i < Expression::MAX_BLOCK; ++i) {
+        phase[i] = (float)i / Expression::MAX_BLOCK;
+        time[i] = 0.37f + 0.001f * (float)i;
+    }
+    for (const char* source : sources) {
+        Expression e;
+        CHECK(Expression::compile(source, e));
+        e.evaluateBlock(phase, time, out, Expression::MAX_BLOCK, scratch);
+        for (size_t i = 0; i < Expression::MAX_BLOCK; ++i) {
+            // The table sine of evaluateBlock() is accurate to 2e-5.
+            CHECK(near(out[i], e.evaluate(phase[i], time[i]), 1e-4f));
+        }
+    }
+
+    // An empty expression evaluates to 0.
+    Expression empty;
+    CHECK(empty.empty());
+    CHECK_EQ(empty.evaluate(0.5f, 0.0f), 0.0f);
+    empty.evaluateBlock(phase, time, out, 4, scratch);
+    for (size_t i = 0; i < 4; ++i) {
+        CHECK_EQ(out[i], 0.0f);
+    }
+}
+
+} // namespace
+
+int main() {
+    checkParse();
+    checkFolding();
+    checkEvaluate();
+    checkEvaluateBlock();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,98 @@
+// LockFreeQueue: FIFO order, capacity, and per-producer order with concurrent producers.
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "LockFreeQueue.h"
+#include "Check.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+struct Item {
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+void checkSingleThreaded() {
+    LockFreeQueue<uint32_t, 4> queue;
+    uint32_t value = 0;
+    uint32_t position = 0;
+    CHECK(queue.empty());
+    CHECK(!queue.pop(value));
+
+    // Run several laps around the cells.
+    for (uint32_t lap = 0; lap < 5; ++lap) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            CHECK(queue.push(lap * 4 + i, &position));
+            CHECK_EQ(position, lap * 4 + i);
+        }
+        CHECK(!queue.push(99));
+        for (uint32_t i = 0; i < 4; ++i) {
+            CHECK(queue.pop(value, &position));
+            CHECK_EQ(value, lap * 4 + i);
+            CHECK_EQ(position, lap * 4 + i);
+        }
+        CHECK(queue.empty());
+    }
+}
+
+void checkMultipleProducers() {
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint32_t ITEMS = 20000;
+    LockFreeQueue<Item, 64> queue;
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, &go, p] {
+            while (!go.load()) {
+            }
+            for (uint32_t i = 0; i < ITEMS; ++i) {
+                while (!queue.push(Item{p, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> expected(PRODUCERS, 0);
+    uint32_t outOfOrder = 0;
+    uint32_t positionGaps = 0;
+    uint32_t popped = 0;
+    go.store(true);
+    while (popped < PRODUCERS * ITEMS) {
+        Item item;
+        uint32_t position;
+        if (!queue.pop(item, &position)) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Items of one producer leave in the order they were pushed.
+        outOfOrder += (item.producer >= PRODUCERS || item.sequence != expected[item.producer]);
+        if (item.producer < PRODUCERS) {
+            expected[item.producer] = item.sequence + 1;
+        }
+        positionGaps += (position != popped);
+        ++popped;
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    CHECK_EQ(outOfOrder, 0u);
+    CHECK_EQ(positionGaps, 0u);
+    CHECK(queue.empty());
+    for (uint32_t p = 0; p < PRODUCERS; ++p) {
+        CHECK_EQ(expected[p], ITEMS);
+    }
+}
+
+} // namespace
+
+int main() {
+    checkSingleThreaded();
+    checkMultipleProducers();
+    return CHECK_RESULT();
+}
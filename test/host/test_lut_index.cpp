@@ -0,0 +1,103 @@
+// LUTIndex and LUTIndexMapper: phase-to-index mapping, in particular for sizes that are
+// not a power of two.
+#include <cstdint>
+#include "LUTHelper.h"
+#include "PhaseGenerator.h"
+#include "Check.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+constexpr uint64_t FULL_SCALE = (uint64_t)1 << 32;
+
+/// The first phase that maps to entry `k` of a table of `size` entries.
+uint32_t firstPhase(uint64_t k, uint64_t size) {
+    return (uint32_t)((k * FULL_SCALE + size - 1) / size);
+}
+
+template <size_t Size>
+void checkSize() {
+    const LUTIndexMapper mapper(Size);
+    uint32_t wrong = 0;
+
+    // Every entry starts exactly at phase ceil(k * 2^32 / Size), so the entries are
+    // equally wide to within one phase step and none is skipped.
+    const uint64_t step = (Size > 4096) ? Size / 4096 : 1;
+    for (uint64_t k = 0; k < Size; k += step) {
+        const uint32_t first = firstPhase(k, Size);
+        wrong += (LUTIndex<Size>::index(first) != k);
+        wrong += (mapper.index(first) != k);
+        if (k > 0) {
+            wrong += (LUTIndex<Size>::index(first - 1) != k - 1);
+        }
+    }
+    CHECK_EQ(LUTIndex<Size>::index(0), 0u);
+    CHECK_EQ(LUTIndex<Size>::index(UINT32_MAX), (uint32_t)(Size - 1));
+
+    // The mapper agrees with the compile-time mapping, and its fraction grows linearly
+    // within an entry.
+    for (uint64_t phase = 0; phase < FULL_SCALE; phase += 0x00FEDCBAu) {
+        wrong += (mapper.index((uint32_t)phase) != LUTIndex<Size>::index((uint32_t)phase));
+        wrong += (mapper.index((uint32_t)phase) != (uint32_t)((phase * Size) >> 32));
+        wrong += (mapper.fraction((uint32_t)phase) != (uint32_t)(phase * Size));
+    }
+
+    uint32_t phases[5] = {0, 1, 0x40000000u, 0x80000000u, UINT32_MAX};
+    uint32_t indices[5];
+    LUTIndex<Size>::fill(phases, indices, 5);
+    for (size_t i = 0; i < 5; ++i) {
+        wrong += (indices[i] != (uint32_t)(((uint64_t)phases[i] * Size) >> 32));
+    }
+    mapper.fill(phases, indices, 5);
+    for (size_t i = 0; i < 5; ++i) {
+        wrong += (indices[i] != (uint32_t)(((uint64_t)phases[i] * Size) >> 32));
+    }
+
+    if (wrong != 0) {
+        std::printf("Size %zu\n", Size);
+    }
+    CHECK_EQ(wrong, 0u);
+}
+
+/// The function pointers of LUTHelper match LUTIndex for the predefined sizes.
+template <size_t Size>
+void checkIndexFunction() {
+    LUTIndexFunction function = nullptr;
+    CHECK(LUTHelper::tryGetIndexFunction(LUTSize(Size), function));
+    uint32_t wrong = 0;
+    for (uint64_t phase = 0; phase < FULL_SCALE; phase += 0x00123457u) {
+        wrong += ((uint32_t)function((uint32_t)phase, PhaseGenerator::N_BITS) != LUTIndex<Size>::index((uint32_t)phase));
+    }
+    CHECK_EQ(wrong, 0u);
+}
+
+} // namespace
+
+int main() {
+    // Not a power of two.
+    checkSize<3>();
+    checkSize<5>();
+    checkSize<7>();
+    checkSize<100>();
+    checkSize<1000>();
+    checkSize<1023>();
+    checkSize<1025>();
+    checkSize<48000>();
+    checkSize<((size_t)1 << 31) - 1>();
+
+    // Powers of two take the shift.
+    checkSize<2>();
+    checkSize<256>();
+    checkSize<65536>();
+    checkSize<(size_t)1 << 31>();
+
+    checkIndexFunction<16>();
+    checkIndexFunction<256>();
+    checkIndexFunction<65536>();
+
+    LUTIndexFunction function = nullptr;
+    CHECK(LUTHelper::tryGetIndexFunction(LUTSize(1000), function) == ErrorCode::InvalidArgument);
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,132 @@
+// LUTRegistry: sharing of equal tables, reference counting and freeing.
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "LUTRegistry.h"
+#include "Pipeline.h"
+#include "Check.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+void checkSharing() {
+    LUTRegistry& registry = LUTRegistry::instance();
+    const size_t tables = registry.tableCount();
+    const size_t bytes = registry.totalBytes();
+
+    SharedLUT a = registry.acquire(LUTKey::of<int16_t>(&Sine::value, 256, 32767.0f));
+    CHECK(a);
+    CHECK_EQ(a.size(), 256u);
+    CHECK_EQ(a.useCount(), 1u);
+    CHECK_EQ(registry.tableCount(), tables + 1);
+    CHECK(registry.totalBytes() > bytes + 256 * sizeof(int16_t) - 1);
+
+    // Equal keys, also up to float rounding and the sign of zero, share the table.
+    SharedLUT b = registry.acquire(LUTKey::of<int16_t>(&Sine::value, 256, 32767.0f * 1.0000001f, -0.0f));
+    CHECK(b.data<int16_t>() == a.data<int16_t>());
+    CHECK_EQ(a.useCount(), 2u);
+    CHECK_EQ(registry.tableCount(), tables + 1);
+
+    // Any difference in shape, size, type, amplitude or offset builds another table.
+    SharedLUT others[] = {
+        registry.acquire(LUTKey::of<int16_t>(&Triangle::value, 256, 32767.0f)),
+        registry.acquire(LUTKey::of<int16_t>(&Sine::value, 1000, 32767.0f)),
+        registry.acquire(LUTKey::of<uint16_t>(&Sine::value, 256, 32767.0f, 32768.0f)),
+        registry.acquire(LUTKey::of<int16_t>(&Sine::value, 256, 16000.0f)),
+        registry.acquire(LUTKey::of<int16_t>(&Sine::value, 256, 32767.0f, 1.0f)),
+    };
+    for (const SharedLUT& other : others) {
+        CHECK(other.data<void>() != a.data<void>());
+        CHECK_EQ(other.useCount(), 1u);
+    }
+    CHECK_EQ(registry.tableCount(), tables + 6);
+    for (SharedLUT& other : others) {
+        other.reset();
+    }
+    CHECK_EQ(registry.tableCount(), tables + 1);
+
+    // Copies and moves count references; the last one frees the table.
+    {
+        SharedLUT copy = a;
+        CHECK_EQ(a.useCount(), 3u);
+        SharedLUT moved = std::move(copy);
+        CHECK(!copy);
+        CHECK_EQ(a.useCount(), 3u);
+        SharedLUT assigned;
+        assigned = moved;
+        CHECK_EQ(a.useCount(), 4u);
+        assigned = a;
+        CHECK_EQ(a.useCount(), 4u);
+    }
+    CHECK_EQ(a.useCount(), 2u);
+    b.reset();
+    CHECK(!b);
+    CHECK_EQ(b.size(), 0u);
+    CHECK_EQ(a.useCount(), 1u);
+    const size_t peak = registry.peakBytes();
+    a.reset();
+    CHECK_EQ(registry.tableCount(), tables);
+    CHECK_EQ(registry.totalBytes(), bytes);
+    CHECK_EQ(registry.peakBytes(), peak);
+}
+
+void checkContents() {
+    SharedLUT table = LUTRegistry::instance().acquire(LUTKey::of<uint8_t>(&Sine::value, 100, 200.0f, 127.5f));
+    const uint8_t* data = table.data<uint8_t>();
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < 100; ++i) {
+        // Entry i is shape(i / size) * amplitude + offset, rounded and clamped to 0..255.
+        float v = Sine::value((float)i / 100) * 200.0f + 127.5f;
+        v = (v < 0.0f) ? 0.0f : (v > 255.0f) ? 255.0f : v;
+        wrong += (data[i] != (uint8_t)std::lround(v));
+    }
+    CHECK_EQ(wrong, 0u);
+}
+
+void checkInvalidKeys() {
+    LUTRegistry& registry = LUTRegistry::instance();
+    const size_t tables = registry.tableCount();
+    SharedLUT out;
+    CHECK(registry.tryAcquire(LUTKey::of<int16_t>(nullptr, 256, 1.0f), out) == ErrorCode::InvalidArgument);
+    CHECK(registry.tryAcquire(LUTKey::of<int16_t>(&Sine::value, 0, 1.0f), out) == ErrorCode::InvalidArgument);
+    CHECK(registry.tryAcquire(LUTKey::of<int16_t>(&Sine::value, 256, NAN), out) == ErrorCode::InvalidArgument);
+    CHECK(registry.tryAcquire(LUTKey::of<int16_t>(&Sine::value, 256, 1.0f, INFINITY), out) == ErrorCode::InvalidArgument);
+    CHECK(!out);
+    CHECK_EQ(registry.tableCount(), tables);
+}
+
+void checkConcurrentUse() {
+    LUTRegistry& registry = LUTRegistry::instance();
+    const size_t tables = registry.tableCount();
+    const LUTKey key = LUTKey::of<int16_t>(&Sine::value, 512, 32767.0f);
+    SharedLUT held = registry.acquire(key);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&registry, key] {
+            for (int i = 0; i < 2000; ++i) {
+                SharedLUT a = registry.acquire(key);
+                SharedLUT b = a;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK_EQ(held.useCount(), 1u);
+    held.reset();
+    CHECK_EQ(registry.tableCount(), tables);
+}
+
+} // namespace
+
+int main() {
+    checkSharing();
+    checkContents();
+    checkInvalidKeys();
+    checkConcurrentUse();
+    return CHECK_RESULT();
+}
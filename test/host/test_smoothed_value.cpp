@@ -0,0 +1,65 @@
+// SmoothedValue::skip(n) must move the value as n calls of next() do.
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include "SmoothedValue.h"
+#include "Check.h"
+
+using namespace tinyalg::waveu;
+
+namespace {
+
+void checkSkip(SmoothingType type, uint32_t ramp, int64_t from, int64_t to, uint64_t samples) {
+    SmoothedValue skipped(from);
+    SmoothedValue stepped(from);
+    skipped.setRamp(ramp, type);
+    stepped.setRamp(ramp, type);
+    skipped.setTarget(to);
+    stepped.setTarget(to);
+
+    skipped.skip(samples);
+    for (uint64_t i = 0; i < samples && stepped.isSmoothing(); ++i) {
+        stepped.next();
+    }
+
+    if (type == SmoothingType::Linear) {
+        CHECK_EQ(skipped.getValue(), stepped.getValue());
+        CHECK_EQ(skipped.isSmoothing(), stepped.isSmoothing());
+    } else {
+        // The closed form of skip() and the integer steps of next() round differently.
+        CHECK(std::llabs(skipped.getValue() - stepped.getValue()) <= 2);
+    }
+    if (samples >= (uint64_t)ramp * 20) {
+        CHECK(!skipped.isSmoothing());
+        CHECK_EQ(skipped.getValue(), to);
+    }
+}
+
+} // namespace
+
+int main() {
+    for (SmoothingType type : {SmoothingType::Linear, SmoothingType::OnePole}) {
+        for (uint32_t ramp : {1u, 10u, 100u, 1000u, 48000u}) {
+            for (int64_t from : {0LL, 32767LL, -5000LL}) {
+                for (int64_t to : {0LL, 32767LL, 1LL << 31, -20000LL}) {
+                    for (uint64_t samples : {(uint64_t)0, (uint64_t)1, (uint64_t)2, (uint64_t)ramp / 2,
+                                             (uint64_t)ramp, (uint64_t)ramp * 3, (uint64_t)ramp * 20}) {
+                        checkSkip(type, ramp, from, to, samples);
+                    }
+                }
+            }
+        }
+    }
+
+    // One skip of n samples must not move further than n samples: skip(1) equals next().
+    SmoothedValue skipped(0);
+    SmoothedValue stepped(0);
+    skipped.setRamp(1000, SmoothingType::OnePole);
+    stepped.setRamp(1000, SmoothingType::OnePole);
+    skipped.setTarget(32767);
+    stepped.setTarget(32767);
+    skipped.skip(1);
+    CHECK_EQ(skipped.getValue(), stepped.next());
+
+    return CHECK_RESULT();
+}